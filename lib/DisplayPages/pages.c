@@ -2,8 +2,8 @@
  * @file pages.c
  * @author Beat Sturzenegger
  * @brief 
- * @version 1.1
- * @date 14.02.2022
+ * @version 1.3
+ * @date 19.10.2026
  * 
  * @copyright Copyright (c) 2022
  * 
@@ -46,7 +46,20 @@ page_t pages_array[] =
       { "Zeile 6",        TEXT,     0,        "",                 DEFAULT}            // Line 5
     }
   },
-// Page 2
+// Page 2: connectivity diagnostics, filled by connectivityHistory.cpp (found by its title "Verbindung")
+  {
+    "Verbindung",  
+    { 
+      //Name            | Typ     | Wert    | Textwert/Einheit  | Einstellung
+      { "WLAN Abbrueche", NUMERIC,  0,        "",                 DECIMAL_PLACES_0},  // Line 0
+      { "WLAN Ausfall",   NUMERIC,  0,        "s",                DECIMAL_PLACES_1},  // Line 1: last outage
+      { "MQTT Abbrueche", NUMERIC,  0,        "",                 DECIMAL_PLACES_0},  // Line 2
+      { "MQTT Ausfall",   NUMERIC,  0,        "s",                DECIMAL_PLACES_1},  // Line 3: last outage
+      { "Max. Ausfall",   NUMERIC,  0,        "s",                DECIMAL_PLACES_1},  // Line 4
+      { "RSSI Abbruch",   NUMERIC,  0,        "dB",               DECIMAL_PLACES_0}   // Line 5: RSSI before the last WLAN drop
+    }
+  },
+// Page 3
   {
     "NULL"
   }
@@ -2,7 +2,7 @@
  * @file pages.h
  * @author Beat Sturzenegger
  * @brief 
- * @version 1.1
+ * @version 1.2
  * @date 14.02.2022
  * 
  * @copyright Copyright (c) 2022
@@ -60,6 +60,7 @@ typedef struct{
   float value;          ///< Zahlenwert der Zeile, ist relevant für die Zeilentypen @p NUMERIC, @p BAR und @p TIME
   char text[20];        ///< Textwert der Zeile, wenn der Zeilentyp @p TEXT ist. Beim Zeilentyp @p NUMERIC wird der Textinhalt als Masseinheit hinzugefügt. \n<b> Maximal 20 Zeichen!</b>
   int setting;          ///< Spezifische Einstellung für die Zeile. Siehe @ref settings_e
+  int dirty;            ///< Der Wert wurde geändert und die Zeile muss neu gezeichnet werden (wird in pages.c nicht angegeben)
 }line_t;
 
 /// Struktur einer Seite
@@ -8,8 +8,8 @@
  * Zusätzlich werden gewisse Interface Zustände angezeigt, sofern diese Verwendet werden.
  * zu den Interface gehören den WiFi, MQTT und SD Karte. \n 
  * @todo Auf einer Page die Interface Zustände genauer beschreiben. Coming soon...
- * @version 1.5
- * @date 14.02.2022
+ * @version 1.6
+ * @date 19.10.2026
  * 
  * @copyright Copyright (c) 2022
  * 
@@ -24,6 +24,8 @@
 #include "RawImage.h"             // image processing library
 #include "Free_Fonts.h"           // free font library
 #include "pages.h"                // page definition library
+#include "wio_mqtt.h"             // MQTT connection states
+#include "wio_link_monitor.h"     // WLAN quality levels
 #include <stdint.h>               // integer type library
 
 /********************************************************************************************
@@ -36,10 +38,11 @@ TFT_eSPI tft;   ///< Display Object
 ********************************************************************************************/
 static int sd_card_status = 0;        // sd card status (0: no SD card, 1: SD card pluged in)
 static int *mqtt_status_ptr = NULL;   // pointer to MQTT status
+static int *mqtt_state_ptr = NULL;    // pointer to MQTT connection setup state
 static bool *mqtt_pub_ptr = NULL;     // pointer to MQTT publish status
 static bool *mqtt_sub_ptr = NULL;     // pointer to MQTT subscribe status
 static int *wlan_status_ptr = NULL;   // pointer to WLAN status
-static int *wlan_strength_ptr = NULL; // pointer to WLAN strength
+static int *wlan_quality_ptr = NULL;  // pointer to WLAN quality level
 static int *wlan_channel_ptr = NULL;  // pointer to WLAN channel
 static int loading_screen_status = 0; // loading screen status
 static const uint16_t NO_SD_CARD_IMG[] = {  // No sd card image
@@ -162,10 +165,11 @@ wio_display::wio_display(connection_state_t *connectionState)
 {
   // save addresses
   mqtt_status_ptr = &connectionState->mqtt_status;
+  mqtt_state_ptr = &connectionState->mqtt_state;
   mqtt_pub_ptr = &connectionState->mqtt_pub_status;
   mqtt_sub_ptr = &connectionState->mqtt_sub_status;
   wlan_status_ptr = &connectionState->wlan_status;
-  wlan_strength_ptr = &connectionState->wlan_strength;
+  wlan_quality_ptr = &connectionState->wlan_quality;
   wlan_channel_ptr = &connectionState->wlan_channel;
 }
 
@@ -202,12 +206,13 @@ void wio_display::initDisplay()
 void wio_display::drawPage(page_t p)
 {
   int mqtt_s = *mqtt_status_ptr;
+  int mqtt_st = *mqtt_state_ptr;
   int wlan_s = *wlan_status_ptr;
-  int wlan_st = *wlan_strength_ptr;
+  int wlan_q = *wlan_quality_ptr;
   int wlan_ch = *wlan_channel_ptr;
 
-  tft.fillScreen(TFT_BLACK);                                                // draw background
-  drawHeader(p.title, sd_card_status, mqtt_s, wlan_s, wlan_st, wlan_ch);    // draw header
+  tft.fillScreen(TFT_BLACK);                                                        // draw background
+  drawHeader(p.title, sd_card_status, mqtt_s, mqtt_st, wlan_s, wlan_q, wlan_ch);   // draw header
   for (int i = 0; i < NUMBERS_OF_LINES; i++)                                // for NUMBERS_OF_LINES times
   {
     drawPageLine(p.lines[i], i, FULL_LINE);                             // draw all the lines
@@ -255,8 +260,9 @@ void wio_display::updateLine(page_t p, unsigned int line_nr, draw_setting_e sett
 void wio_display::updateInterfaceStatus()
 {
   int mqtt_s = *mqtt_status_ptr;
+  int mqtt_st = *mqtt_state_ptr;
   int wlan_s = *wlan_status_ptr;
-  int wlan_st = *wlan_strength_ptr;
+  int wlan_q = *wlan_quality_ptr;
   int wlan_ch = *wlan_channel_ptr;
   bool mqtt_pub = *mqtt_pub_ptr;
   bool mqtt_sub = *mqtt_sub_ptr;
@@ -270,7 +276,7 @@ void wio_display::updateInterfaceStatus()
   {
     sd_card_status = 1;
   }
-  drawIcons(mqtt_s, mqtt_pub, mqtt_sub, wlan_s, wlan_st, wlan_ch, false);   // draw Icons
+  drawIcons(mqtt_s, mqtt_st, mqtt_pub, mqtt_sub, wlan_s, wlan_q, wlan_ch, false);   // draw Icons
 }
 
 /**
@@ -341,11 +347,12 @@ void wio_display::addLogText(const char *log_, bool append)
  * @param title Titel der Seite
  * @param sd_card_status SD Karten Zustand
  * @param mqtt_status MQTT Verbindungszustand
+ * @param mqtt_state Zustand des MQTT Verbindungsaufbaus
  * @param wlan_status WLAN Verbindungszustand
- * @param wlan_strength WLAN Signalstärke
+ * @param wlan_quality WLAN Qualitätsstufe, siehe @ref wifi_quality_e
  * @param wlan_channel WLAN Kannal
  */
-void wio_display::drawHeader(char *title, int sd_card_status, int mqtt_status, int wlan_status, int wlan_strength, int wlan_channel)
+void wio_display::drawHeader(char *title, int sd_card_status, int mqtt_status, int mqtt_state, int wlan_status, int wlan_quality, int wlan_channel)
 {
   // draw Header Background
   tft.fillRect(0, 0, 320, 40, TFT_WHITE);   // white Background
@@ -356,7 +363,7 @@ void wio_display::drawHeader(char *title, int sd_card_status, int mqtt_status, i
   tft.setTextColor(TFT_BLACK);    // set text color to black
   tft.drawString(title, 5, 5);    // draw text
 
-  drawIcons(mqtt_status, false, false, wlan_status, wlan_strength, wlan_channel, true);   // draw icons
+  drawIcons(mqtt_status, mqtt_state, false, false, wlan_status, wlan_quality, wlan_channel, true);   // draw icons
 }
 
 /**
@@ -515,35 +522,42 @@ void wio_display::drawPageLine(line_t l, unsigned int line_nr, draw_setting_e se
  * Dadurch kann diese Methode oft aufgerufen werden, ohne dass die Icons flackern.
  * @todo Formattierung checking
  * @param mqtt_status MQTT Verbindungsstatus
+ * @param mqtt_state Zustand des MQTT Verbindungsaufbaus, siehe @ref mqtt_state_e
  * @param mqtt_pub MQTT Publish Status
  * @param mqtt_sub MQTT Subscribe Status
  * @param wlan_status WLAN Verbindungsstatus
- * @param wlan_strength WLAN Verbindungsstärke
+ * @param wlan_quality WLAN Qualitätsstufe, siehe @ref wifi_quality_e (nur ein Wechsel der Stufe zeichnet das Icon neu)
  * @param wlan_channel WLAN Kanal
  * @param forced Kann das Zeichnen erzwingen
  * - @p False: Die Icons werden nur neu gezeichnet, wenn sich der Wert vom vorherigen Aufruf unterscheidet
  * - @p True: Die Icons werden auf jedenfall neu gezeichnet
  */
-void wio_display::drawIcons(int mqtt_status, bool mqtt_pub, bool mqtt_sub, int wlan_status, int wlan_strength, int wlan_channel, bool forced)
+void wio_display::drawIcons(int mqtt_status, int mqtt_state, bool mqtt_pub, bool mqtt_sub, int wlan_status, int wlan_quality, int wlan_channel, bool forced)
 {
-  static int old_wlan_strength = -99;   // set default value
+  static int old_wlan_quality = -99;    // set default value
+  static int old_sd_card_status = -99;  // set default value
   static int old_wlan_channel = -99;    // set default value
   static int old_mqtt_status = -99;     // set default value
+  static int old_mqtt_state = -99;      // set default value
   static bool old_mqtt_pub = -99;       // set default value
   static bool old_mqtt_sub = -99;       // set default value
 
   // draw SD Card Status
-  if (sd_card_status)
+  if ((old_sd_card_status != sd_card_status) || forced)   // has something changed or is draw forced
   {
-    drawImage<uint16_t>("sys/img/bmp/sd_card.bmp", 280, 0);   // draw image from sd card
-  }
-  else
-  {
-    tft.pushImage((int32_t)280, (int32_t)0, (int32_t)40, (int32_t)40, &NO_SD_CARD_IMG[0]);  // draw on chip safed image
+    if (sd_card_status)
+    {
+      drawImage<uint16_t>("sys/img/bmp/sd_card.bmp", 280, 0);   // draw image from sd card
+    }
+    else
+    {
+      tft.pushImage((int32_t)280, (int32_t)0, (int32_t)40, (int32_t)40, &NO_SD_CARD_IMG[0]);  // draw on chip safed image
+    }
+    old_sd_card_status = sd_card_status;  // overwrite old value
   }
 
   // MQTT Status
-  if ((old_mqtt_status != mqtt_status) || (old_mqtt_pub != mqtt_pub) || (old_mqtt_sub != mqtt_sub) || forced)   // has something changed or is draw forced
+  if ((old_mqtt_status != mqtt_status) || (old_mqtt_state != mqtt_state) || (old_mqtt_pub != mqtt_pub) || (old_mqtt_sub != mqtt_sub) || forced)   // has something changed or is draw forced
   {
     tft.fillRect(250, 0, 10, 10, TFT_WHITE); // draw white rectangle to clear old stuff
     
@@ -557,8 +571,19 @@ void wio_display::drawIcons(int mqtt_status, bool mqtt_pub, bool mqtt_sub, int w
         tft.drawCircle(240 + 20, 20, 10, TFT_BLACK);    // draw circle border
       }
     }
+    else if (mqtt_state == MQTT_STATE_TCP_CONNECT || mqtt_state == MQTT_STATE_TLS_HANDSHAKE || mqtt_state == MQTT_STATE_WAIT_CONNACK || mqtt_state == MQTT_STATE_SUBSCRIBE)
+    {   // connecting to broker
+      if (sd_card_status) {
+        drawImage<uint16_t>("sys/img/bmp/MQTT_off.bmp", 240, 0);   // draw image from sd card
+        tft.fillCircle(240 + 34, 34, 4, TFT_YELLOW);              // mark as connecting
+      } else {
+
+        tft.fillCircle(240 + 20, 20, 10, TFT_YELLOW);   // draw yellow circle
+        tft.drawCircle(240 + 20, 20, 10, TFT_BLACK);    // draw circle border
+      }
+    }
     else
-    {   // disconnected to broker
+    {   // disconnected to broker or connection failed
       if (sd_card_status)
         drawImage<uint16_t>("sys/img/bmp/MQTT_off.bmp", 240, 0);   // draw image from sd card
       else {
@@ -631,18 +656,19 @@ void wio_display::drawIcons(int mqtt_status, bool mqtt_pub, bool mqtt_sub, int w
     old_mqtt_pub = mqtt_pub;        // overwrite old value
     old_mqtt_sub = mqtt_sub;        // overwrite old value
     old_mqtt_status = mqtt_status;  // overwrite old value
+    old_mqtt_state = mqtt_state;    // overwrite old value
   }
 
   // WLAN Status
-  // wlan strength
+  // wlan quality level, filtered and with hysteresis in the network layer: RSSI jitter does not redraw the icon
 
-  if((old_wlan_strength != wlan_strength) || forced)   // has something changed or is draw forced
+  if((old_wlan_quality != wlan_quality) || forced)   // has something changed or is draw forced
   {
     if (sd_card_status) {
       forced = true;        // set to forced, that the frequence band also will be redrawn
     }
     // really god connection
-    if (wlan_strength < 0 && wlan_strength > -50)
+    if (wlan_quality == WIFI_QUALITY_FULL)
     {
       if (sd_card_status) {
         drawImage<uint16_t>("sys/img/bmp/wlan_full.bmp", 200, 0);   // draw image from sd card
@@ -652,7 +678,7 @@ void wio_display::drawIcons(int mqtt_status, bool mqtt_pub, bool mqtt_sub, int w
       }
     }
     // good connection
-    else if (wlan_strength <= -50 && wlan_strength >= -59)
+    else if (wlan_quality == WIFI_QUALITY_MID)
     {
       if (sd_card_status)
       {
@@ -663,7 +689,7 @@ void wio_display::drawIcons(int mqtt_status, bool mqtt_pub, bool mqtt_sub, int w
       }
     }
     // bad connection
-    else if (wlan_strength <= -60 && wlan_strength >= -69)
+    else if (wlan_quality == WIFI_QUALITY_LOW)
     {
       if (sd_card_status)
       {
@@ -674,8 +700,8 @@ void wio_display::drawIcons(int mqtt_status, bool mqtt_pub, bool mqtt_sub, int w
       }
     }
 
-    // no connection
-    else if (wlan_strength < -70)
+    // weak connection
+    else if (wlan_quality == WIFI_QUALITY_WEAK)
     {
       if (sd_card_status) {
         drawImage<uint16_t>("sys/img/bmp/wlan_no.bmp", 200, 0);   // draw image from sd card
@@ -693,7 +719,7 @@ void wio_display::drawIcons(int mqtt_status, bool mqtt_pub, bool mqtt_sub, int w
         tft.drawCircle(200 + 20, 20, 10, TFT_BLACK);      // draw circle border
       }
     }
-    old_wlan_strength = wlan_strength;      // overwrite old value
+    old_wlan_quality = wlan_quality;        // overwrite old value
   }
 
   // wlan channel
@@ -2,8 +2,8 @@
  * @file wio_display.h
  * @author Beat Sturzenegger
  * @brief IoTB Bibliothek für den WIO Terminal Display.
- * @version 1.3
- * @date 18.01.2022
+ * @version 1.4
+ * @date 19.10.2026
  * 
  * @copyright Copyright (c) 2022
  * 
@@ -31,11 +31,14 @@ typedef enum{
 struct connection_state_t
 {
     int mqtt_status;      ///< MQTT Status (connected, disconnected, ...)
+    int mqtt_state;       ///< Zustand des MQTT Verbindungsaufbaus (connecting, failed, ...), siehe @ref mqtt_state_e
     bool mqtt_pub_status; ///< MQTT Publish Status
     bool mqtt_sub_status; ///< MQTT Subscribe Status
     int wlan_status;      ///< WLAN Status (connected, disconnected, ...)
-    int wlan_strength;    ///< Aktuelle WLAN Signalstärke
+    int wlan_strength;    ///< Aktuelle WLAN Signalstärke (gleitender Mittelwert)
     int wlan_channel;     ///< Benutze WLAN Kanal, wird genutzt für die Frequenzbanderkennung
+    int wlan_strength_raw; ///< Zuletzt gemessene WLAN Signalstärke (ungefiltert, für die Diagnose)
+    int wlan_quality;     ///< Qualitätsstufe der WLAN Verbindung mit Hysterese, siehe @ref wifi_quality_e; bestimmt das Icon
 };
 
 /********************************************************************************************
@@ -59,9 +62,9 @@ class wio_display
     void addLogText(const char * log_, bool append);                                    ///< Log Text hinzufügen
     
   private:
-    void drawHeader(char *title, int sd_card_status, int mqtt_status, int wlan_status, int wlan_strength, int wlan_channel);
+    void drawHeader(char *title, int sd_card_status, int mqtt_status, int mqtt_state, int wlan_status, int wlan_quality, int wlan_channel);
     void drawPageLine(line_t l, unsigned int line_nr, draw_setting_e setting);
-    void drawIcons(int mqtt_status, bool mqtt_pub, bool mqtt_sub, int wlan_status, int wlan_strength, int wlan_channel, bool forced);
+    void drawIcons(int mqtt_status, int mqtt_state, bool mqtt_pub, bool mqtt_sub, int wlan_status, int wlan_quality, int wlan_channel, bool forced);
     void symbol_5(int offset);
     void symbol_2(int offset);
     void symbol_4(int offset);
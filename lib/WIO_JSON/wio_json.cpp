@@ -0,0 +1,726 @@
+/**
+ * @file wio_json.cpp
+ * @author Fabian Reifler
+ * @brief JSON Tokenizer ohne dynamischen Speicher (nach dem Vorbild von jsmn) mit Pfad-Auswahl \n
+ * Die Daten werden nicht kopiert: Jedes Token beschreibt nur Position und Länge eines Abschnittes im
+ * Empfangspuffer. Die Tokens liegen in der Reihenfolge der Daten, über @ref json_token_t::next
+ * können Geschwister ohne Rekursion übersprungen werden. \n
+ * Der @ref wio_json_writer schreibt JSON ohne sprintf und ohne String Objekte direkt in einen Ausgabestrom.
+ * @version 1.1
+ * @date 19.10.2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+/********************************************************************************************
+*** Includes
+********************************************************************************************/
+#include "wio_json.h"
+
+/********************************************************************************************
+*** Constructor
+********************************************************************************************/
+/**
+ * @brief Konstruktor
+ *
+ * @param tokens Array für die Tokens
+ * @param maxTokens Anzahl Tokens im Array
+ */
+wio_json::wio_json(json_token_t *tokens, unsigned int maxTokens)
+{
+  this->tokens = tokens;
+  this->maxTokens = maxTokens;
+}
+
+/********************************************************************************************
+*** Public Methodes
+********************************************************************************************/
+/**
+ * @brief Diese Methode zerlegt JSON Daten in Tokens. Die Daten müssen gültig bleiben, solange die Tokens
+ * verwendet werden (z.B. innerhalb des MQTT Handlers).
+ *
+ * @param js JSON Daten (müssen nicht nullterminiert sein)
+ * @param len Länge der Daten
+ * @return int Anzahl Tokens oder ein Fehlercode ( @ref JSON_ERROR_NOMEM, @ref JSON_ERROR_INVAL, @ref JSON_ERROR_PART )
+ */
+int wio_json::parse(const char *js, unsigned int len)
+{
+  int parent = -1; // innermost open object or array
+  int idx;
+
+  this->js = js;
+  count = 0;
+  if (len > 0xFFFF)
+  {
+    return JSON_ERROR_NOMEM;
+  }
+
+  for (unsigned int pos = 0; pos < len; pos++)
+  {
+    char c = js[pos];
+    switch (c)
+    {
+    case '{':
+    case '[':
+      idx = addToken(c == '{' ? JSON_OBJECT : JSON_ARRAY, pos, parent);
+      if (idx < 0)
+      {
+        return JSON_ERROR_NOMEM;
+      }
+      parent = idx;
+      break;
+
+    case '}':
+    case ']':
+      if (parent < 0 || tokens[parent].type != (c == '}' ? JSON_OBJECT : JSON_ARRAY))
+      {
+        return JSON_ERROR_INVAL;
+      }
+      tokens[parent].end = pos + 1;
+      tokens[parent].next = count;
+      if (c == '}')
+      {
+        tokens[parent].size /= 2; // keys and values were counted
+      }
+      parent = tokens[parent].parent;
+      break;
+
+    case '"':
+    {
+      unsigned int start = pos + 1;
+      for (pos = start; pos < len && js[pos] != '"'; pos++)
+      {
+        if (js[pos] == '\\')
+        {
+          pos++; // skip escaped character
+        }
+      }
+      if (pos >= len)
+      {
+        return JSON_ERROR_PART;
+      }
+      idx = addToken(JSON_STRING, start, parent);
+      if (idx < 0)
+      {
+        return JSON_ERROR_NOMEM;
+      }
+      tokens[idx].end = pos;
+    }
+    break;
+
+    case ' ':
+    case '\t':
+    case '\r':
+    case '\n':
+    case ':':
+    case ',':
+      break;
+
+    default: // number, true, false, null
+    {
+      unsigned int start = pos;
+      if (!(c == '-' || (c >= '0' && c <= '9') || c == 't' || c == 'f' || c == 'n'))
+      {
+        return JSON_ERROR_INVAL;
+      }
+      while (pos < len && !strchr(" \t\r\n,:]}", js[pos]))
+      {
+        pos++;
+      }
+      idx = addToken(JSON_PRIMITIVE, start, parent);
+      if (idx < 0)
+      {
+        return JSON_ERROR_NOMEM;
+      }
+      tokens[idx].end = pos;
+      pos--; // the delimiter is handled by the next iteration
+    }
+    break;
+    }
+  }
+
+  if (parent >= 0) // object or array not closed
+  {
+    return JSON_ERROR_PART;
+  }
+  return count;
+}
+
+/**
+ * @brief Diese Methode sucht ein Token über einen Pfad. Der Pfad beginnt mit '$' (oberstes Element),
+ * danach folgen Schlüssel mit '.' und Array Indizes mit '[n]', z.B. "$.t", "$.sensor.h" oder "$.values[2]".
+ *
+ * @param path Pfad
+ * @return int Index des Tokens oder -1, wenn der Pfad nicht existiert
+ */
+int wio_json::select(const char *path)
+{
+  int idx = 0;
+
+  if (count == 0 || *path != '$')
+  {
+    return -1;
+  }
+  path++;
+  while (*path && idx >= 0)
+  {
+    if (*path == '.')
+    {
+      const char *key = ++path;
+      while (*path && *path != '.' && *path != '[')
+      {
+        path++;
+      }
+      idx = find(idx, key);
+    }
+    else if (*path == '[')
+    {
+      char *end;
+      long index = strtol(path + 1, &end, 10);
+      if (*end != ']' || index < 0)
+      {
+        return -1;
+      }
+      idx = element(idx, index);
+      path = end + 1;
+    }
+    else
+    {
+      return -1;
+    }
+  }
+  return idx;
+}
+
+/**
+ * @brief Diese Methode sucht den Wert zu einem Schlüssel in einem Objekt. Der Schlüssel endet beim ersten
+ * '.', '[' oder '\0', dadurch kann direkt ein Teil eines Pfades übergeben werden.
+ *
+ * @param object Index des Objektes
+ * @param key Schlüssel
+ * @return int Index des Wertes oder -1, wenn der Schlüssel nicht existiert
+ */
+int wio_json::find(int object, const char *key)
+{
+  unsigned int keyLen = strcspn(key, ".[");
+
+  if (object < 0 || object >= (int)count || tokens[object].type != JSON_OBJECT)
+  {
+    return -1;
+  }
+  for (unsigned int i = object + 1; i + 1 < tokens[object].next; i = tokens[i + 1].next)
+  {
+    if (equals(i, key, keyLen))
+    {
+      return i + 1;
+    }
+  }
+  return -1;
+}
+
+/**
+ * @brief Diese Methode sucht ein Element eines Arrays.
+ *
+ * @param array Index des Arrays
+ * @param index Position des Elementes (beginnt bei 0)
+ * @return int Index des Tokens oder -1, wenn das Element nicht existiert
+ */
+int wio_json::element(int array, unsigned int index)
+{
+  if (array < 0 || array >= (int)count || tokens[array].type != JSON_ARRAY || index >= tokens[array].size)
+  {
+    return -1;
+  }
+  unsigned int i = array + 1;
+  while (index-- > 0)
+  {
+    i = tokens[i].next;
+  }
+  return i;
+}
+
+/**
+ * @brief Diese Methode gibt ein Token zurück.
+ *
+ * @param index Index des Tokens
+ * @return const json_token_t* Zeiger auf das Token oder NULL bei einem ungültigen Index
+ */
+const json_token_t *wio_json::token(int index)
+{
+  if (index < 0 || index >= (int)count)
+  {
+    return NULL;
+  }
+  return &tokens[index];
+}
+
+/**
+ * @brief Diese Methode kopiert den Wert eines Tokens als nullterminierten String. Escape-Sequenzen in Strings
+ * werden umgewandelt, Unicode Zeichen ausserhalb von ASCII werden als '?' dargestellt.
+ *
+ * @param index Index des Tokens (String oder Primitive)
+ * @param buf Puffer für den String
+ * @param size Grösse des Puffers
+ * @return true Der Wert wurde vollständig kopiert
+ * @return false Ungültiges Token oder der Wert wurde gekürzt
+ */
+bool wio_json::getString(int index, char *buf, unsigned int size)
+{
+  const json_token_t *t = token(index);
+  unsigned int n = 0;
+
+  if (size == 0)
+  {
+    return false;
+  }
+  buf[0] = '\0';
+  if (!t || t->type == JSON_OBJECT || t->type == JSON_ARRAY)
+  {
+    return false;
+  }
+  for (unsigned int i = t->start; i < t->end; i++)
+  {
+    char c = js[i];
+    if (n + 1 >= size)
+    {
+      buf[n] = '\0';
+      return false; // truncated
+    }
+    if (c == '\\' && t->type == JSON_STRING && i + 1 < t->end)
+    {
+      c = js[++i];
+      switch (c)
+      {
+      case 'n': c = '\n'; break;
+      case 't': c = '\t'; break;
+      case 'r': c = '\r'; break;
+      case 'b': c = '\b'; break;
+      case 'f': c = '\f'; break;
+      case 'u':
+      {
+        char hex[5] = {0};
+        for (int k = 0; k < 4 && i + 1 < t->end; k++)
+        {
+          hex[k] = js[++i];
+        }
+        long code = strtol(hex, NULL, 16);
+        c = (code > 0 && code < 0x80) ? (char)code : '?';
+      }
+      break;
+      default: // '"', '\\' and '/' stand for themselves
+        break;
+      }
+    }
+    buf[n++] = c;
+  }
+  buf[n] = '\0';
+  return true;
+}
+
+/**
+ * @brief Diese Methode liest den Wert eines Tokens als Fliesskommazahl. Strings mit einer Zahl (z.B. "21.4")
+ * werden ebenfalls akzeptiert, true und false ergeben 1 und 0.
+ *
+ * @param index Index des Tokens
+ * @param value Gelesener Wert
+ * @return true Der Wert ist eine Zahl
+ * @return false Ungültiges Token oder keine Zahl
+ */
+bool wio_json::getFloat(int index, float *value)
+{
+  char buf[32];
+  char *end;
+
+  if (!getString(index, buf, sizeof(buf)))
+  {
+    return false;
+  }
+  if (tokens[index].type == JSON_PRIMITIVE && (buf[0] == 't' || buf[0] == 'f'))
+  {
+    *value = buf[0] == 't' ? 1 : 0;
+    return true;
+  }
+  *value = strtof(buf, &end);
+  return end != buf && *end == '\0';
+}
+
+/**
+ * @brief Diese Methode liest den Wert eines Tokens als Ganzzahl.
+ *
+ * @param index Index des Tokens
+ * @param value Gelesener Wert
+ * @return true Der Wert ist eine Ganzzahl
+ * @return false Ungültiges Token oder keine Ganzzahl
+ */
+bool wio_json::getInt(int index, long *value)
+{
+  char buf[24];
+  char *end;
+
+  if (!getString(index, buf, sizeof(buf)))
+  {
+    return false;
+  }
+  *value = strtol(buf, &end, 10);
+  return end != buf && *end == '\0';
+}
+
+/**
+ * @brief Diese Methode vergleicht ein String Token mit einem Text (ohne Escape-Sequenzen).
+ *
+ * @param index Index des Tokens
+ * @param s Text
+ * @param len Länge des Textes
+ * @return true Das Token ist ein String mit genau diesem Inhalt
+ * @return false Das Token ist kein String oder hat einen anderen Inhalt
+ */
+bool wio_json::equals(int index, const char *s, unsigned int len)
+{
+  const json_token_t *t = token(index);
+
+  return t && t->type == JSON_STRING && (unsigned int)(t->end - t->start) == len && strncmp(&js[t->start], s, len) == 0;
+}
+
+/********************************************************************************************
+*** Private Methodes
+********************************************************************************************/
+/**
+ * @brief Diese Methode legt ein neues Token an und zählt es beim umgebenden Objekt bzw. Array als Kind.
+ * Bei Objekten werden Schlüssel und Werte gezählt, beim Abschluss des Objektes wird halbiert.
+ *
+ * @param type Typ des Tokens
+ * @param start Position des ersten Zeichens
+ * @param parent Index des umgebenden Objektes oder Arrays
+ * @return int Index des Tokens oder -1, wenn keine Tokens mehr frei sind
+ */
+int wio_json::addToken(uint8_t type, unsigned int start, int parent)
+{
+  if (count >= maxTokens)
+  {
+    return -1;
+  }
+  json_token_t *t = &tokens[count];
+  t->type = type;
+  t->start = start;
+  t->end = start;
+  t->size = 0;
+  t->next = count + 1;
+  t->parent = parent;
+
+  if (parent >= 0)
+  {
+    tokens[parent].size++;
+  }
+  return count++;
+}
+
+/********************************************************************************************
+*** JSON Writer
+********************************************************************************************/
+/**
+ * @brief Konstruktor
+ *
+ * @param out Ausgabestrom, z.B. ein @ref wio_mqtt Objekt nach beginMessage()
+ */
+wio_json_writer::wio_json_writer(Print &out) : out(out)
+{
+}
+
+/**
+ * @brief Diese Methode beginnt ein Objekt.
+ *
+ */
+void wio_json_writer::beginObject()
+{
+  open('{');
+}
+
+/**
+ * @brief Diese Methode beendet ein Objekt.
+ *
+ */
+void wio_json_writer::endObject()
+{
+  close('}');
+}
+
+/**
+ * @brief Diese Methode beginnt ein Array.
+ *
+ */
+void wio_json_writer::beginArray()
+{
+  open('[');
+}
+
+/**
+ * @brief Diese Methode beendet ein Array.
+ *
+ */
+void wio_json_writer::endArray()
+{
+  close(']');
+}
+
+/**
+ * @brief Diese Methode schreibt einen Schlüssel. Danach muss genau ein Wert, Objekt oder Array folgen.
+ *
+ * @param k Schlüssel
+ */
+void wio_json_writer::key(const char *k)
+{
+  separator();
+  putEscaped(k);
+  put(":");
+  afterKey = true;
+}
+
+/**
+ * @brief Diese Methode schreibt einen String. Anführungszeichen, Backslash und Steuerzeichen werden maskiert.
+ *
+ * @param s String, NULL wird als null geschrieben
+ */
+void wio_json_writer::value(const char *s)
+{
+  if (!s)
+  {
+    null();
+    return;
+  }
+  separator();
+  putEscaped(s);
+}
+
+/**
+ * @brief Diese Methode schreibt eine Ganzzahl.
+ *
+ * @param v Wert
+ */
+void wio_json_writer::value(long v)
+{
+  separator();
+  number(out.print(v));
+}
+
+/**
+ * @brief Diese Methode schreibt eine Ganzzahl.
+ *
+ * @param v Wert
+ */
+void wio_json_writer::value(int v)
+{
+  value((long)v);
+}
+
+/**
+ * @brief Diese Methode schreibt eine positive Ganzzahl.
+ *
+ * @param v Wert
+ */
+void wio_json_writer::value(unsigned long v)
+{
+  separator();
+  number(out.print(v));
+}
+
+/**
+ * @brief Diese Methode schreibt eine Fliesskommazahl. NaN und Unendlich sind in JSON nicht erlaubt
+ * und werden als null geschrieben.
+ *
+ * @param v Wert
+ * @param decimals Anzahl Nachkommastellen
+ */
+void wio_json_writer::value(double v, uint8_t decimals)
+{
+  if (isnan(v) || isinf(v))
+  {
+    null();
+    return;
+  }
+  separator();
+  number(out.print(v, decimals));
+}
+
+/**
+ * @brief Diese Methode schreibt true oder false.
+ *
+ * @param v Wert
+ */
+void wio_json_writer::value(bool v)
+{
+  separator();
+  put(v ? "true" : "false");
+}
+
+/**
+ * @brief Diese Methode schreibt null.
+ *
+ */
+void wio_json_writer::null()
+{
+  separator();
+  put("null");
+}
+
+/**
+ * @brief Diese Methode gibt die Anzahl geschriebener Bytes zurück.
+ *
+ * @return size_t Anzahl Bytes
+ */
+size_t wio_json_writer::length()
+{
+  return written;
+}
+
+/**
+ * @brief Diese Methode gibt zurück, ob der Ausgabestrom Bytes abgelehnt hat (z.B. Sendepuffer voll)
+ * oder die Verschachtelung zu tief ist. Das JSON ist dann unvollständig.
+ *
+ * @return true Das JSON ist unvollständig
+ * @return false Alles wurde geschrieben
+ */
+bool wio_json_writer::error()
+{
+  return failed;
+}
+
+/**
+ * @brief Diese Methode schreibt ein Komma, wenn auf der aktuellen Ebene bereits ein Element steht.
+ *
+ */
+void wio_json_writer::separator()
+{
+  if (afterKey) // value of a key
+  {
+    afterKey = false;
+    return;
+  }
+  if (hasElement & (1 << depth))
+  {
+    put(",");
+  }
+  hasElement |= (1 << depth);
+}
+
+/**
+ * @brief Diese Methode schreibt einen String ohne Umwandlung.
+ *
+ * @param s String
+ */
+void wio_json_writer::put(const char *s)
+{
+  putBlock(s, strlen(s));
+}
+
+/**
+ * @brief Diese Methode schreibt einen Block und merkt sich, wenn der Ausgabestrom nicht alles angenommen hat.
+ *
+ * @param s Zeichen
+ * @param n Anzahl Zeichen
+ */
+void wio_json_writer::putBlock(const char *s, size_t n)
+{
+  size_t w = out.write((const uint8_t *)s, n);
+
+  written += w;
+  if (w != n)
+  {
+    failed = true;
+  }
+}
+
+/**
+ * @brief Diese Methode zählt die Bytes einer mit print() geschriebenen Zahl.
+ *
+ * @param n Rückgabewert von print(), 0: nichts geschrieben
+ */
+void wio_json_writer::number(size_t n)
+{
+  written += n;
+  if (n == 0)
+  {
+    failed = true;
+  }
+}
+
+/**
+ * @brief Diese Methode schreibt einen String in Anführungszeichen und maskiert die Sonderzeichen.
+ *
+ * @param s String
+ */
+void wio_json_writer::putEscaped(const char *s)
+{
+  static const char hex[] = "0123456789abcdef";
+  const char *run = s; // characters without escaping are written in one block
+
+  put("\"");
+  for (; *s; s++)
+  {
+    uint8_t c = *s;
+    if (c != '"' && c != '\\' && c >= 0x20)
+    {
+      continue;
+    }
+    putBlock(run, s - run);
+    run = s + 1;
+    char esc[7] = {'\\', (char)c, 0};
+    switch (c)
+    {
+    case '\n': esc[1] = 'n'; break;
+    case '\r': esc[1] = 'r'; break;
+    case '\t': esc[1] = 't'; break;
+    case '"':
+    case '\\':
+      break;
+    default: // other control characters
+      esc[1] = 'u';
+      esc[2] = '0';
+      esc[3] = '0';
+      esc[4] = hex[c >> 4];
+      esc[5] = hex[c & 0x0F];
+      esc[6] = 0;
+      break;
+    }
+    put(esc);
+  }
+  putBlock(run, s - run);
+  put("\"");
+}
+
+/**
+ * @brief Diese Methode öffnet ein Objekt oder Array und wechselt auf die nächste Ebene.
+ *
+ * @param c '{' oder '['
+ */
+void wio_json_writer::open(char c)
+{
+  char s[2] = {c, 0};
+
+  separator();
+  put(s);
+  if (depth + 1 >= JSON_WRITER_MAX_DEPTH)
+  {
+    failed = true; // nesting too deep
+    return;
+  }
+  depth++;
+  hasElement &= ~(1 << depth);
+}
+
+/**
+ * @brief Diese Methode schliesst ein Objekt oder Array und wechselt auf die vorherige Ebene.
+ *
+ * @param c '}' oder ']'
+ */
+void wio_json_writer::close(char c)
+{
+  char s[2] = {c, 0};
+
+  if (depth > 0)
+  {
+    depth--;
+  }
+  afterKey = false;
+  put(s);
+}
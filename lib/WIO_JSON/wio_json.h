@@ -0,0 +1,112 @@
+/**
+ * @file wio_json.h
+ * @author Fabian Reifler
+ * @brief JSON Tokenizer ohne dynamischen Speicher (nach dem Vorbild von jsmn) mit Pfad-Auswahl und
+ * JSON Writer, welcher direkt in einen Ausgabestrom schreibt
+ * @version 1.1
+ * @date 19.10.2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef WIO_JSON_H
+#define WIO_JSON_H
+
+#include <Arduino.h>
+
+/********************************************************************************************
+*** Defines
+********************************************************************************************/
+#define JSON_ERROR_NOMEM -1 ///< Zu wenige Tokens für die Daten
+#define JSON_ERROR_INVAL -2 ///< Ungültiges Zeichen oder falsch verschachtelt
+#define JSON_ERROR_PART -3  ///< Die Daten sind unvollständig
+#define JSON_WRITER_MAX_DEPTH 16 ///< Maximale Verschachtelungstiefe des @ref wio_json_writer
+
+/********************************************************************************************
+*** Enumerations
+********************************************************************************************/
+/// Typ eines Tokens
+typedef enum{
+  JSON_OBJECT,      ///< Objekt { ... }
+  JSON_ARRAY,       ///< Array [ ... ]
+  JSON_STRING,      ///< String (ohne Anführungszeichen), auch Schlüssel
+  JSON_PRIMITIVE    ///< Zahl, true, false oder null
+}json_type_e;
+
+/********************************************************************************************
+*** Datatypes
+********************************************************************************************/
+/// Token, beschreibt einen Abschnitt in den JSON Daten
+typedef struct{
+  uint8_t type;       ///< Typ, siehe @ref json_type_e
+  uint16_t start;     ///< Position des ersten Zeichens
+  uint16_t end;       ///< Position nach dem letzten Zeichen
+  uint16_t size;      ///< Anzahl Kinder (Objekt: Anzahl Schlüssel, Array: Anzahl Elemente)
+  uint16_t next;      ///< Index des Tokens nach diesem Token inkl. Inhalt (nächstes Geschwister)
+  int16_t parent;     ///< Index des umgebenden Objektes oder Arrays, -1: keines
+}json_token_t;
+
+/********************************************************************************************
+*** Interface description
+********************************************************************************************/
+class wio_json
+{
+public:
+  wio_json(json_token_t *tokens, unsigned int maxTokens);  ///< Konstruktor
+  int parse(const char *js, unsigned int len);             ///< JSON Daten in Tokens zerlegen
+  int select(const char *path);                            ///< Token über einen Pfad suchen, z.B. "$.t" oder "$.a[2].b"
+  int find(int object, const char *key);                   ///< Wert zu einem Schlüssel in einem Objekt suchen
+  int element(int array, unsigned int index);              ///< Element eines Arrays suchen
+  const json_token_t *token(int index);                    ///< Token auslesen
+  bool getString(int index, char *buf, unsigned int size); ///< Wert als nullterminierten String kopieren
+  bool getFloat(int index, float *value);                  ///< Wert als Fliesskommazahl lesen
+  bool getInt(int index, long *value);                     ///< Wert als Ganzzahl lesen
+  bool equals(int index, const char *s, unsigned int len); ///< String Token mit einem Text vergleichen
+private:
+  json_token_t *tokens;                                    ///< Tokens (vom Aufrufer)
+  unsigned int maxTokens;                                  ///< Anzahl verfügbarer Tokens
+  unsigned int count = 0;                                  ///< Anzahl Tokens der letzten Zerlegung
+  const char *js = NULL;                                   ///< JSON Daten der letzten Zerlegung
+  int addToken(uint8_t type, unsigned int start, int parent); ///< Neues Token anlegen
+};
+
+/**
+ * @brief Schreibt JSON direkt in einen Ausgabestrom (z.B. @ref wio_mqtt zwischen beginMessage() und endMessage(),
+ * oder Serial). Kommas und Anführungszeichen werden automatisch gesetzt, es wird kein Zwischenpuffer verwendet.
+ */
+class wio_json_writer
+{
+public:
+  wio_json_writer(Print &out);                             ///< Konstruktor
+  void beginObject(void);                                  ///< Objekt beginnen
+  void endObject(void);                                    ///< Objekt beenden
+  void beginArray(void);                                   ///< Array beginnen
+  void endArray(void);                                     ///< Array beenden
+  void key(const char *k);                                 ///< Schlüssel in einem Objekt schreiben
+  void value(const char *s);                               ///< String schreiben
+  void value(long v);                                      ///< Ganzzahl schreiben
+  void value(int v);                                       ///< Ganzzahl schreiben
+  void value(unsigned long v);                             ///< Positive Ganzzahl schreiben
+  void value(double v, uint8_t decimals = 3);              ///< Fliesskommazahl schreiben (NaN/Inf als null)
+  void value(bool v);                                      ///< true oder false schreiben
+  void null(void);                                         ///< null schreiben
+  size_t length(void);                                     ///< Anzahl geschriebener Bytes
+  bool error(void);                                        ///< Der Ausgabestrom hat nicht alle Bytes angenommen oder zu tief verschachtelt
+private:
+  Print &out;                                              ///< Ausgabestrom
+  uint8_t depth = 0;                                       ///< Aktuelle Verschachtelungstiefe
+  uint16_t hasElement = 0;                                 ///< Bit n: Ebene n hat bereits ein Element (Komma nötig)
+  bool afterKey = false;                                   ///< Es wurde ein Schlüssel geschrieben, der Wert folgt
+  bool failed = false;                                     ///< Der Ausgabestrom hat Bytes abgelehnt
+  size_t written = 0;                                      ///< Anzahl geschriebener Bytes
+  void separator(void);                                    ///< Komma vor dem nächsten Element schreiben
+  void put(const char *s);                                 ///< String ohne Umwandlung schreiben
+  void putBlock(const char *s, size_t n);                  ///< Block ohne Umwandlung schreiben
+  void number(size_t n);                                   ///< Mit print() geschriebene Zahl zählen
+  void putEscaped(const char *s);                          ///< String mit Escape-Sequenzen schreiben
+  void open(char c);                                       ///< Objekt oder Array öffnen
+  void close(char c);                                      ///< Objekt oder Array schliessen
+};
+
+#endif
@@ -0,0 +1,702 @@
+/**
+ * @file wio_cbor.cpp
+ * @author Fabian Reifler
+ * @brief Kompakte binäre Payloads im CBOR Format (RFC 8949) ohne dynamischen Speicher \n
+ * Der Writer schreibt in einen festen Puffer, der Reader liest direkt aus dem Payload. Es werden nur Elemente
+ * mit bekannter Länge geschrieben, Fliesskommazahlen werden ohne Umwandlung in Text übertragen.
+ * @version 1.0
+ * @date 19.10.2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+/********************************************************************************************
+*** Includes
+********************************************************************************************/
+#include "wio_cbor.h"
+
+/********************************************************************************************
+*** Defines
+********************************************************************************************/
+// CBOR major types
+#define MAJOR_UINT 0
+#define MAJOR_NEGINT 1
+#define MAJOR_BYTES 2
+#define MAJOR_TEXT 3
+#define MAJOR_ARRAY 4
+#define MAJOR_MAP 5
+#define MAJOR_TAG 6
+#define MAJOR_SIMPLE 7
+
+#define CBOR_MAX_DEPTH 8 // max. nesting depth for skip()
+
+/********************************************************************************************
+*** Writer
+********************************************************************************************/
+/**
+ * @brief Konstruktor
+ *
+ * @param buf Puffer, in welchen geschrieben wird
+ * @param size Grösse des Puffers
+ */
+wio_cbor_writer::wio_cbor_writer(uint8_t *buf, unsigned int size)
+{
+  buffer = buf;
+  bufferSize = size;
+}
+
+/**
+ * @brief Diese Methode leert den Puffer, damit er für die nächste Nachricht verwendet werden kann.
+ *
+ */
+void wio_cbor_writer::reset()
+{
+  len = 0;
+  overflowed = false;
+}
+
+/**
+ * @brief Diese Methode schreibt eine positive Ganzzahl (1 - 5 Bytes).
+ *
+ * @param value Wert
+ */
+void wio_cbor_writer::writeUInt(uint32_t value)
+{
+  writeHead(MAJOR_UINT, value);
+}
+
+/**
+ * @brief Diese Methode schreibt eine Ganzzahl (1 - 5 Bytes).
+ *
+ * @param value Wert
+ */
+void wio_cbor_writer::writeInt(int32_t value)
+{
+  if (value < 0)
+  {
+    writeHead(MAJOR_NEGINT, (uint32_t)(-1 - value));
+  }
+  else
+  {
+    writeHead(MAJOR_UINT, value);
+  }
+}
+
+/**
+ * @brief Diese Methode schreibt eine Fliesskommazahl. Kann der Wert ohne Verlust als 16 Bit Zahl dargestellt
+ * werden (z.B. 21.5), werden 3 Bytes geschrieben, sonst 5 Bytes.
+ *
+ * @param value Wert
+ */
+void wio_cbor_writer::writeFloat(float value)
+{
+  uint32_t f;
+  memcpy(&f, &value, 4);
+  uint16_t sign = (f >> 16) & 0x8000;
+  int32_t exp = (f >> 23) & 0xFF;
+  uint32_t mant = f & 0x7FFFFF;
+  int32_t halfExp = exp - 127 + 15;
+  uint8_t buf[5];
+
+  if ((exp == 0 && mant == 0) || exp == 0xFF || (halfExp >= 1 && halfExp <= 30 && (mant & 0x1FFF) == 0))
+  {
+    uint16_t half;
+    if (exp == 0) // zero
+    {
+      half = sign;
+    }
+    else if (exp == 0xFF) // infinity or NaN
+    {
+      half = sign | 0x7C00 | (mant ? 0x0200 : 0);
+    }
+    else
+    {
+      half = sign | (halfExp << 10) | (mant >> 13);
+    }
+    buf[0] = (MAJOR_SIMPLE << 5) | 25;
+    buf[1] = half >> 8;
+    buf[2] = half & 0xFF;
+    put(buf, 3);
+    return;
+  }
+
+  buf[0] = (MAJOR_SIMPLE << 5) | 26;
+  buf[1] = f >> 24;
+  buf[2] = (f >> 16) & 0xFF;
+  buf[3] = (f >> 8) & 0xFF;
+  buf[4] = f & 0xFF;
+  put(buf, 5);
+}
+
+/**
+ * @brief Diese Methode schreibt true oder false (1 Byte).
+ *
+ * @param value Wert
+ */
+void wio_cbor_writer::writeBool(bool value)
+{
+  uint8_t b = (MAJOR_SIMPLE << 5) | (value ? 21 : 20);
+  put(&b, 1);
+}
+
+/**
+ * @brief Diese Methode schreibt null (1 Byte).
+ *
+ */
+void wio_cbor_writer::writeNull()
+{
+  uint8_t b = (MAJOR_SIMPLE << 5) | 22;
+  put(&b, 1);
+}
+
+/**
+ * @brief Diese Methode schreibt einen Text String.
+ *
+ * @param s String (nullterminiert)
+ */
+void wio_cbor_writer::writeString(const char *s)
+{
+  unsigned int n = strlen(s);
+  writeHead(MAJOR_TEXT, n);
+  put((const uint8_t *)s, n);
+}
+
+/**
+ * @brief Diese Methode schreibt einen Byte String.
+ *
+ * @param data Bytes
+ * @param n Anzahl Bytes
+ */
+void wio_cbor_writer::writeBytes(const uint8_t *data, unsigned int n)
+{
+  writeHead(MAJOR_BYTES, n);
+  put(data, n);
+}
+
+/**
+ * @brief Diese Methode beginnt ein Array. Danach müssen genau @p count Elemente geschrieben werden.
+ *
+ * @param count Anzahl Elemente
+ */
+void wio_cbor_writer::beginArray(unsigned int count)
+{
+  writeHead(MAJOR_ARRAY, count);
+}
+
+/**
+ * @brief Diese Methode beginnt eine Map. Danach müssen genau @p count Schlüssel/Wert Paare geschrieben werden.
+ *
+ * @param count Anzahl Paare
+ */
+void wio_cbor_writer::beginMap(unsigned int count)
+{
+  writeHead(MAJOR_MAP, count);
+}
+
+/**
+ * @brief Diese Methode gibt einen Zeiger auf die geschriebenen Daten zurück.
+ *
+ * @return const uint8_t* Zeiger auf den Puffer
+ */
+const uint8_t *wio_cbor_writer::data()
+{
+  return buffer;
+}
+
+/**
+ * @brief Diese Methode gibt die Anzahl geschriebener Bytes zurück.
+ *
+ * @return unsigned int Anzahl Bytes
+ */
+unsigned int wio_cbor_writer::length()
+{
+  return len;
+}
+
+/**
+ * @brief Diese Methode gibt zurück, ob der Puffer übergelaufen ist. Die Daten sind dann unvollständig.
+ *
+ * @return true Der Puffer ist übergelaufen
+ * @return false Alle Elemente wurden geschrieben
+ */
+bool wio_cbor_writer::overflow()
+{
+  return overflowed;
+}
+
+/**
+ * @brief Diese Methode schreibt den Kopf eines Elementes mit der kürzest möglichen Länge.
+ *
+ * @param major Major Type
+ * @param value Wert bzw. Länge
+ */
+void wio_cbor_writer::writeHead(uint8_t major, uint32_t value)
+{
+  uint8_t buf[5];
+  unsigned int n;
+
+  if (value < 24)
+  {
+    buf[0] = (major << 5) | value;
+    n = 1;
+  }
+  else if (value <= 0xFF)
+  {
+    buf[0] = (major << 5) | 24;
+    buf[1] = value;
+    n = 2;
+  }
+  else if (value <= 0xFFFF)
+  {
+    buf[0] = (major << 5) | 25;
+    buf[1] = value >> 8;
+    buf[2] = value & 0xFF;
+    n = 3;
+  }
+  else
+  {
+    buf[0] = (major << 5) | 26;
+    buf[1] = value >> 24;
+    buf[2] = (value >> 16) & 0xFF;
+    buf[3] = (value >> 8) & 0xFF;
+    buf[4] = value & 0xFF;
+    n = 5;
+  }
+  put(buf, n);
+}
+
+/**
+ * @brief Diese Methode schreibt Bytes in den Puffer.
+ *
+ * @param data Bytes
+ * @param n Anzahl Bytes
+ */
+void wio_cbor_writer::put(const uint8_t *data, unsigned int n)
+{
+  if (overflowed || len + n > bufferSize)
+  {
+    overflowed = true;
+    return;
+  }
+  memcpy(&buffer[len], data, n);
+  len += n;
+}
+
+/********************************************************************************************
+*** Reader
+********************************************************************************************/
+/**
+ * @brief Konstruktor
+ *
+ * @param buf Daten, z.B. der Payload einer Nachricht
+ * @param size Anzahl Bytes
+ */
+wio_cbor_reader::wio_cbor_reader(const uint8_t *buf, unsigned int size)
+{
+  buffer = buf;
+  bufferSize = size;
+}
+
+/**
+ * @brief Diese Methode gibt den Datentyp des nächsten Elementes zurück, ohne es zu lesen.
+ *
+ * @return cbor_type_e Datentyp
+ */
+cbor_type_e wio_cbor_reader::peekType()
+{
+  if (pos >= bufferSize)
+  {
+    return CBOR_END;
+  }
+  uint8_t major = buffer[pos] >> 5;
+  uint8_t info = buffer[pos] & 0x1F;
+
+  switch (major)
+  {
+  case MAJOR_UINT:
+    return CBOR_UINT;
+  case MAJOR_NEGINT:
+    return CBOR_NEGINT;
+  case MAJOR_BYTES:
+    return CBOR_BYTES;
+  case MAJOR_TEXT:
+    return CBOR_TEXT;
+  case MAJOR_ARRAY:
+    return CBOR_ARRAY;
+  case MAJOR_MAP:
+    return CBOR_MAP;
+  case MAJOR_SIMPLE:
+    if (info == 20 || info == 21)
+    {
+      return CBOR_BOOL;
+    }
+    if (info == 22 || info == 23)
+    {
+      return CBOR_NULL;
+    }
+    if (info >= 25 && info <= 27)
+    {
+      return CBOR_FLOAT;
+    }
+    return CBOR_INVALID;
+  default: // tags are not supported
+    return CBOR_INVALID;
+  }
+}
+
+/**
+ * @brief Diese Methode liest eine positive Ganzzahl.
+ *
+ * @param value Gelesener Wert
+ * @return true Der Wert wurde gelesen
+ * @return false Das nächste Element ist keine positive Ganzzahl oder zu gross
+ */
+bool wio_cbor_reader::readUInt(uint32_t *value)
+{
+  unsigned int start = pos;
+  uint8_t major, info;
+  uint64_t v;
+
+  if (!readHead(&major, &info, &v) || major != MAJOR_UINT || v > 0xFFFFFFFFUL)
+  {
+    pos = start;
+    return false;
+  }
+  *value = v;
+  return true;
+}
+
+/**
+ * @brief Diese Methode liest eine Ganzzahl.
+ *
+ * @param value Gelesener Wert
+ * @return true Der Wert wurde gelesen
+ * @return false Das nächste Element ist keine Ganzzahl oder ausserhalb des Wertebereiches
+ */
+bool wio_cbor_reader::readInt(int32_t *value)
+{
+  unsigned int start = pos;
+  uint8_t major, info;
+  uint64_t v;
+
+  if (!readHead(&major, &info, &v) || (major != MAJOR_UINT && major != MAJOR_NEGINT) || v > 0x7FFFFFFFUL)
+  {
+    pos = start;
+    return false;
+  }
+  *value = (major == MAJOR_UINT) ? (int32_t)v : -1 - (int32_t)v;
+  return true;
+}
+
+/**
+ * @brief Diese Methode liest eine Fliesskommazahl. Ganzzahlen werden ebenfalls akzeptiert und umgewandelt.
+ *
+ * @param value Gelesener Wert
+ * @return true Der Wert wurde gelesen
+ * @return false Das nächste Element ist keine Zahl
+ */
+bool wio_cbor_reader::readFloat(float *value)
+{
+  unsigned int start = pos;
+  uint8_t major, info;
+  uint64_t v;
+
+  if (!readHead(&major, &info, &v))
+  {
+    pos = start;
+    return false;
+  }
+  if (major == MAJOR_UINT)
+  {
+    *value = (float)v;
+    return true;
+  }
+  if (major == MAJOR_NEGINT)
+  {
+    *value = -1.0f - (float)v;
+    return true;
+  }
+  if (major == MAJOR_SIMPLE && info == 25) // half precision
+  {
+    int exp = (v >> 10) & 0x1F;
+    int mant = v & 0x3FF;
+    float f;
+    if (exp == 0)
+    {
+      f = ldexpf(mant, -24);
+    }
+    else if (exp != 31)
+    {
+      f = ldexpf(mant + 1024, exp - 25);
+    }
+    else
+    {
+      f = mant ? NAN : INFINITY;
+    }
+    *value = (v & 0x8000) ? -f : f;
+    return true;
+  }
+  if (major == MAJOR_SIMPLE && info == 26) // single precision
+  {
+    uint32_t f = v;
+    memcpy(value, &f, 4);
+    return true;
+  }
+  if (major == MAJOR_SIMPLE && info == 27) // double precision
+  {
+    double d;
+    memcpy(&d, &v, 8);
+    *value = (float)d;
+    return true;
+  }
+  pos = start;
+  return false;
+}
+
+/**
+ * @brief Diese Methode liest true oder false.
+ *
+ * @param value Gelesener Wert
+ * @return true Der Wert wurde gelesen
+ * @return false Das nächste Element ist kein Boolean
+ */
+bool wio_cbor_reader::readBool(bool *value)
+{
+  if (peekType() != CBOR_BOOL)
+  {
+    return false;
+  }
+  *value = (buffer[pos++] & 0x1F) == 21;
+  return true;
+}
+
+/**
+ * @brief Diese Methode liest null oder undefined.
+ *
+ * @return true null wurde gelesen
+ * @return false Das nächste Element ist nicht null
+ */
+bool wio_cbor_reader::readNull()
+{
+  if (peekType() != CBOR_NULL)
+  {
+    return false;
+  }
+  pos++;
+  return true;
+}
+
+/**
+ * @brief Diese Methode liest einen Text String. Der String wird nicht kopiert.
+ * @attention Der String ist nicht nullterminiert und nur gültig, solange der Puffer gültig ist.
+ *
+ * @param s Zeiger auf den String im Puffer
+ * @param len Länge des Strings
+ * @return true Der String wurde gelesen
+ * @return false Das nächste Element ist kein Text String
+ */
+bool wio_cbor_reader::readString(const char **s, unsigned int *len)
+{
+  if (peekType() != CBOR_TEXT)
+  {
+    return false;
+  }
+  return readBytes((const uint8_t **)s, len);
+}
+
+/**
+ * @brief Diese Methode liest einen Byte String (oder Text String). Die Bytes werden nicht kopiert.
+ *
+ * @param data Zeiger auf die Bytes im Puffer
+ * @param len Anzahl Bytes
+ * @return true Der String wurde gelesen
+ * @return false Das nächste Element ist kein String oder unvollständig
+ */
+bool wio_cbor_reader::readBytes(const uint8_t **data, unsigned int *len)
+{
+  unsigned int start = pos;
+  uint8_t major, info;
+  uint64_t v;
+
+  if (!readHead(&major, &info, &v) || (major != MAJOR_BYTES && major != MAJOR_TEXT) || info == 31 || v > bufferSize - pos)
+  {
+    pos = start; // indefinite length strings are not supported
+    return false;
+  }
+  *data = &buffer[pos];
+  *len = v;
+  pos += v;
+  return true;
+}
+
+/**
+ * @brief Diese Methode liest den Beginn eines Arrays. Danach folgen @p count Elemente.
+ *
+ * @param count Anzahl Elemente
+ * @return true Der Beginn wurde gelesen
+ * @return false Das nächste Element ist kein Array (oder hat keine feste Länge)
+ */
+bool wio_cbor_reader::readArray(unsigned int *count)
+{
+  unsigned int start = pos;
+  uint8_t major, info;
+  uint64_t v;
+
+  if (!readHead(&major, &info, &v) || major != MAJOR_ARRAY || info == 31)
+  {
+    pos = start;
+    return false;
+  }
+  *count = v;
+  return true;
+}
+
+/**
+ * @brief Diese Methode liest den Beginn einer Map. Danach folgen @p count Schlüssel/Wert Paare.
+ *
+ * @param count Anzahl Paare
+ * @return true Der Beginn wurde gelesen
+ * @return false Das nächste Element ist keine Map (oder hat keine feste Länge)
+ */
+bool wio_cbor_reader::readMap(unsigned int *count)
+{
+  unsigned int start = pos;
+  uint8_t major, info;
+  uint64_t v;
+
+  if (!readHead(&major, &info, &v) || major != MAJOR_MAP || info == 31)
+  {
+    pos = start;
+    return false;
+  }
+  *count = v;
+  return true;
+}
+
+/**
+ * @brief Diese Methode überspringt das nächste Element, bei Arrays und Maps inklusive Inhalt.
+ *
+ * @return true Das Element wurde übersprungen
+ * @return false Die Daten sind ungültig oder zu tief verschachtelt
+ */
+bool wio_cbor_reader::skip()
+{
+  unsigned int start = pos;
+
+  if (!skipDepth(0))
+  {
+    pos = start;
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Diese Methode gibt zurück, ob alle Daten gelesen wurden.
+ *
+ * @return true Alle Daten wurden gelesen
+ * @return false Es sind noch Daten vorhanden
+ */
+bool wio_cbor_reader::atEnd()
+{
+  return pos >= bufferSize;
+}
+
+/**
+ * @brief Diese Methode gibt die Anzahl gelesener Bytes zurück.
+ *
+ * @return unsigned int Anzahl Bytes
+ */
+unsigned int wio_cbor_reader::position()
+{
+  return pos;
+}
+
+/**
+ * @brief Diese Methode liest den Kopf eines Elementes.
+ *
+ * @param major Major Type
+ * @param info Additional Information (Länge des Wertes)
+ * @param value Wert bzw. Länge
+ * @return true Der Kopf wurde gelesen
+ * @return false Die Daten sind unvollständig oder ungültig
+ */
+bool wio_cbor_reader::readHead(uint8_t *major, uint8_t *info, uint64_t *value)
+{
+  unsigned int n;
+
+  if (pos >= bufferSize)
+  {
+    return false;
+  }
+  *major = buffer[pos] >> 5;
+  *info = buffer[pos] & 0x1F;
+  pos++;
+
+  if (*info < 24 || *info == 31) // value in the first byte or indefinite length
+  {
+    *value = (*info == 31) ? 0 : *info;
+    return true;
+  }
+  if (*info > 27)
+  {
+    return false;
+  }
+  n = 1 << (*info - 24); // 1, 2, 4 or 8 bytes
+  if (n > bufferSize - pos)
+  {
+    return false;
+  }
+  *value = 0;
+  for (unsigned int i = 0; i < n; i++)
+  {
+    *value = (*value << 8) | buffer[pos++];
+  }
+  return true;
+}
+
+/**
+ * @brief Diese Methode überspringt ein Element rekursiv.
+ *
+ * @param depth Aktuelle Verschachtelungstiefe
+ * @return true Das Element wurde übersprungen
+ * @return false Die Daten sind ungültig oder zu tief verschachtelt
+ */
+bool wio_cbor_reader::skipDepth(uint8_t depth)
+{
+  uint8_t major, info;
+  uint64_t v;
+
+  if (depth > CBOR_MAX_DEPTH || !readHead(&major, &info, &v) || info == 31)
+  {
+    return false;
+  }
+  switch (major)
+  {
+  case MAJOR_BYTES:
+  case MAJOR_TEXT:
+    if (v > bufferSize - pos)
+    {
+      return false;
+    }
+    pos += v;
+    return true;
+  case MAJOR_MAP:
+    v *= 2; // key and value
+    // fall through
+  case MAJOR_ARRAY:
+    for (uint64_t i = 0; i < v; i++)
+    {
+      if (!skipDepth(depth + 1))
+      {
+        return false;
+      }
+    }
+    return true;
+  case MAJOR_TAG:
+    return skipDepth(depth + 1); // tagged element
+  default:
+    return true;
+  }
+}
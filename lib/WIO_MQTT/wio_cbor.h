@@ -0,0 +1,97 @@
+/**
+ * @file wio_cbor.h
+ * @author Fabian Reifler
+ * @brief Kompakte binäre Payloads im CBOR Format (RFC 8949) ohne dynamischen Speicher
+ * @version 1.0
+ * @date 19.10.2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef WIO_CBOR_H
+#define WIO_CBOR_H
+
+#include <Arduino.h>
+
+/********************************************************************************************
+*** Enumerations
+********************************************************************************************/
+/// Datentyp des nächsten Elementes, siehe @ref wio_cbor_reader::peekType()
+typedef enum{
+  CBOR_UINT,      ///< Positive Ganzzahl
+  CBOR_NEGINT,    ///< Negative Ganzzahl
+  CBOR_BYTES,     ///< Byte String
+  CBOR_TEXT,      ///< Text String (UTF-8)
+  CBOR_ARRAY,     ///< Array
+  CBOR_MAP,       ///< Map (Schlüssel/Wert Paare)
+  CBOR_FLOAT,     ///< Fliesskommazahl (16, 32 oder 64 Bit)
+  CBOR_BOOL,      ///< true oder false
+  CBOR_NULL,      ///< null oder undefined
+  CBOR_END,       ///< Ende der Daten erreicht
+  CBOR_INVALID    ///< Ungültige oder nicht unterstützte Daten
+}cbor_type_e;
+
+/********************************************************************************************
+*** Interface description
+********************************************************************************************/
+/**
+ * @brief Schreibt CBOR Elemente in einen festen Puffer. Läuft der Puffer über, werden keine weiteren
+ * Elemente geschrieben und @ref overflow() gibt true zurück.
+ */
+class wio_cbor_writer
+{
+public:
+  wio_cbor_writer(uint8_t *buf, unsigned int size);       ///< Konstruktor
+  void reset(void);                                       ///< Puffer leeren
+  void writeUInt(uint32_t value);                         ///< Positive Ganzzahl schreiben
+  void writeInt(int32_t value);                           ///< Ganzzahl schreiben
+  void writeFloat(float value);                           ///< Fliesskommazahl schreiben (16 Bit, wenn verlustfrei möglich)
+  void writeBool(bool value);                             ///< true oder false schreiben
+  void writeNull(void);                                   ///< null schreiben
+  void writeString(const char *s);                        ///< Text String schreiben
+  void writeBytes(const uint8_t *data, unsigned int len); ///< Byte String schreiben
+  void beginArray(unsigned int count);                    ///< Array mit count Elementen beginnen
+  void beginMap(unsigned int count);                      ///< Map mit count Schlüssel/Wert Paaren beginnen
+  const uint8_t *data(void);                              ///< Zeiger auf die geschriebenen Daten
+  unsigned int length(void);                              ///< Anzahl geschriebener Bytes
+  bool overflow(void);                                    ///< Der Puffer ist übergelaufen
+private:
+  uint8_t *buffer;                                        ///< Puffer
+  unsigned int bufferSize;                                ///< Grösse des Puffers
+  unsigned int len = 0;                                   ///< Anzahl geschriebener Bytes
+  bool overflowed = false;                                ///< Der Puffer ist übergelaufen
+  void writeHead(uint8_t major, uint32_t value);          ///< Kopf eines Elementes schreiben
+  void put(const uint8_t *data, unsigned int n);          ///< Bytes in den Puffer schreiben
+};
+
+/**
+ * @brief Liest CBOR Elemente direkt aus einem Puffer (z.B. dem Payload einer Nachricht). Strings werden
+ * nicht kopiert, sondern als Zeiger in den Puffer zurückgegeben.
+ */
+class wio_cbor_reader
+{
+public:
+  wio_cbor_reader(const uint8_t *buf, unsigned int size); ///< Konstruktor
+  cbor_type_e peekType(void);                             ///< Datentyp des nächsten Elementes
+  bool readUInt(uint32_t *value);                         ///< Positive Ganzzahl lesen
+  bool readInt(int32_t *value);                           ///< Ganzzahl lesen
+  bool readFloat(float *value);                           ///< Fliesskommazahl lesen (Ganzzahlen werden umgewandelt)
+  bool readBool(bool *value);                             ///< true oder false lesen
+  bool readNull(void);                                    ///< null lesen
+  bool readString(const char **s, unsigned int *len);     ///< Text String lesen (nicht nullterminiert)
+  bool readBytes(const uint8_t **data, unsigned int *len); ///< Byte String lesen
+  bool readArray(unsigned int *count);                    ///< Beginn eines Arrays lesen
+  bool readMap(unsigned int *count);                      ///< Beginn einer Map lesen
+  bool skip(void);                                        ///< Nächstes Element (inkl. Inhalt) überspringen
+  bool atEnd(void);                                       ///< Alle Daten wurden gelesen
+  unsigned int position(void);                            ///< Anzahl gelesener Bytes
+private:
+  const uint8_t *buffer;                                  ///< Puffer
+  unsigned int bufferSize;                                ///< Anzahl Bytes im Puffer
+  unsigned int pos = 0;                                   ///< Position des nächsten Elementes
+  bool readHead(uint8_t *major, uint8_t *info, uint64_t *value); ///< Kopf eines Elementes lesen
+  bool skipDepth(uint8_t depth);                          ///< Element überspringen (mit Verschachtelungstiefe)
+};
+
+#endif
@@ -0,0 +1,272 @@
+/**
+ * @file wio_dns_cache.cpp
+ * @author Fabian Reifler
+ * @brief Cache für die Namensauflösung (DNS) der Broker Adressen \n
+ * WiFi.hostByName() blockiert, bis der DNS Server antwortet oder die Abfrage abläuft. Damit ein Verbindungsaufbau
+ * nicht darauf warten muss, liefert @ref wio_dns_cache::resolveCached() die Adresse nur aus dem Cache. Abgefragt wird
+ * ausschliesslich von @ref wio_dns_cache::handler(), während ohnehin auf den nächsten Verbindungsversuch gewartet
+ * wird (nie während einer bestehenden Verbindung): Namen ohne Adresse, mit @ref wio_dns_cache::expire() markierte
+ * Namen und Namen, deren Gültigkeit @ref DNS_CACHE_TTL in weniger als @ref DNS_CACHE_REFRESH_AHEAD abläuft. Ist die
+ * Gültigkeit abgelaufen, wird die zuletzt bekannte Adresse weiter verwendet, bis eine Abfrage erfolgreich war.
+ * @version 1.2
+ * @date 19.10.2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+/********************************************************************************************
+*** Includes
+********************************************************************************************/
+#include "wio_dns_cache.h"
+#include <rpcWiFi.h>
+
+/********************************************************************************************
+*** Constructor
+********************************************************************************************/
+/**
+ * @brief Konstruktor
+ *
+ */
+wio_dns_cache::wio_dns_cache()
+{
+  memset(entries, 0, sizeof(entries));
+}
+
+/********************************************************************************************
+*** Public Methodes
+********************************************************************************************/
+/**
+ * @brief Diese Methode trägt einen Namen in den Cache ein, ohne ihn aufzulösen. Eingetragene Namen werden von
+ * @ref handler() im Hintergrund aufgelöst, z.B. die Ersatzbroker, bevor zu ihnen gewechselt wird.
+ *
+ * @param host Name
+ * @return int Index des Eintrages, -1: Cache voll, Name zu lang oder eine IP Adresse
+ */
+int wio_dns_cache::add(const char *host)
+{
+  IPAddress address;
+  int index = find(host);
+
+  if (index >= 0)
+  {
+    return index;
+  }
+  if (count >= DNS_CACHE_SIZE || strlen(host) >= DNS_CACHE_HOST_LENGTH || address.fromString(host))
+  {
+    return -1;
+  }
+  dns_entry_t *entry = &entries[count];
+  memset(entry, 0, sizeof(dns_entry_t));
+  strcpy(entry->host, host);
+  return count++;
+}
+
+/**
+ * @brief Diese Methode gibt die Adresse eines Namens zurück. Ist bereits eine Adresse bekannt, wird sie ohne
+ * Abfrage zurückgegeben, auch wenn ihre Gültigkeit abgelaufen ist (dann wird sie von @ref handler() neu aufgelöst).
+ * Nur wenn noch keine Adresse bekannt ist, wird der DNS Server abgefragt (blockierend).
+ * @note Ist @p host eine IP Adresse, wird sie direkt umgewandelt.
+ *
+ * @param host Name oder IP Adresse
+ * @param address Aufgelöste Adresse
+ * @return true Adresse gefunden
+ * @return false Der Name konnte (noch) nicht aufgelöst werden
+ */
+bool wio_dns_cache::resolve(const char *host, IPAddress &address)
+{
+  if (resolveCached(host, address)) // known address, don't wait for DNS
+  {
+    return true;
+  }
+  int index = find(host);
+  if (index < 0)
+  {
+    return WiFi.hostByName(host, address) == 1; // cache full: resolve without caching
+  }
+  dns_entry_t *entry = &entries[index];
+
+  if (entry->lookups > 0 && millis() - entry->attemptAt < DNS_CACHE_RETRY_INTERVAL)
+  {
+    return false; // failed just before, don't block again
+  }
+  if (!lookup(entry))
+  {
+    return false;
+  }
+  address = IPAddress(entry->address);
+  return true;
+}
+
+/**
+ * @brief Diese Methode gibt die Adresse eines Namens nur aus dem Cache zurück, der DNS Server wird nie abgefragt.
+ * Ist die Gültigkeit abgelaufen, wird die Adresse trotzdem zurückgegeben und zum neu Auflösen markiert. Ein
+ * unbekannter Name wird eingetragen und später von @ref handler() aufgelöst.
+ *
+ * @param host Name oder IP Adresse
+ * @param address Adresse aus dem Cache
+ * @return true Adresse gefunden
+ * @return false Für den Namen ist noch keine Adresse bekannt
+ */
+bool wio_dns_cache::resolveCached(const char *host, IPAddress &address)
+{
+  if (address.fromString(host))
+  {
+    return true;
+  }
+  int index = add(host);
+  if (index < 0 || entries[index].address == 0)
+  {
+    return false;
+  }
+  dns_entry_t *entry = &entries[index];
+
+  entry->hits++;
+  if (millis() - entry->resolvedAt >= DNS_CACHE_TTL)
+  {
+    entry->staleHits++;
+    entry->refresh = true;
+  }
+  address = IPAddress(entry->address);
+  return true;
+}
+
+/**
+ * @brief Diese Methode löst höchstens einen fälligen Eintrag neu auf: Namen, die noch nie aufgelöst wurden, deren
+ * Gültigkeit in weniger als @ref DNS_CACHE_REFRESH_AHEAD abläuft oder die mit @ref expire() markiert wurden.
+ * Derselbe Name wird höchstens alle @ref DNS_CACHE_RETRY_INTERVAL abgefragt.
+ * @note Die Abfrage blockiert und kann nicht abgebrochen werden. Die Methode darf deshalb nur aufgerufen werden,
+ * wenn ohnehin gewartet wird. Gestartet wird eine Abfrage nur, wenn die letzte Abfrage dieses Namens in
+ * @p budget Platz hatte (ein noch nie abgefragter Name immer).
+ *
+ * @param budget Zeit in ms, welche gewartet werden darf
+ * @return true Es wurde ein Name abgefragt
+ * @return false Kein Eintrag fällig oder zu wenig Zeit
+ */
+bool wio_dns_cache::handler(unsigned long budget)
+{
+  unsigned long now = millis();
+
+  for (int i = 0; i < count; i++)
+  {
+    if (isDue(&entries[i], now) && entries[i].lastLookupMs <= budget)
+    {
+      lookup(&entries[i]);
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief Diese Methode markiert einen Namen zum neu Auflösen, z.B. wenn die Verbindung zur gespeicherten
+ * Adresse fehlgeschlagen ist. Die gespeicherte Adresse bleibt bis zur erfolgreichen Abfrage gültig.
+ *
+ * @param host Name
+ */
+void wio_dns_cache::expire(const char *host)
+{
+  int index = find(host);
+
+  if (index >= 0)
+  {
+    entries[index].refresh = true;
+  }
+}
+
+/**
+ * @brief Diese Methode gibt einen Eintrag des Caches zurück.
+ *
+ * @param index Index des Eintrages
+ * @return const dns_entry_t* Eintrag, NULL bei ungültigem Index
+ */
+const dns_entry_t *wio_dns_cache::get(int index)
+{
+  if (index < 0 || index >= count)
+  {
+    return NULL;
+  }
+  return &entries[index];
+}
+
+/**
+ * @brief Diese Methode gibt die Anzahl Einträge im Cache zurück.
+ *
+ * @return int Anzahl Einträge
+ */
+int wio_dns_cache::getCount(void)
+{
+  return count;
+}
+
+/********************************************************************************************
+*** Private Methodes
+********************************************************************************************/
+/**
+ * @brief Diese Methode sucht den Eintrag eines Namens.
+ *
+ * @param host Name
+ * @return int Index des Eintrages, -1: nicht gefunden
+ */
+int wio_dns_cache::find(const char *host)
+{
+  for (int i = 0; i < count; i++)
+  {
+    if (strcmp(entries[i].host, host) == 0)
+    {
+      return i;
+    }
+  }
+  return -1;
+}
+
+/**
+ * @brief Diese Methode prüft, ob ein Eintrag neu aufgelöst werden muss.
+ *
+ * @param entry Eintrag
+ * @param now Aktuelle Zeit (millis)
+ * @return true Der Eintrag ist fällig
+ * @return false Die Adresse ist noch gültig oder die letzte Abfrage liegt weniger als @ref DNS_CACHE_RETRY_INTERVAL zurück
+ */
+bool wio_dns_cache::isDue(const dns_entry_t *entry, unsigned long now)
+{
+  if (entry->lookups > 0 && now - entry->attemptAt < DNS_CACHE_RETRY_INTERVAL)
+  {
+    return false;
+  }
+  return entry->address == 0 || entry->refresh || now - entry->resolvedAt >= DNS_CACHE_TTL - DNS_CACHE_REFRESH_AHEAD;
+}
+
+/**
+ * @brief Diese Methode fragt einen Namen beim DNS Server ab. Schlägt die Abfrage fehl, bleibt die zuletzt
+ * bekannte Adresse erhalten.
+ *
+ * @param entry Eintrag
+ * @return true Der Name wurde aufgelöst
+ * @return false Keine Antwort oder der Name ist unbekannt
+ */
+bool wio_dns_cache::lookup(dns_entry_t *entry)
+{
+  IPAddress result;
+  unsigned long start = millis();
+  bool ok = WiFi.hostByName(entry->host, result) == 1 && (uint32_t)result != 0;
+  unsigned long now = millis();
+
+  entry->lookups++;
+  entry->attemptAt = now;
+  entry->lastLookupMs = now - start;
+  if (!ok)
+  {
+    entry->failures++;
+    return false;
+  }
+  if (entry->address != 0 && entry->address != (uint32_t)result)
+  {
+    Serial.print("DNS: new address for ");
+    Serial.println(entry->host);
+  }
+  entry->address = (uint32_t)result;
+  entry->resolvedAt = now;
+  entry->refresh = false;
+  return true;
+}
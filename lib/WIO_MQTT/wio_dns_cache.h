@@ -0,0 +1,65 @@
+/**
+ * @file wio_dns_cache.h
+ * @author Fabian Reifler
+ * @brief Cache für die Namensauflösung (DNS) der Broker Adressen
+ * @version 1.2
+ * @date 19.10.2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef WIO_DNS_CACHE_H
+#define WIO_DNS_CACHE_H
+
+#include <Arduino.h>
+
+/********************************************************************************************
+*** Defines
+********************************************************************************************/
+#define DNS_CACHE_SIZE 4                ///< Anzahl Namen im Cache
+#define DNS_CACHE_HOST_LENGTH 40        ///< Maximale Länge eines Namens (wie MQTT_BROKER_HOST_LENGTH)
+#define DNS_CACHE_TTL 300000            ///< Gültigkeit einer Auflösung in ms (die TTL des DNS Eintrages ist über rpcWiFi nicht verfügbar)
+#define DNS_CACHE_REFRESH_AHEAD 60000   ///< So viele ms vor Ablauf der Gültigkeit wird neu aufgelöst, falls gerade ein Verbindungsversuch wartet
+#define DNS_CACHE_RETRY_INTERVAL 30000  ///< Minimale Zeit in ms zwischen zwei Abfragen desselben Namens
+
+/********************************************************************************************
+*** Datatypes
+********************************************************************************************/
+/// Eintrag des DNS Caches
+typedef struct{
+  char host[DNS_CACHE_HOST_LENGTH]; ///< Name
+  uint32_t address;       ///< Zuletzt aufgelöste Adresse, 0: noch nie aufgelöst
+  uint32_t resolvedAt;    ///< Zeitpunkt der letzten erfolgreichen Abfrage (millis)
+  uint32_t attemptAt;     ///< Zeitpunkt der letzten Abfrage (millis)
+  uint32_t lookups;       ///< Anzahl Abfragen beim DNS Server
+  uint32_t failures;      ///< Anzahl fehlgeschlagener Abfragen
+  uint32_t hits;          ///< Anzahl Auflösungen aus dem Cache ohne Abfrage
+  uint32_t staleHits;     ///< Davon nach Ablauf der Gültigkeit (letzte bekannte Adresse, DNS nicht erreichbar)
+  uint32_t lastLookupMs;  ///< Dauer der letzten Abfrage in ms
+  bool refresh;           ///< Beim nächsten Aufruf von @ref wio_dns_cache::handler() neu auflösen
+}dns_entry_t;
+
+/********************************************************************************************
+*** Interface description
+********************************************************************************************/
+class wio_dns_cache
+{
+public:
+  wio_dns_cache();                                        ///< Konstruktor
+  int add(const char *host);                              ///< Namen eintragen, ohne ihn aufzulösen
+  bool resolve(const char *host, IPAddress &address);     ///< Adresse aus dem Cache, nur bei der ersten Auflösung wird gewartet
+  bool resolveCached(const char *host, IPAddress &address); ///< Adresse nur aus dem Cache, wartet nie
+  bool handler(unsigned long budget);                     ///< Höchstens einen fälligen Eintrag neu auflösen, dessen letzte Abfrage in die Wartezeit passt
+  void expire(const char *host);                          ///< Eintrag beim nächsten Aufruf von handler() neu auflösen
+  const dns_entry_t *get(int index);                      ///< Eintrag auslesen
+  int getCount(void);                                     ///< Anzahl Einträge
+private:
+  dns_entry_t entries[DNS_CACHE_SIZE];                    ///< Einträge
+  int count = 0;                                          ///< Anzahl belegter Einträge
+  int find(const char *host);                             ///< Eintrag eines Namens suchen
+  bool isDue(const dns_entry_t *entry, unsigned long now); ///< Muss der Eintrag neu aufgelöst werden?
+  bool lookup(dns_entry_t *entry);                        ///< Namen beim DNS Server abfragen (blockierend)
+};
+
+#endif
@@ -1,8 +1,30 @@
 /**
  * @file wio_mqtt.cpp
  * @author Beat Sturzenegger / Fabian Reifler
- * @brief IoTB MQTT Bibliothek für das WIO Terminal
- * @version 1.5
+ * @brief IoTB MQTT Bibliothek für das WIO Terminal \n
+ * Die Verbindung zum Broker wird mit einer nicht blockierenden Zustandsmaschine aufgebaut
+ * (TCP Verbindung, CONNECT/CONNACK, Topics abonnieren, verbunden). Die MQTT 3.1.1 Pakete
+ * werden direkt über den WiFiClient gesendet und empfangen. Abonnements werden in einer Topic Tabelle
+ * verwaltet und können zur Laufzeit hinzugefügt und gekündigt werden. Nachrichten, welche grösser als der
+ * Empfangspuffer sind, können in Teilstücken an einen Handler weitergegeben werden. Messwerte können mit
+ * Totband und Heartbeat verwaltet publiziert werden. Mit beginMessage()/endMessage() wird der Payload
+ * direkt in den Sendepuffer geschrieben (z.B. mit @ref wio_json_writer). \n
+ * Nachrichten mit QoS 1 werden in eine Warteschlange im RAM aufgenommen. Bis zu @ref MQTT_QOS1_WINDOW_DEFAULT
+ * Nachrichten sind gleichzeitig ohne PUBACK unterwegs, unbestätigte Nachrichten werden nach einem Timeout
+ * oder nach einer Wiederverbindung wiederholt. \n
+ * Ist in secrets.h ein CA Zertifikat hinterlegt, wird die Verbindung mit TLS verschlüsselt (siehe @ref wio_tls).
+ * Die TLS Session wird bei einer Wiederverbindung wiederaufgenommen, der Handshake ist ein eigener Zustand. \n
+ * Es können mehrere Broker angegeben werden. Verbunden wird mit dem besten erreichbaren Broker (gemessene Latenz,
+ * Reihenfolge der Liste). Antwortet er nicht mehr, wird ohne Wartezeit auf den nächsten gewechselt. Während
+ * der Verbindung werden die anderen Broker periodisch gemessen, auf einen besseren wird erst nach mehreren
+ * erfolgreichen Messungen zurückgewechselt (Hysterese). \n
+ * Broker Namen werden über einen DNS Cache aufgelöst (siehe @ref wio_dns_cache), ein Verbindungsaufbau wartet nie
+ * auf den DNS Server. Ist für einen Namen noch keine Adresse bekannt, wird der nächste Broker versucht. Aufgelöst
+ * wird nur während der Wartezeit zwischen zwei Verbindungsversuchen, nie während einer bestehenden Verbindung. \n
+ * Der letzte Wert jedes abonnierten Topics wird mit Zeitstempel und Anzahl Nachrichten zwischengespeichert. \n
+ * Eingehende Nachrichten werden pro Topic zusammengefasst: bis zur Weitergabe ersetzt eine neue Nachricht die
+ * ältere desselben Topics. Pro @ref wio_mqtt::clientLoop() Aufruf wird jedes Topic höchstens einmal weitergegeben.
+ * @version 1.27
  * @date 08.03.2023
  *
  * @copyright Copyright (c) 2023
@@ -12,17 +34,122 @@
 /********************************************************************************************
 *** Includes
 ********************************************************************************************/
-#include <ArduinoMqttClient.h>
 #include <rpcWiFi.h>
 #include "wio_mqtt.h"
+#include "wio_topic_table.h"
+#include "wio_cbor.h"
+#include "wio_tls.h"
+
+/********************************************************************************************
+*** Defines
+********************************************************************************************/
+// MQTT control packet types (fixed header)
+#define MQTT_CONNECT 0x10
+#define MQTT_CONNACK 0x20
+#define MQTT_PUBLISH 0x30
+#define MQTT_PUBACK 0x40
+#define MQTT_SUBSCRIBE 0x82
+#define MQTT_SUBACK 0x90
+#define MQTT_UNSUBSCRIBE 0xA2
+#define MQTT_UNSUBACK 0xB0
+#define MQTT_PINGREQ 0xC0
+#define MQTT_PINGRESP 0xD0
+
+// states of the receive parser
+#define RX_HEADER 0 // waiting for the fixed header
+#define RX_LENGTH 1 // decoding the remaining length
+#define RX_BODY 2   // reading the packet into the receive buffer
+#define RX_SKIP 3   // discarding a packet, which is too big for the receive buffer
+#define RX_TOPIC 4  // reading the variable header of a PUBLISH packet, which is too big for the receive buffer
+#define RX_STREAM 5 // passing the payload in chunks to the chunk handler
+
+// states of a slot in the QoS 1 queue
+#define QOS_FREE 0     // slot is not used
+#define QOS_QUEUED 1   // waiting to be sent (window full or not connected)
+#define QOS_INFLIGHT 2 // sent, waiting for the PUBACK
+#define QOS_ACKED 3    // acknowledged, released as soon as all older messages are acknowledged
+
+/********************************************************************************************
+*** Datatypes
+********************************************************************************************/
+// slot of the QoS 1 queue, holds the packet without the fixed header
+typedef struct{
+  uint8_t state;                        // see QOS_xxx
+  uint8_t header;                       // fixed header incl. retain and DUP flag
+  uint16_t packetId;                    // packet identifier
+  uint16_t len;                         // length of the variable header and payload
+  unsigned long sentMillis;             // time of the last transmission
+  uint8_t data[MQTT_QOS1_MESSAGE_SIZE]; // variable header (topic, packet identifier) and payload
+}qos_slot_t;
+
+// slot of the inbox, holds the latest message of one topic until it is dispatched
+typedef struct{
+  bool used;                                 // slot holds a message
+  int16_t topicId;                           // ID of the topic filter
+  uint16_t len;                              // length of the payload
+  unsigned long arrivalMicros;               // arrival of the latest message (latency statistics)
+  char topic[TOPIC_LENGTH];                  // topic of the message
+  char payload[MQTT_INBOX_PAYLOAD_SIZE + 1]; // payload incl. string terminator
+}inbox_slot_t;
 
 /********************************************************************************************
 *** Objects
 ********************************************************************************************/
 WiFiClient wioWiFiClient;
-MqttClient wioMqttClient(wioWiFiClient);
+static wio_tls tlsClient(wioWiFiClient);          // TLS on top of the TCP connection
+static Client *mqttClient = &wioWiFiClient;       // connection used for the MQTT packets (TCP or TLS)
+static WiFiClient probeClient;                    // connection used to measure the latency of other brokers
 typedef void (*cbLog_)(const char *s, bool b);
 static cbLog_ cbMQTTLog;
+static uint8_t txBuffer[MQTT_TX_BUFFER_SIZE + 5]; // 5 bytes reserved for the fixed header
+static uint8_t rxBuffer[MQTT_RX_BUFFER_SIZE + 1]; // 1 byte reserved for the string terminator
+static char msgTopic[TOPIC_LENGTH];               // topic of the current message
+static wio_topic_table topicTable;                // subscribed topics and their handlers
+static wio_dns_cache dnsCache;                    // resolved broker names, refreshed in the background
+static qos_slot_t qosQueue[MQTT_QOS1_QUEUE_LENGTH]; // QoS 1 messages, ring buffer in the order of publishing
+static unsigned int qosHead = 0;                  // oldest slot of the QoS 1 queue
+static mqtt_cache_entry_t valueCache[MQTT_MAX_SUBSCRIPTIONS]; // last value per topic ID
+static inbox_slot_t inbox[MQTT_INBOX_SLOTS];      // latest message per topic, dispatched once per clientLoop()
+static unsigned int inboxCount = 0;               // used slots of the inbox
+
+/********************************************************************************************
+*** Functions
+********************************************************************************************/
+/**
+ * @brief Gleitender Mittelwert für die Messwerte der Broker.
+ *
+ * @param avg Bisheriger Mittelwert, 0: noch kein Messwert
+ * @param value Neuer Messwert
+ * @return uint32_t Neuer Mittelwert (mind. 1, damit er als gemessen gilt)
+ */
+static uint32_t brokerAverage(uint32_t avg, uint32_t value)
+{
+  if (value == 0)
+  {
+    value = 1;
+  }
+  return avg == 0 ? value : avg - avg / 4 + value / 4;
+}
+
+/**
+ * @brief Verwirft den letzten Wert und die noch nicht weitergegebene Nachricht einer freigegebenen Topic ID, bevor
+ * sie von einem anderen Topic wiederverwendet wird.
+ * Wird von der Topic Tabelle bei jeder Freigabe aufgerufen (UNSUBACK, Kündigung vor dem SUBACK, neue Session).
+ *
+ * @param id ID des Topics
+ */
+static void topicReleased(int id)
+{
+  memset(&valueCache[id], 0, sizeof(mqtt_cache_entry_t));
+  for (int i = 0; i < MQTT_INBOX_SLOTS && inboxCount > 0; i++) // drop messages, which are not dispatched yet
+  {
+    if (inbox[i].used && inbox[i].topicId == id)
+    {
+      inbox[i].used = false;
+      inboxCount--;
+    }
+  }
+}
 
 /********************************************************************************************
 *** Constructor
@@ -36,6 +163,7 @@ static cbLog_ cbMQTTLog;
 wio_mqtt::wio_mqtt(void (&func)(const char *, bool b))
 {
   cbMQTTLog = func;
+  topicTable.setReleaseHandler(topicReleased);
   randomSeed(analogRead(0));
 }
 
@@ -43,31 +171,64 @@ wio_mqtt::wio_mqtt(void (&func)(const char *, bool b))
 *** Public Methods
 ********************************************************************************************/
 /**
- * @brief Diese Methode setzt die MQTT-Parameter und stellt eine Verbindung zum MQTT Broker her.
+ * @brief Diese Methode setzt die MQTT-Parameter. Der Verbindungsaufbau wird mit @ref reconnect() angestossen
+ * und mit @ref connectionHandler() durchgeführt.
  *
  * @param func Funktionsadresse der Callback Funktion für die Auswertung der abbonierten Topics
  */
 void wio_mqtt::initMQTT(void (&func)(int))
 {
+  IPAddress brokerIP;
+
   _callback = func;                                    // save Callback function
   (*cbMQTTLog)("Start MQTT Init", false);              // write to the log
-  sprintf(logText, "- Connecting to %s", default_mqtt_broker); // write to the log
+  snprintf(logText, sizeof(logText), "- Connecting to %s", default_mqtt_broker); // write to the log
   (*cbMQTTLog)(logText, false);
 
-  Serial.print("Attempting MQTT connection...");
-  // Create a random wioMqttClient ID
-  String clientId = "WioTerminal"; // generate id
-  clientId += String(random(0xffff), HEX);
-  Serial.print(" - ");
-  Serial.print(clientId);
-  Serial.print(" -...");
-  sprintf(logText, "- ID: %s", clientId.c_str()); // write to the log
+  brokerCount = 0;
+  addBroker(default_mqtt_broker, default_mqtt_port); // preferred broker
+  parseBrokerList(mqtt_fallback_brokers);
+  brokerIndex = 0;
+  if (brokerCount > 1)
+  {
+    sprintf(logText, "- %u fallback brokers", brokerCount - 1); // write to the log
+    (*cbMQTTLog)(logText, false);
+  }
+
+  if (strlen(mqtt_id) > 0 && strlen(mqtt_id) < sizeof(clientId)) // fixed client ID: the broker keeps the session
+  {
+    strcpy(clientId, mqtt_id);
+    cleanSession = false;
+  }
+  else // Create a random client ID
+  {
+    sprintf(clientId, "WioTerminal%lx", random(0xffff)); // generate id
+    cleanSession = true;
+  }
+  Serial.print("MQTT Client ID: ");
+  Serial.println(clientId);
+  sprintf(logText, "- ID: %s", clientId); // write to the log
   (*cbMQTTLog)(logText, false);
 
-  wioMqttClient.setId(clientId);
-  wioMqttClient.setUsernamePassword(mqtt_user, mqtt_password);
-  wioMqttClient.onMessage(_callback);         // set callback function
-  subscribeList(ptr_topicList, topicListLen); // subscribe the topic list
+  useTls = false;
+  mqttClient = &wioWiFiClient;
+  if (mqtt_ca_cert && strlen(mqtt_ca_cert) > 0) // CA certificate given: encrypted connection
+  {
+    if (tlsClient.begin(mqtt_ca_cert, mqtt_tls_server_name))
+    {
+      useTls = true;
+      mqttClient = &tlsClient;
+      (*cbMQTTLog)("- TLS enabled", false);
+      if (brokerIP.fromString(default_mqtt_broker) && (!mqtt_tls_server_name || mqtt_tls_server_name[0] == '\0'))
+      {
+        (*cbMQTTLog)("- TLS: IP broker without server name", true); // set mqtt_tls_server_name in secrets.h
+      }
+    }
+    else
+    {
+      (*cbMQTTLog)("- TLS: invalid CA certificate", true);
+    }
+  }
 }
 
 /**
@@ -76,10 +237,10 @@ void wio_mqtt::initMQTT(void (&func)(int))
  * @param topic Topic (Name) der Nachricht
  * @param payload Payload (Nutzdaten/Inhalt) der Nachricht
  * @param retain Wenn true: Speichert die Nachricht auf dem Broker
+ * @param qos 0: wird einmal gesendet, 1: wird wiederholt bis der Broker sie bestätigt (siehe @ref setInflightWindow())
  */
-void wio_mqtt::publishTopic(const char *topic, char *payload, bool retain)
+void wio_mqtt::publishTopic(const char *topic, char *payload, bool retain, uint8_t qos)
 {
-  pubState = true;           // set publish state to TRUE, because somthing will be sended
   Serial.println("PUBLISH"); // print infos to SerialPort
   Serial.print("Topic: ");
   Serial.println(topic);
@@ -87,9 +248,10 @@ void wio_mqtt::publishTopic(const char *topic, char *payload, bool retain)
   Serial.println(payload);
 
   // publish the message:
-  wioMqttClient.beginMessage(topic, retain);
-  wioMqttClient.print(payload);
-  wioMqttClient.endMessage();
+  if (publishPacket(topic, (const uint8_t *)payload, strlen(payload), retain, qos))
+  {
+    pubState = true; // set publish state to TRUE, because somthing was sended
+  }
 }
 
 /**
@@ -98,12 +260,13 @@ void wio_mqtt::publishTopic(const char *topic, char *payload, bool retain)
  * @param topic Topic (Name) der Nachricht
  * @param payload Payload (Nutzdaten/Inhalt) der Nachricht
  * @param retain Wenn true: Speichert die Nachricht auf dem Broker
+ * @param qos 0: wird einmal gesendet, 1: wird wiederholt bis der Broker sie bestätigt
  */
-void wio_mqtt::publishTopic(const char *topic, const char *payload, bool retain)
+void wio_mqtt::publishTopic(const char *topic, const char *payload, bool retain, uint8_t qos)
 {
   char payloadCopy[strlen(payload) + 1];
   strcpy(payloadCopy, payload);
-  wio_mqtt::publishTopic(topic, payloadCopy, retain);
+  wio_mqtt::publishTopic(topic, payloadCopy, retain, qos);
 }
 
 /**
@@ -112,20 +275,13 @@ void wio_mqtt::publishTopic(const char *topic, const char *payload, bool retain)
  * @param topic Topic (Name) der Nachricht
  * @param payload Payload (Nutzdaten/Inhalt) der Nachricht
  * @param retain Wenn true: Speichert die Nachricht auf dem Broker
+ * @param qos 0: wird einmal gesendet, 1: wird wiederholt bis der Broker sie bestätigt
  */
-void wio_mqtt::publishTopic(const char *topic, int payload, bool retain)
+void wio_mqtt::publishTopic(const char *topic, int payload, bool retain, uint8_t qos)
 {
-  pubState = true;           // set publish state to TRUE, because somthing will be sended
-  Serial.println("PUBLISH"); // print infos to SerialPort
-  Serial.print("Topic: ");
-  Serial.println(topic);
-  Serial.print("Payload: ");
-  Serial.println(payload);
-
-  // publish the message:
-  wioMqttClient.beginMessage(topic, retain);
-  wioMqttClient.print(payload);
-  wioMqttClient.endMessage();
+  char buf[12];
+  sprintf(buf, "%d", payload); // convert payload to a string
+  wio_mqtt::publishTopic(topic, buf, retain, qos);
 }
 
 /**
@@ -134,73 +290,279 @@ void wio_mqtt::publishTopic(const char *topic, int payload, bool retain)
  * @param topic Topic (Name) der Nachricht
  * @param payload Payload (Nutzdaten/Inhalt) der Nachricht
  * @param retain Wenn true: Speichert die Nachricht auf dem Broker
+ * @param qos 0: wird einmal gesendet, 1: wird wiederholt bis der Broker sie bestätigt
  */
-void wio_mqtt::publishTopic(const char *topic, float payload, bool retain)
+void wio_mqtt::publishTopic(const char *topic, float payload, bool retain, uint8_t qos)
 {
-  pubState = true;           // set publish state to TRUE, because somthing will be sended
-  Serial.println("PUBLISH"); // print infos to SerialPort
-  Serial.print("Topic: ");
-  Serial.println(topic);
-  Serial.print("Payload: ");
-  Serial.println(payload);
+  char buf[20];
+  snprintf(buf, sizeof(buf), "%.3f", payload); // convert payload to a string with 3 decimal places
+  wio_mqtt::publishTopic(topic, buf, retain, qos);
+}
 
-  // publish the message:
-  wioMqttClient.beginMessage(topic, retain);
-  wioMqttClient.print(payload, 3);
-  wioMqttClient.endMessage();
+/**
+ * @brief Diese Methode publiziert eine MQTT Nachricht. Binärdaten als Payload, z.B. mit @ref wio_cbor_writer erstellt.
+ *
+ * @param topic Topic (Name) der Nachricht
+ * @param payload Payload (Nutzdaten/Inhalt) der Nachricht
+ * @param len Länge des Payloads in Bytes
+ * @param retain Wenn true: Speichert die Nachricht auf dem Broker
+ * @param qos 0: wird einmal gesendet, 1: wird wiederholt bis der Broker sie bestätigt
+ */
+void wio_mqtt::publishTopic(const char *topic, const uint8_t *payload, unsigned int len, bool retain, uint8_t qos)
+{
+  Serial.print("PUBLISH "); // print infos to SerialPort
+  Serial.print(topic);
+  Serial.print(" (");
+  Serial.print(len);
+  Serial.println(" Bytes)");
+
+  if (publishPacket(topic, payload, len, retain, qos))
+  {
+    pubState = true; // set publish state to TRUE, because somthing was sended
+  }
+}
+
+/**
+ * @brief Diese Methode publiziert einen Messwert mit Zeitstempel und Status als CBOR Array
+ * <tt>[timestamp, value, status]</tt>. Die Nachricht ist je nach Wert 6 - 16 Bytes lang, der Wert wird
+ * ohne Umwandlung in Text übertragen. Der Empfänger liest sie z.B. mit @ref wio_cbor_reader.
+ *
+ * @param topic Topic (Name) der Nachricht
+ * @param timestamp Zeitstempel, z.B. Unix Zeit in Sekunden
+ * @param value Messwert
+ * @param status Status des Messwertes (anwendungsspezifisch)
+ * @param retain Wenn true: Speichert die Nachricht auf dem Broker
+ */
+void wio_mqtt::publishRecord(const char *topic, uint32_t timestamp, float value, int32_t status, bool retain)
+{
+  uint8_t buf[16];
+  wio_cbor_writer cbor(buf, sizeof(buf));
+
+  cbor.beginArray(3);
+  cbor.writeUInt(timestamp);
+  cbor.writeFloat(value);
+  cbor.writeInt(status);
+  publishTopic(topic, cbor.data(), cbor.length(), retain);
+}
+
+/**
+ * @brief Diese Methode beginnt eine Nachricht. Der Payload wird danach mit den print() und write() Methoden
+ * (z.B. über einen @ref wio_json_writer) direkt in den Sendepuffer geschrieben und mit @ref endMessage() gesendet.
+ * Der Payload darf höchstens @ref MQTT_TX_BUFFER_SIZE abzüglich Topic Länge lang sein, mit QoS 1 höchstens
+ * @ref MQTT_QOS1_MESSAGE_SIZE inkl. Topic.
+ * @attention Zwischen beginMessage() und endMessage() dürfen keine anderen Methoden dieser Klasse aufgerufen werden.
+ *
+ * @param topic Topic (Name) der Nachricht
+ * @param retain Wenn true: Speichert die Nachricht auf dem Broker
+ * @param qos 0: wird einmal gesendet, 1: wird in die Warteschlange aufgenommen und wiederholt bis der Broker sie bestätigt
+ * @return true Die Nachricht wurde begonnen
+ * @return false Es besteht keine Verbindung zum Broker (nur QoS 0)
+ */
+bool wio_mqtt::beginMessage(const char *topic, bool retain, uint8_t qos)
+{
+  if (qos == 0 && mqttState != MQTT_STATE_CONNECTED)
+  {
+    msgOpen = false;
+    return false;
+  }
+  txBegin(MQTT_PUBLISH | (qos > 0 ? 0x02 : 0x00) | (retain ? 0x01 : 0x00));
+  txAppendString(topic);
+  if (qos > 0)
+  {
+    txAppendU16(nextPacketId());
+  }
+  msgOpen = true;
+  msgOpenTopic = topic;
+  msgOpenQos = qos;
+  return true;
+}
+
+/**
+ * @brief Diese Methode sendet die mit @ref beginMessage() begonnene Nachricht.
+ *
+ * @return true Die Nachricht wurde gesendet (QoS 1: in die Warteschlange aufgenommen)
+ * @return false Es wurde keine Nachricht begonnen, der Payload war zu lang oder die Verbindung ist unterbrochen
+ */
+bool wio_mqtt::endMessage()
+{
+  if (!msgOpen)
+  {
+    return false;
+  }
+  msgOpen = false;
+  Serial.print("PUBLISH "); // print infos to SerialPort
+  Serial.print(msgOpenTopic);
+  Serial.print(" (");
+  Serial.print(txLen);
+  Serial.println(" Bytes)");
+  if (msgOpenQos > 0)
+  {
+    if (!queuePublish(txHeader, &txBuffer[5], txLen))
+    {
+      return false;
+    }
+    processQueue(); // send immediately if the window allows it
+  }
+  else if (mqttState != MQTT_STATE_CONNECTED || !txSend())
+  {
+    return false;
+  }
+  pubState = true; // set publish state to TRUE, because somthing was sended
+  return true;
+}
+
+/**
+ * @brief Diese Methode hängt ein Byte an den Payload der begonnenen Nachricht an.
+ *
+ * @param b Byte
+ * @return size_t 1: Das Byte wurde angehängt, 0: keine Nachricht begonnen oder Sendepuffer voll
+ */
+size_t wio_mqtt::write(uint8_t b)
+{
+  return write(&b, 1);
+}
+
+/**
+ * @brief Diese Methode hängt Bytes an den Payload der begonnenen Nachricht an.
+ *
+ * @param buf Bytes
+ * @param size Anzahl Bytes
+ * @return size_t Anzahl angehängter Bytes, 0: keine Nachricht begonnen oder Sendepuffer voll
+ */
+size_t wio_mqtt::write(const uint8_t *buf, size_t size)
+{
+  if (!msgOpen || txOverflow)
+  {
+    return 0;
+  }
+  txAppend(buf, size);
+  return txOverflow ? 0 : size;
 }
 
 /**
- * @brief Diese Methode abboniert ein Topic
+ * @brief Diese Methode abboniert ein Topic. Nachrichten werden an die Callback Funktion von @ref initMQTT() weitergeleitet.
  *
  * @param topic Topicname (Name der zu abbonierenden Nachicht)
  */
 void wio_mqtt::subscribeTopic(char *topic)
 {
-  wioMqttClient.subscribe(topic); // subscribe the topic
+  subscribe(topic, NULL);
 }
 
 /**
- * @brief Diese Methode speichert Informationen zu der Subscribe-Liste.
+ * @brief Diese Methode fügt alle Topics der Subscribe-Liste zur Topic Tabelle hinzu.
  *
  * @param list Adresse der Subscribe-Liste
  * @param len Länge der Liste (Anzahl Zeichen --> Anzahl Topics x TOPIC_LENGTH)
  */
 void wio_mqtt::addSubscribeList(char *list, unsigned int len)
 {
-  ptr_topicList = list; // save list address
-  topicListLen = len;   // save list length
+  for (unsigned int i = 0; i < len / TOPIC_LENGTH; i++)
+  {
+    subscribe(list + i * TOPIC_LENGTH, NULL);
+  }
 }
 
 /**
- * @brief Diese Methode abboniert die Subscribe-Liste.
+ * @brief Diese Methode abonniert ein Topic zur Laufzeit. Das Topic bleibt auch nach einem Verbindungsunterbruch
+ * abonniert. Das SUBSCRIBE Paket wird von @ref connectionHandler() gesendet, zusammen mit allen anderen
+ * ausstehenden Topics. Ist das Topic bereits abonniert, wird nur der Handler ersetzt.
  *
- * @param list Adresse der Subscribe-Liste
- * @param len Länge der Subscribe-Liste
+ * @param filter Topic Filter, darf die Wildcards '+' und '#' enthalten
+ * @param handler Handler für die Nachrichten dieses Topics, NULL: Callback Funktion von @ref initMQTT()
+ * @return int ID des Topics oder -1, wenn die Tabelle voll oder das Topic zu lang ist
  */
-void wio_mqtt::subscribeList(char *list, unsigned int len)
+int wio_mqtt::subscribe(const char *filter, mqtt_handler_t handler)
 {
-  Serial.println("+++ Subscribe List +++"); // print topics in list to SerialPort
-  Serial.print(len);
-  Serial.print(" - Liste: ");
-  Serial.println(list);
+  int id = topicTable.add(filter, handler, NULL);
+
+  if (id < 0)
+  {
+    Serial.print("MQTT topic table full or topic too long: ");
+    Serial.println(filter);
+  }
+  return id;
+}
+
+/**
+ * @brief Diese Methode kündigt ein Abonnement zur Laufzeit. Ab sofort werden keine Nachrichten des Topics
+ * mehr weitergeleitet, das UNSUBSCRIBE Paket wird von @ref connectionHandler() gesendet.
+ *
+ * @param filter Topic Filter, wie er bei @ref subscribe() angegeben wurde
+ * @return int ID des Topics oder -1, wenn das Topic nicht abonniert ist
+ */
+int wio_mqtt::unsubscribe(const char *filter)
+{
+  return topicTable.remove(filter);
+}
+
+/**
+ * @brief Diese Methode abonniert ein Topic, dessen Payload in Teilstücken empfangen wird. Der Handler wird
+ * für jedes Teilstück (max. @ref MQTT_RX_BUFFER_SIZE Bytes) mit der Position im Payload und der Gesamtlänge
+ * aufgerufen. Dadurch können auch Nachrichten empfangen werden, welche grösser als der Empfangspuffer sind
+ * (z.B. Konfigurationen oder Bilder), ohne dass sie ganz im RAM gehalten werden.
+ * @note Kleine Nachrichten werden in einem einzigen Teilstück übergeben (Position 0, Länge = Gesamtlänge).
+ * @attention Die Teilstücke sind nicht nullterminiert und nur innerhalb des Handlers gültig.
+ *
+ * @param filter Topic Filter, darf die Wildcards '+' und '#' enthalten
+ * @param handler Handler für die Teilstücke
+ * @return int ID des Topics oder -1, wenn die Tabelle voll oder das Topic zu lang ist
+ */
+int wio_mqtt::subscribeChunked(const char *filter, mqtt_chunk_handler_t handler)
+{
+  int id = topicTable.add(filter, NULL, handler);
+
+  if (id < 0)
+  {
+    Serial.print("MQTT topic table full or topic too long: ");
+    Serial.println(filter);
+  }
+  return id;
+}
+
+/**
+ * @brief Diese Methode legt fest, ob die Nachrichten eines Topics zusammengefasst werden. Zusammengefasst wird
+ * nur die letzte Nachricht pro Topic und clientLoop() Aufruf weitergegeben (geeignet für Zustände und Messwerte).
+ * Ohne Zusammenfassen wird jede Nachricht sofort weitergegeben (nötig für Befehle und Ereignisse).
+ *
+ * @param topicId ID des Topics, siehe @ref subscribe()
+ * @param enable true: zusammenfassen (Standard), false: jede Nachricht einzeln weitergeben
+ * @return true Die Einstellung wurde übernommen
+ * @return false Ungültige ID
+ */
+bool wio_mqtt::setCoalescing(int topicId, bool enable)
+{
+  topic_entry_t *entry = topicTable.get(topicId);
+
+  if (!entry || entry->state == TOPIC_FREE)
+  {
+    return false;
+  }
+  entry->coalesce = enable;
+  return true;
+}
 
-  unsigned int topic_cnt = len / TOPIC_LENGTH; // calc number of topics
-  char topic[TOPIC_LENGTH];
+/**
+ * @brief Diese Methode gibt die Anzahl abonnierter Topics zurück, deren Nachrichten nicht zusammengefasst werden
+ * (Befehle und Ereignisse, siehe @ref setCoalescing()). Solange solche Topics abonniert sind, zählt die Latenz
+ * eingehender Nachrichten, z.B. soll das WLAN dann nicht in den Stromsparmodus wechseln.
+ *
+ * @return unsigned int Anzahl Topics
+ */
+unsigned int wio_mqtt::getCommandTopicCount()
+{
+  unsigned int count = 0;
 
-  for (unsigned int i = 0; i < topic_cnt; i++) // iterate through Subscribe-List
+  for (int i = 0; i < MQTT_MAX_SUBSCRIPTIONS; i++)
   {
-    strcpy(topic, (const char *)list);
-    wioMqttClient.subscribe(topic); // subscribe topic
-    Serial.print("Topic ");         // print topics in list to SerialPort
-    Serial.print(i);
-    Serial.print(": ");
-    Serial.println(topic);
-    for (int ii = 0; ii < TOPIC_LENGTH; ii++) // increment to the next topic
+    topic_entry_t *entry = topicTable.get(i);
+    if (!entry->coalesce && entry->state != TOPIC_FREE && entry->state != TOPIC_UNSUBSCRIBE &&
+        entry->state != TOPIC_UNSUBSCRIBE_SENT)
     {
-      list++;
+      count++;
     }
   }
+  return count;
 }
 
 /**
@@ -211,104 +573,1828 @@ void wio_mqtt::subscribeList(char *list, unsigned int len)
  */
 bool wio_mqtt::isConnected()
 {
-  return wioMqttClient.connected(); // read connection state
+  return mqttState == MQTT_STATE_CONNECTED; // read connection state
 }
 
 /**
- * @brief Diese Methode stellt die Verbindung zum Broker wieder her.
- *
+ * @brief Diese Methode stösst den Verbindungsaufbau zum Broker an. Der Verbindungsaufbau selbst wird
+ * nicht blockierend von @ref connectionHandler() durchgeführt.
+ * @note Läuft bereits ein Verbindungsaufbau oder wird nach einem fehlgeschlagenen Versuch gewartet, hat
+ * der Aufruf keine Wirkung.
  */
 void wio_mqtt::reconnect()
 {
-  // Attempt to connect
-  if (wioMqttClient.connect(default_mqtt_broker, default_mqtt_port))
+  if (mqttState == MQTT_STATE_IDLE && brokerCount > 0)
   {
-    (*cbMQTTLog)("- Connected", false); // write to the log
-    Serial.println("connected");
-    subscribeList(ptr_topicList, topicListLen);    // subscribe the topic list
-    (*cbMQTTLog)("- Subscribed to Topics", false); // write to the log
+    brokersTried = 0;
+    brokerIndex = selectBroker(0);
+    Serial.print("Attempting MQTT connection to ");
+    Serial.print(brokers[brokerIndex].host);
+    Serial.print("...");
+    connectAttempts = 0;
+    stateMillis = millis();
+    connectStartMillis = stateMillis;
+    mqttState = MQTT_STATE_TCP_CONNECT; // start connection setup
   }
-  else
+}
+
+/**
+ * @brief Diese Methode baut die Verbindung zum Broker ab, z.B. wenn die WLAN Verbindung unterbrochen wurde.
+ *
+ */
+void wio_mqtt::disconnect()
+{
+  if (mqttState != MQTT_STATE_IDLE)
   {
-    Serial.print("failed, rc=");
-    Serial.print(wioMqttClient.connectError());
+    mqttClient->stop();
+    mqttState = MQTT_STATE_IDLE;
   }
 }
 
 /**
- * @brief Diese Methode verarbeitet eingehende und ausgehende Nachrichten und frischt die Verbindung auf.
- * Damit die MQTT Funktionen ordentlich funktionieren, muss diese Methode periodisch aufgerufen werden.
+ * @brief Diese Methode schaltet die Verbindungs-Zustandsmaschine um einen Schritt weiter. Jeder Schritt ist
+ * zeitlich begrenzt (max. @ref MQTT_TCP_CONNECT_TIMEOUT für den TCP Verbindungsaufbau), dadurch bleiben
+ * Display und Buttons auch bei einem nicht erreichbaren Broker bedienbar.
+ * Nach einem fehlgeschlagenen Versuch wird exponentiell länger (mit zufälligem Anteil) gewartet.
+ * @note Diese Methode muss bei bestehender WLAN Verbindung in jedem Durchlauf von loop() aufgerufen werden.
  *
  */
-void wio_mqtt::clientLoop()
+void wio_mqtt::connectionHandler()
+{
+  unsigned long currentMillis = millis();
+  mqtt_broker_t *broker = &brokers[brokerIndex];
+  IPAddress brokerIP;
+  bool isAddress;
+  bool resolved;
+  int connected;
+
+  switch (mqttState)
+  {
+  case MQTT_STATE_IDLE:
+    break;
+
+  case MQTT_STATE_TCP_CONNECT:
+    isAddress = brokerIP.fromString(broker->host);
+    resolved = isAddress || dnsCache.resolveCached(broker->host, brokerIP); // never waits for DNS
+    if (!resolved && dnsCache.add(broker->host) < 0)
+    {
+      resolved = dnsCache.resolve(broker->host, brokerIP); // cache full: the only case which waits for DNS
+    }
+    if (!resolved)
+    {
+      Serial.println("failed, name not resolved yet");
+      connectionFailed(); // next broker, the name is resolved while waiting
+      break;
+    }
+    connected = wioWiFiClient.connect(brokerIP, broker->port, MQTT_TCP_CONNECT_TIMEOUT);
+    if (connected)
+    {
+      broker->connectAvgMs = brokerAverage(broker->connectAvgMs, millis() - currentMillis); // TCP handshake ~ 1 round trip
+    }
+    else if (!isAddress)
+    {
+      dnsCache.expire(broker->host); // the address may have changed, resolve again while waiting
+    }
+    if (connected && useTls)
+    {
+      if (tlsClient.startHandshake(isAddress ? NULL : broker->host)) // an IP address is verified against mqtt_tls_server_name
+      {
+        stateMillis = currentMillis;
+        mqttState = MQTT_STATE_TLS_HANDSHAKE;
+      }
+      else
+      {
+        Serial.println("failed, no TLS server name");
+        wioWiFiClient.stop();
+        connectionFailed();
+      }
+    }
+    else if (connected && sendConnect())
+    {
+      rxState = RX_HEADER; // reset receive parser
+      stateMillis = currentMillis;
+      mqttState = MQTT_STATE_WAIT_CONNACK;
+    }
+    else
+    {
+      Serial.println("failed, no TCP connection");
+      connectionFailed();
+    }
+    break;
+
+  case MQTT_STATE_TLS_HANDSHAKE:
+    connected = tlsClient.handshake(); // one step, returns immediately if data from the broker is missing
+    if (connected > 0 && sendConnect())
+    {
+      rxState = RX_HEADER; // reset receive parser
+      stateMillis = millis();
+      mqttState = MQTT_STATE_WAIT_CONNACK;
+    }
+    else if (connected != 0 || currentMillis - stateMillis >= MQTT_TLS_HANDSHAKE_TIMEOUT)
+    {
+      Serial.println("failed, no TLS connection");
+      connectionFailed();
+    }
+    break;
+
+  case MQTT_STATE_WAIT_CONNACK:
+    receive(MQTT_POLL_BUDGET_BYTES, MQTT_POLL_BUDGET_US); // the CONNACK switches to the next state
+    if ((mqttState == MQTT_STATE_WAIT_CONNACK) && (currentMillis - stateMillis >= MQTT_CONNACK_TIMEOUT))
+    {
+      Serial.println("failed, no CONNACK");
+      connectionFailed();
+    }
+    break;
+
+  case MQTT_STATE_SUBSCRIBE:
+    if (syncSubscriptions()) // send the next batch of topics, SUBACKs are read by clientLoop()
+    {
+      connectDuration = currentMillis - connectStartMillis;
+      sprintf(logText, "- Subscribed to Topics (%lu ms)", connectDuration); // write to the log
+      (*cbMQTTLog)(logText, false);
+      connectAttempts = 0;
+      mqttState = MQTT_STATE_CONNECTED;
+    }
+    else if (subackPending > 0 && (currentMillis - subackMillis >= MQTT_SUBACK_TIMEOUT))
+    {
+      Serial.println("failed, no SUBACK");
+      connectionFailed();
+    }
+    break;
+
+  case MQTT_STATE_CONNECTED:
+    if (topicTable.getPendingCount() > 0 || subackPending > 0) // topics subscribed or unsubscribed at runtime
+    {
+      syncSubscriptions();
+      if (subackPending > 0 && (currentMillis - subackMillis >= MQTT_SUBACK_TIMEOUT))
+      {
+        Serial.println("MQTT connection lost, no SUBACK");
+        connectionFailed();
+        break;
+      }
+    }
+    publishValues(); // values held back by the min. interval and heartbeats
+    processQueue();  // QoS 1 messages: fill the window, retransmit after timeout
+    if (brokerCount > 1 && currentMillis - probeMillis >= MQTT_BROKER_PROBE_INTERVAL && !pingOutstanding &&
+        qosStats.queueDepth == 0 && subackPending == 0 && currentMillis - trafficMillis >= MQTT_BROKER_PROBE_QUIET &&
+        getCommandTopicCount() == 0) // a command arriving during the probe would wait up to MQTT_BROKER_PROBE_TIMEOUT
+    {
+      probeBroker(); // blocks up to MQTT_BROKER_PROBE_TIMEOUT, only while nothing is going on; may switch to a better broker
+      break;
+    }
+    if (pingOutstanding)
+    {
+      if (currentMillis - pingMillis >= MQTT_PING_TIMEOUT) // broker doesn't answer
+      {
+        Serial.println("MQTT connection lost, no PINGRESP");
+        connectionFailed();
+      }
+    }
+    else if (currentMillis - pingMillis >= MQTT_KEEP_ALIVE * 1000UL) // fixed cadence: also detects a dead broker while publishing
+    {
+      txBegin(MQTT_PINGREQ);
+      if (txSend())
+      {
+        pingMillis = currentMillis;
+        pingOutstanding = true;
+      }
+    }
+    break;
+
+  case MQTT_STATE_BACKOFF:
+    if (currentMillis - stateMillis < backoffDelay)
+    {
+      dnsCache.handler(backoffDelay - (currentMillis - stateMillis)); // waiting anyway: resolve a name that is due, if its last lookup fits
+    }
+    else
+    {
+      Serial.print("Attempting MQTT connection to ");
+      Serial.print(broker->host);
+      Serial.print("...");
+      connectStartMillis = currentMillis;
+      mqttState = MQTT_STATE_TCP_CONNECT; // try again
+    }
+    break;
+  }
+}
+
+/**
+ * @brief Diese Methode gibt den Zustand der Verbindungs-Zustandsmaschine zurück.
+ *
+ * @return mqtt_state_e Aktueller Zustand, siehe @ref mqtt_state_e
+ */
+mqtt_state_e wio_mqtt::getConnectionState()
 {
-  wioMqttClient.poll();
+  return mqttState;
 }
 
 /**
- * @brief Diese Methode gibt den Publish Status zurück.
+ * @brief Diese Methode verarbeitet eingehende Nachrichten. Pro Aufruf werden höchstens
+ * @ref MQTT_POLL_BUDGET_BYTES Bytes gelesen und höchstens @ref MQTT_POLL_BUDGET_US verarbeitet,
+ * der Rest wird beim nächsten Aufruf abgearbeitet.
+ * Danach werden die zusammengefassten Nachrichten weitergegeben, jedes Topic höchstens einmal.
+ * @note Damit eingehende Nachrichten ohne Verzögerung ausgewertet werden, muss diese Methode in jedem
+ * Durchlauf von loop() aufgerufen werden.
  *
- * @return true Es wurde kürzlich ein Topic publiziert
- * @return false Es wurde nichts publiziert
  */
-bool wio_mqtt::getPublishState()
+void wio_mqtt::clientLoop()
 {
-  return pubState;
+  unsigned long currentMillis = millis();
+
+  if (mqttState == MQTT_STATE_CONNECTED || mqttState == MQTT_STATE_SUBSCRIBE)
+  {
+    if (lastPollMillis != 0 && currentMillis - lastPollMillis > rxStats.pollGapMaxMs)
+    {
+      rxStats.pollGapMaxMs = currentMillis - lastPollMillis; // longest time the socket was not drained
+    }
+    lastPollMillis = currentMillis;
+    if (!receive(MQTT_POLL_BUDGET_BYTES, MQTT_POLL_BUDGET_US))
+    {
+      rxStats.budgetExhausted++;
+    }
+  }
+  else
+  {
+    lastPollMillis = 0;
+  }
+  dispatchInbox(); // once per topic and call
 }
 
 /**
- * @brief Diese Methode gibt den Subscribe Status zurück.
+ * @brief Diese Methode gibt die Statistik über die empfangenen Nachrichten zurück.
+ * Die Latenz wird vom Lesen des ersten Bytes eines Paketes bis zum Aufruf der Callback Funktion gemessen.
  *
- * @return true Es wurde kürzlich ein Topic empfangen
- * @return false Es wurde kein abboniertes Topicaktualisiert
+ * @return const mqtt_rx_stats_t* Zeiger auf die Statistik
  */
-bool wio_mqtt::getSubscribeState()
+const mqtt_rx_stats_t *wio_mqtt::getRxStatistics()
 {
-  return subState;
+  return &rxStats;
 }
 
 /**
- * @brief Diese Methode liesst einen empfangenen Topic zurück
+ * @brief Diese Methode gibt die Zähler der gesendeten und empfangenen Pakete und die Umlaufzeit des letzten
+ * Keep Alive zurück. PINGREQ/PINGRESP werden nicht als Pakete gezählt, eine Änderung der Zähler bedeutet also
+ * Verkehr der Anwendung.
  *
- * @return Zeiger auf ein char- Array, welches das Topic enthält
+ * @return const mqtt_traffic_t* Zeiger auf die Zähler
  */
-const char *wio_mqtt::getMessageTopic(void)
+const mqtt_traffic_t *wio_mqtt::getTrafficStatistics()
 {
-  String msgTopicStr = wioMqttClient.messageTopic();
-  char *msgTopicCharArray = new char[msgTopicStr.length() + 1];
-  msgTopicStr.toCharArray(msgTopicCharArray, msgTopicStr.length() + 1);
-  return msgTopicCharArray;
+  return &traffic;
 }
 
 /**
- * @brief Diese Methode liesst die empfangenen Nutzdaten zurück
+ * @brief Diese Methode gibt die Zeit bis zum nächsten PINGREQ zurück. Das Keep Alive wird unabhängig vom
+ * übrigen Verkehr alle @ref MQTT_KEEP_ALIVE Sekunden gesendet.
  *
- * @return Zeiger auf ein char- Array, welches den Payload enthält
+ * @return unsigned long Zeit in ms, 0: nicht verbunden, PINGREQ fällig oder es wird auf das PINGRESP gewartet
  */
-const char *wio_mqtt::getMessagePayload(void)
+unsigned long wio_mqtt::getKeepAliveRemaining()
 {
-  String msgPayloadStr = wioMqttClient.readString();
-  char *msgPayloadCharArray = new char[msgPayloadStr.length() + 1];
-  msgPayloadStr.toCharArray(msgPayloadCharArray, msgPayloadStr.length() + 1);
-  return msgPayloadCharArray;
+  unsigned long idle = millis() - pingMillis;
+
+  if (mqttState != MQTT_STATE_CONNECTED || pingOutstanding || idle >= MQTT_KEEP_ALIVE * 1000UL)
+  {
+    return 0;
+  }
+  return MQTT_KEEP_ALIVE * 1000UL - idle;
 }
 
 /**
- * @brief Diese Methode setzt den Publish Status
+ * @brief Diese Methode gibt die Statistik der TLS Handshakes zurück. Die mittlere Dauer vollständiger und
+ * wiederaufgenommener Handshakes zeigt, wie viel die Wiederaufnahme der TLS Session beim Verbindungsaufbau spart.
  *
- * @param state Wert für den Publish Status
+ * @return const mqtt_tls_stats_t* Zeiger auf die Statistik, NULL: die Verbindung ist nicht verschlüsselt
  */
-void wio_mqtt::setPublishState(bool state)
+const mqtt_tls_stats_t *wio_mqtt::getTlsStatistics()
 {
-  pubState = state;
+  return useTls ? tlsClient.getStatistics() : NULL;
 }
 
 /**
- * @brief Diese Methode setzt den Subscribe Status
+ * @brief Diese Methode gibt einen Eintrag des DNS Caches zurück (Adresse, Alter, Anzahl Abfragen und Fehler).
  *
- * @param state Wert für den Subscribe Status
+ * @param index Index des Eintrages
+ * @return const dns_entry_t* Eintrag, NULL bei ungültigem Index (nur Broker mit Namen haben einen Eintrag)
  */
-void wio_mqtt::setSubscribeState(bool state)
+const dns_entry_t *wio_mqtt::getDnsEntry(int index)
 {
-  subState = state;
-}
\ No newline at end of file
+  return dnsCache.get(index);
+}
+
+/**
+ * @brief Diese Methode fügt einen Broker am Ende der Broker-Liste hinzu. Der Broker aus secrets.h und die
+ * Broker aus @p mqtt_fallback_brokers werden von @ref initMQTT() eingetragen.
+ *
+ * @param host Adresse des Brokers (IP oder Name)
+ * @param port Port des Brokers
+ * @return int Index des Brokers, -1: Liste voll oder Adresse ungültig
+ */
+int wio_mqtt::addBroker(const char *host, uint16_t port)
+{
+  if (brokerCount >= MQTT_MAX_BROKERS || host[0] == '\0' || strlen(host) >= MQTT_BROKER_HOST_LENGTH)
+  {
+    return -1;
+  }
+  mqtt_broker_t *broker = &brokers[brokerCount];
+  memset(broker, 0, sizeof(mqtt_broker_t));
+  strcpy(broker->host, host);
+  broker->port = port;
+  dnsCache.add(host); // names are resolved while waiting between connection attempts, IP addresses are not cached
+  return brokerCount++;
+}
+
+/**
+ * @brief Diese Methode gibt die Anzahl Broker in der Broker-Liste zurück.
+ *
+ * @return unsigned int Anzahl Broker
+ */
+unsigned int wio_mqtt::getBrokerCount()
+{
+  return brokerCount;
+}
+
+/**
+ * @brief Diese Methode gibt den Index des Brokers der aktuellen Verbindung (bzw. des aktuellen Versuches) zurück.
+ *
+ * @return int Index in der Broker-Liste
+ */
+int wio_mqtt::getBrokerIndex()
+{
+  return brokerIndex;
+}
+
+/**
+ * @brief Diese Methode gibt einen Broker mit seinen Messwerten zurück.
+ *
+ * @param index Index in der Broker-Liste
+ * @return const mqtt_broker_t* Zeiger auf den Broker, NULL: ungültiger Index
+ */
+const mqtt_broker_t *wio_mqtt::getBroker(int index)
+{
+  if (index < 0 || index >= (int)brokerCount)
+  {
+    return NULL;
+  }
+  return &brokers[index];
+}
+
+/**
+ * @brief Diese Methode gibt die Dauer des letzten Verbindungsaufbaus zurück. Gemessen wird vom Beginn
+ * des Verbindungsaufbaus bis alle Topics der Subscribe-Liste vom Broker bestätigt sind.
+ *
+ * @return unsigned long Dauer in ms
+ */
+unsigned long wio_mqtt::getConnectDuration()
+{
+  return connectDuration;
+}
+
+/**
+ * @brief Diese Methode gibt die MQTT Client ID zurück. Sie ist nur mit einer festen ID (mqtt_id in secrets.h)
+ * über einen Neustart hinaus gleich.
+ *
+ * @return const char* Client ID, gültig nach @ref initMQTT()
+ */
+const char *wio_mqtt::getClientId()
+{
+  return clientId;
+}
+
+/**
+ * @brief Diese Methode registriert einen Wert für das verwaltete Publizieren. Der Wert wird mit @ref publishValue()
+ * übergeben (z.B. in jedem Durchlauf) und nur publiziert, wenn er das Totband verlassen hat oder der Heartbeat
+ * abgelaufen ist. Zwischen zwei Nachrichten liegt mindestens @p minInterval, ein zurückgehaltener Wert wird
+ * nach Ablauf des Mindestintervalls automatisch nachgesendet.
+ *
+ * @param topic Topic, unter welchem der Wert publiziert wird (muss bis zum Programmende gültig bleiben)
+ * @param mode Art des Totbandes, siehe @ref deadband_e
+ * @param deadband Totband, absolut (z.B. 0.5 °C) oder relativ (z.B. 0.01 für 1 %)
+ * @param minInterval Minimale Zeit zwischen zwei Nachrichten in ms
+ * @param heartbeat Maximale Zeit zwischen zwei Nachrichten in ms, 0: kein Heartbeat
+ * @param retain Wenn true: Speichert die Nachricht auf dem Broker
+ * @param deadbandMin Nur bei @ref DEADBAND_RELATIVE: absolutes Minimum des Totbandes, damit um 0 nicht jede kleine
+ * Änderung publiziert wird. Negativ (Standard): @p deadband wird auch als absolutes Minimum verwendet
+ * @return int ID des Wertes oder -1, wenn bereits @ref MQTT_MAX_PUBLISHED_VALUES Werte registriert sind
+ */
+int wio_mqtt::registerValue(const char *topic, deadband_e mode, float deadband, unsigned long minInterval, unsigned long heartbeat, bool retain, float deadbandMin)
+{
+  if (valueCount >= MQTT_MAX_PUBLISHED_VALUES)
+  {
+    return -1;
+  }
+  mqtt_value_t *v = &values[valueCount];
+  memset(v, 0, sizeof(*v));
+  v->topic = topic;
+  v->mode = mode;
+  v->deadband = deadband;
+  v->deadbandMin = deadbandMin < 0 ? deadband : deadbandMin;
+  v->minInterval = minInterval;
+  v->heartbeat = heartbeat;
+  v->retain = retain;
+  return valueCount++;
+}
+
+/**
+ * @brief Diese Methode übergibt einen verwalteten Wert. Er wird sofort publiziert, wenn er das Totband verlassen hat
+ * und das Mindestintervall abgelaufen ist. Sonst wird er zurückgehalten und gezählt.
+ *
+ * @param id ID des Wertes, siehe @ref registerValue()
+ * @param value Aktueller Wert
+ * @return true Der Wert wurde publiziert
+ * @return false Der Wert wurde zurückgehalten
+ */
+bool wio_mqtt::publishValue(int id, float value)
+{
+  if (id < 0 || id >= (int)valueCount)
+  {
+    return false;
+  }
+  mqtt_value_t *v = &values[id];
+  float limit = v->deadband;
+
+  if (v->mode == DEADBAND_RELATIVE)
+  {
+    limit = v->deadband * fabsf(v->sentValue);
+    if (limit < v->deadbandMin) // around 0 the relative limit collapses
+    {
+      limit = v->deadbandMin;
+    }
+  }
+  v->value = value;
+  v->hasValue = true;
+  if (!v->sentOnce || fabsf(value - v->sentValue) > limit)
+  {
+    v->pending = true; // outside of the deadband
+  }
+
+  if (v->pending && (!v->sentOnce || millis() - v->sentMillis >= v->minInterval))
+  {
+    return sendValue(v, false); // without connection the value stays pending
+  }
+  v->stats.suppressed++; // inside the deadband or held back by the min. interval
+  publishStats.suppressed++;
+  return false;
+}
+
+/**
+ * @brief Diese Methode gibt die Statistik eines verwalteten Wertes oder aller verwalteten Werte zurück.
+ *
+ * @param id ID des Wertes, -1: Summe aller Werte
+ * @return const mqtt_publish_stats_t* Zeiger auf die Statistik, NULL bei einer ungültigen ID
+ */
+const mqtt_publish_stats_t *wio_mqtt::getPublishStatistics(int id)
+{
+  if (id < 0)
+  {
+    return &publishStats;
+  }
+  if (id >= (int)valueCount)
+  {
+    return NULL;
+  }
+  return &values[id].stats;
+}
+
+/**
+ * @brief Diese Methode setzt die Anzahl QoS 1 Nachrichten, welche gleichzeitig ohne PUBACK unterwegs sein dürfen.
+ * Ein grösseres Fenster erhöht den Durchsatz bei hoher Latenz zum Broker, 1 entspricht Stop-and-Wait.
+ *
+ * @param window Grösse des Fensters (1 - @ref MQTT_QOS1_QUEUE_LENGTH)
+ */
+void wio_mqtt::setInflightWindow(uint8_t window)
+{
+  qosWindow = constrain(window, 1, MQTT_QOS1_QUEUE_LENGTH);
+}
+
+/**
+ * @brief Diese Methode gibt die Statistik der QoS 1 Nachrichten zurück. Mit Durchsatz und Anzahl unbestätigter
+ * Nachrichten kann das Fenster (siehe @ref setInflightWindow()) pro Standort eingestellt werden.
+ *
+ * @return const mqtt_qos_stats_t* Zeiger auf die Statistik
+ */
+const mqtt_qos_stats_t *wio_mqtt::getQosStatistics()
+{
+  return &qosStats;
+}
+
+/**
+ * @brief Diese Methode gibt den Publish Status zurück.
+ *
+ * @return true Es wurde kürzlich ein Topic publiziert
+ * @return false Es wurde nichts publiziert
+ */
+bool wio_mqtt::getPublishState()
+{
+  return pubState;
+}
+
+/**
+ * @brief Diese Methode gibt den Subscribe Status zurück.
+ *
+ * @return true Es wurde kürzlich ein Topic empfangen
+ * @return false Es wurde kein abboniertes Topicaktualisiert
+ */
+bool wio_mqtt::getSubscribeState()
+{
+  return subState;
+}
+
+/**
+ * @brief Diese Methode liesst einen empfangenen Topic zurück
+ * @attention Der Zeiger ist nur innerhalb der Callback Funktion gültig.
+ *
+ * @return Zeiger auf ein char- Array, welches das Topic enthält
+ */
+const char *wio_mqtt::getMessageTopic(void)
+{
+  return msgTopic;
+}
+
+/**
+ * @brief Diese Methode liesst die empfangenen Nutzdaten zurück
+ * @attention Der Zeiger ist nur innerhalb der Callback Funktion gültig.
+ *
+ * @return Zeiger auf ein char- Array, welches den Payload enthält
+ */
+const char *wio_mqtt::getMessagePayload(void)
+{
+  return msgPayload;
+}
+
+/**
+ * @brief Diese Methode gibt die ID des Topics zurück, zu welchem die aktuelle Nachricht gehört. Die ID entspricht
+ * dem Rückgabewert von @ref subscribe() bzw. @ref subscribeChunked(). Damit kann ein Handler, der für mehrere
+ * Topics verwendet wird, die Nachricht ohne Stringvergleich zuordnen.
+ * @attention Der Wert ist nur innerhalb der Callback Funktion bzw. des Handlers gültig.
+ *
+ * @return int ID des Topics oder -1, wenn die Nachricht zu keinem Topic Filter passt
+ */
+int wio_mqtt::getMessageTopicId(void)
+{
+  return msgTopicId;
+}
+
+/**
+ * @brief Diese Methode gibt den letzten empfangenen Wert eines Topics zurück. Bei einem Topic Filter mit
+ * Wildcards ist es der Wert der letzten passenden Nachricht.
+ *
+ * @param topicId ID des Topics, siehe @ref subscribe()
+ * @return const mqtt_cache_entry_t* Zeiger auf den Wert, NULL: ungültige ID oder noch kein Wert empfangen
+ */
+const mqtt_cache_entry_t *wio_mqtt::getCachedValue(int topicId)
+{
+  if (topicId < 0 || topicId >= MQTT_MAX_SUBSCRIPTIONS || valueCache[topicId].count == 0)
+  {
+    return NULL;
+  }
+  return &valueCache[topicId];
+}
+
+/**
+ * @brief Diese Methode gibt den letzten empfangenen Wert eines abonnierten Topic Filters zurück.
+ *
+ * @param filter Topic Filter, wie bei @ref subscribe() angegeben
+ * @return const mqtt_cache_entry_t* Zeiger auf den Wert, NULL: nicht abonniert oder noch kein Wert empfangen
+ */
+const mqtt_cache_entry_t *wio_mqtt::getCachedValue(const char *filter)
+{
+  return getCachedValue(topicTable.find(filter));
+}
+
+/**
+ * @brief Diese Methode gibt zurück, ob die Abonnements noch synchronisiert werden. Nach dem Abonnieren sendet
+ * der Broker alle Retained-Werte auf einmal. Erst wenn während @ref MQTT_RETAINED_SETTLE_TIME kein Retained-Wert
+ * mehr eingetroffen ist, gilt die Synchronisation als abgeschlossen. Bis dahin kann das Zeichnen zurückgestellt
+ * werden, damit nur der endgültige Zustand gezeichnet wird.
+ *
+ * @return true Es werden noch Abonnements bestätigt oder Retained-Werte empfangen
+ * @return false Die Synchronisation ist abgeschlossen
+ */
+bool wio_mqtt::isSynchronizing()
+{
+  return mqttState == MQTT_STATE_SUBSCRIBE || subackPending > 0 || millis() - retainedMillis < MQTT_RETAINED_SETTLE_TIME;
+}
+
+/**
+ * @brief Diese Methode setzt den Publish Status
+ *
+ * @param state Wert für den Publish Status
+ */
+void wio_mqtt::setPublishState(bool state)
+{
+  pubState = state;
+}
+
+/**
+ * @brief Diese Methode setzt den Subscribe Status
+ *
+ * @param state Wert für den Subscribe Status
+ */
+void wio_mqtt::setSubscribeState(bool state)
+{
+  subState = state;
+}
+
+/********************************************************************************************
+*** Private Methods
+********************************************************************************************/
+/**
+ * @brief Diese Methode gleicht die Abonnements schrittweise mit dem Broker ab. Pro Aufruf wird ein
+ * UNSUBSCRIBE oder SUBSCRIBE Paket mit so vielen ausstehenden Topics wie möglich ( @ref MQTT_SUBSCRIBE_BATCH_SIZE )
+ * gesendet, Kündigungen zuerst. Es sind höchstens @ref MQTT_SUBSCRIBE_INFLIGHT Pakete ohne Bestätigung unterwegs,
+ * die SUBACKs und UNSUBACKs werden von @ref clientLoop() ausgewertet.
+ *
+ * @return true Alle Topics sind abonniert bzw. gekündigt und vom Broker bestätigt
+ * @return false Es sind noch Topics oder Bestätigungen ausstehend
+ */
+bool wio_mqtt::syncSubscriptions()
+{
+  if (topicTable.getPendingCount() > 0 && subackPending < MQTT_SUBSCRIBE_INFLIGHT)
+  {
+    if (!sendTopicBatch(MQTT_UNSUBSCRIBE, TOPIC_UNSUBSCRIBE))
+    {
+      sendTopicBatch(MQTT_SUBSCRIBE, TOPIC_SUBSCRIBE);
+    }
+  }
+  return topicTable.getPendingCount() == 0 && subackPending == 0;
+}
+
+/**
+ * @brief Diese Methode sendet ein SUBSCRIBE oder UNSUBSCRIBE Paket mit allen Topics im angegebenen Zustand,
+ * welche im Paket Platz haben. Die Topics merken sich die Paket ID für die Auswertung der Bestätigung.
+ *
+ * @param header Pakettyp ( @ref MQTT_SUBSCRIBE oder @ref MQTT_UNSUBSCRIBE )
+ * @param state Zustand der Topics, welche gesendet werden ( @ref TOPIC_SUBSCRIBE oder @ref TOPIC_UNSUBSCRIBE )
+ * @return true Es wurde ein Paket gesendet
+ * @return false Es gibt keine Topics im angegebenen Zustand
+ */
+bool wio_mqtt::sendTopicBatch(uint8_t header, uint8_t state)
+{
+  const uint8_t qos = 0;
+  unsigned int cnt = 0;
+  uint16_t id = 0;
+
+  for (int i = 0; i < MQTT_MAX_SUBSCRIPTIONS; i++)
+  {
+    topic_entry_t *entry = topicTable.get(i);
+    if (entry->state != state)
+    {
+      continue;
+    }
+    if (cnt == 0)
+    {
+      id = nextPacketId();
+      txBegin(header);
+      txAppendU16(id);
+    }
+    if (txLen + 2 + strlen(entry->filter) + 1 > MQTT_SUBSCRIBE_BATCH_SIZE) // packet is full
+    {
+      break;
+    }
+    txAppendString(entry->filter);
+    if (header == MQTT_SUBSCRIBE)
+    {
+      txAppend(&qos, 1);
+    }
+    topicTable.markSent(i, id, cnt);
+    cnt++;
+  }
+  if (cnt == 0)
+  {
+    return false;
+  }
+  if (txSend()) // on failure the topics are sent again after the reconnect
+  {
+    if (subackPending == 0)
+    {
+      subackMillis = millis();
+    }
+    subackId[subackPending++] = id;
+
+    Serial.print(header == MQTT_SUBSCRIBE ? "SUBSCRIBE " : "UNSUBSCRIBE "); // print batch info to SerialPort
+    Serial.print(cnt);
+    Serial.println(" Topics");
+  }
+  return true;
+}
+
+/**
+ * @brief Diese Methode wertet ein SUBACK oder UNSUBACK aus. Das zugehörige Paket wird aus der Liste der
+ * unbestätigten Pakete entfernt. Abonnierte Topics werden aktiv, vom Broker abgelehnte Topics werden ausgegeben,
+ * gekündigte Topics werden aus der Tabelle entfernt.
+ *
+ * @param unsubscribe true: UNSUBACK, false: SUBACK
+ */
+void wio_mqtt::handleSuback(bool unsubscribe)
+{
+  uint16_t id;
+  uint32_t rc;
+
+  if (rxRemaining < 2)
+  {
+    return;
+  }
+  id = ((uint16_t)rxBuffer[0] << 8) | rxBuffer[1];
+  for (unsigned int i = 0; i < subackPending; i++)
+  {
+    if (subackId[i] == id)
+    {
+      for (unsigned int j = i + 1; j < subackPending; j++) // remove packet from the pending list
+      {
+        subackId[j - 1] = subackId[j];
+      }
+      subackPending--;
+      subackMillis = millis();
+      break;
+    }
+  }
+
+  for (int i = 0; i < MQTT_MAX_SUBSCRIPTIONS; i++)
+  {
+    topic_entry_t *entry = topicTable.get(i);
+    if (entry->packetId != id)
+    {
+      continue;
+    }
+    if (unsubscribe && entry->state == TOPIC_UNSUBSCRIBE_SENT)
+    {
+      topicTable.release(i); // clears the value cache and the inbox slot of the ID
+    }
+    else if (!unsubscribe && entry->state == TOPIC_SUBSCRIBE_SENT)
+    {
+      rc = 2 + entry->batchPos; // position recorded at send time, topics removed in the meantime don't shift it
+      if (rc < rxRemaining && rxBuffer[rc] == 0x80) // failure return code
+      {
+        entry->state = TOPIC_REJECTED;
+        Serial.print("Topic rejected by broker: ");
+        Serial.println(entry->filter);
+      }
+      else
+      {
+        entry->state = TOPIC_ACTIVE;
+      }
+    }
+  }
+}
+
+/**
+ * @brief Diese Methode baut die TCP Verbindung ab. Ist ein anderer Broker in dieser Runde noch nicht fehlgeschlagen,
+ * wird ohne Wartezeit auf ihn gewechselt. Sonst wird die Wartezeit bis zum nächsten Verbindungsversuch berechnet.
+ * Die Wartezeit verdoppelt sich mit jeder Runde (max. @ref MQTT_BACKOFF_MAX). Ein zufälliger Anteil
+ * verhindert, dass viele Terminals gleichzeitig den Broker kontaktieren.
+ *
+ */
+void wio_mqtt::connectionFailed()
+{
+  unsigned long delayMax = MQTT_BACKOFF_MIN;
+  int next;
+
+  mqttClient->stop();
+  pingOutstanding = false;
+  brokers[brokerIndex].failures++;
+  brokers[brokerIndex].okStreak = 0;
+  brokersTried |= 1 << brokerIndex;
+  next = selectBroker(brokersTried);
+  if (next >= 0) // fail over to the next broker without waiting
+  {
+    brokerIndex = next;
+    backoffDelay = 0;
+    stateMillis = millis();
+    mqttState = MQTT_STATE_BACKOFF;
+    Serial.print("MQTT failover to ");
+    Serial.println(brokers[brokerIndex].host);
+    return;
+  }
+
+  brokersTried = 0; // all brokers failed: wait, then start a new round with the best broker
+  brokerIndex = selectBroker(0);
+  for (unsigned int i = 0; (i < connectAttempts) && (delayMax < MQTT_BACKOFF_MAX); i++)
+  {
+    delayMax *= 2; // exponential backoff
+  }
+  if (delayMax > MQTT_BACKOFF_MAX)
+  {
+    delayMax = MQTT_BACKOFF_MAX;
+  }
+  connectAttempts++;
+  backoffDelay = delayMax / 2 + random(delayMax / 2 + 1); // add jitter
+  stateMillis = millis();
+  mqttState = MQTT_STATE_BACKOFF;
+
+  Serial.print("MQTT retry in ");
+  Serial.print(backoffDelay);
+  Serial.println(" ms");
+}
+
+/**
+ * @brief Diese Methode wählt den Broker mit der besten Bewertung aus.
+ *
+ * @param exclude Bit n: Broker n wird nicht berücksichtigt
+ * @return int Index des Brokers, -1: alle Broker sind ausgeschlossen
+ */
+int wio_mqtt::selectBroker(uint8_t exclude)
+{
+  int best = -1;
+
+  for (unsigned int i = 0; i < brokerCount; i++)
+  {
+    if (exclude & (1 << i))
+    {
+      continue;
+    }
+    if (best < 0 || brokerScore(i) < brokerScore(best))
+    {
+      best = i;
+    }
+  }
+  return best;
+}
+
+/**
+ * @brief Diese Methode bewertet einen Broker. Die Latenz ist der Mittelwert aus TCP Verbindungsaufbau und
+ * Ping-Umlaufzeit (sofern gemessen), dazu kommt ein Zuschlag für die Position in der Liste. Ungemessene
+ * Broker werden nur nach ihrer Position bewertet.
+ *
+ * @param index Index des Brokers
+ * @return uint32_t Bewertung in ms, kleiner ist besser
+ */
+uint32_t wio_mqtt::brokerScore(int index)
+{
+  const mqtt_broker_t *broker = &brokers[index];
+  uint32_t latency = broker->connectAvgMs;
+
+  if (broker->rttAvgMs > 0)
+  {
+    latency = latency > 0 ? (latency + broker->rttAvgMs) / 2 : broker->rttAvgMs;
+  }
+  return latency + index * MQTT_BROKER_ORDER_WEIGHT;
+}
+
+/**
+ * @brief Diese Methode misst die Latenz des nächsten anderen Brokers mit einem TCP Verbindungsaufbau
+ * (max. @ref MQTT_BROKER_PROBE_TIMEOUT). Der Verbindungsaufbau blockiert, die Messung wird deshalb nur aufgerufen,
+ * wenn während @ref MQTT_BROKER_PROBE_QUIET kein Paket gesendet oder empfangen wurde, nichts unbestätigt ist und keine
+ * Befehls-Topics abonniert sind (siehe @ref getCommandTopicCount()). War der Broker @ref MQTT_FAILBACK_PROBES mal
+ * in Folge erreichbar und ist er um mehr als @ref MQTT_BROKER_HYSTERESIS besser als der aktuelle, wird die Verbindung
+ * zu ihm aufgebaut.
+ *
+ */
+void wio_mqtt::probeBroker()
+{
+  IPAddress brokerIP;
+  unsigned long startMillis = millis();
+  int connected;
+
+  probeMillis = startMillis;
+  do // next broker, except the current one
+  {
+    probeIndex = (probeIndex + 1) % brokerCount;
+  } while (probeIndex == brokerIndex);
+  mqtt_broker_t *broker = &brokers[probeIndex];
+
+  connected = 0;
+  if (dnsCache.resolveCached(broker->host, brokerIP)) // never wait for DNS while connected, unknown names are resolved during the next backoff
+  {
+    connected = probeClient.connect(brokerIP, broker->port, MQTT_BROKER_PROBE_TIMEOUT);
+  }
+  probeClient.stop();
+  if (!connected)
+  {
+    broker->okStreak = 0;
+    return;
+  }
+  broker->connectAvgMs = brokerAverage(broker->connectAvgMs, millis() - startMillis);
+  if (broker->okStreak < 255)
+  {
+    broker->okStreak++;
+  }
+
+  if (broker->okStreak >= MQTT_FAILBACK_PROBES && brokerScore(probeIndex) + MQTT_BROKER_HYSTERESIS < brokerScore(brokerIndex))
+  {
+    Serial.print("MQTT fail back to ");
+    Serial.println(broker->host);
+    mqttClient->stop(); // not a failure of the current broker
+    brokerIndex = probeIndex;
+    brokersTried = 0;
+    pingOutstanding = false;
+    stateMillis = millis();
+    connectStartMillis = stateMillis;
+    mqttState = MQTT_STATE_TCP_CONNECT;
+  }
+}
+
+/**
+ * @brief Diese Methode liest die zusätzlichen Broker ein und fügt sie der Broker-Liste hinzu.
+ *
+ * @param list Broker, durch Komma getrennt, z.B. "10.0.0.2:1883,broker.local". Ohne Port gilt 1883.
+ */
+void wio_mqtt::parseBrokerList(const char *list)
+{
+  char entry[MQTT_BROKER_HOST_LENGTH + 7]; // host, ':' and port
+
+  while (list && *list)
+  {
+    while (*list == ' ')
+    {
+      list++;
+    }
+    const char *end = strchr(list, ',');
+    unsigned int len = end ? (unsigned int)(end - list) : strlen(list);
+    if (len > 0 && len < sizeof(entry))
+    {
+      uint16_t port = 1883;
+      memcpy(entry, list, len);
+      entry[len] = '\0';
+      char *colon = strrchr(entry, ':');
+      if (colon)
+      {
+        *colon = '\0';
+        port = atoi(colon + 1);
+      }
+      if (addBroker(entry, port) < 0)
+      {
+        Serial.print("Invalid MQTT broker: ");
+        Serial.println(entry);
+      }
+    }
+    list = end ? end + 1 : list + len;
+  }
+}
+
+/**
+ * @brief Diese Methode verarbeitet die empfangenen Bytes, bis keine Bytes mehr vorhanden sind oder
+ * das Budget aufgebraucht ist. Vollständige Pakete werden mit @ref handlePacket() ausgewertet.
+ *
+ * @param maxBytes Maximale Anzahl Bytes, welche gelesen werden
+ * @param maxMicros Maximale Dauer in us
+ * @return true Alle vorhandenen Bytes wurden verarbeitet
+ * @return false Das Budget wurde aufgebraucht, es sind noch Bytes vorhanden
+ */
+bool wio_mqtt::receive(unsigned int maxBytes, unsigned long maxMicros)
+{
+  unsigned long startMicros = micros();
+  int avail = mqttClient->available();
+  bool capped = false;
+
+  if (avail > (int)maxBytes)
+  {
+    avail = maxBytes; // the rest is read with the next call
+    capped = true;
+  }
+  while (avail > 0 && (mqttState != MQTT_STATE_BACKOFF) && !rxPaused)
+  {
+    if (micros() - startMicros >= maxMicros)
+    {
+      return false;
+    }
+
+    if (rxState == RX_BODY || rxState == RX_SKIP || rxState == RX_STREAM)
+    {
+      uint32_t chunk = rxRemaining - rxPos;
+      if (chunk > (uint32_t)avail)
+      {
+        chunk = avail;
+      }
+      if (rxState == RX_BODY)
+      {
+        mqttClient->read(&rxBuffer[rxPos], chunk); // read packet into the receive buffer
+      }
+      else
+      {
+        if (chunk > MQTT_RX_BUFFER_SIZE)
+        {
+          chunk = MQTT_RX_BUFFER_SIZE;
+        }
+        mqttClient->read(rxBuffer, chunk); // discard packet or read the next chunk
+        if (rxState == RX_STREAM)
+        {
+          streamHandler(msgTopic, rxBuffer, chunk, streamOffset, streamTotal);
+          streamOffset += chunk;
+        }
+      }
+      rxPos += chunk;
+      avail -= chunk;
+      if (rxPos >= rxRemaining)
+      {
+        if (rxState == RX_BODY)
+        {
+          handlePacket();
+        }
+        rxState = RX_HEADER;
+      }
+      continue;
+    }
+
+    if (rxState == RX_TOPIC)
+    {
+      uint32_t need = 2; // topic length first, then topic and packet identifier
+      if (rxPos >= 2)
+      {
+        need += (((uint32_t)rxBuffer[0] << 8) | rxBuffer[1]) + (((rxHeader >> 1) & 0x03) ? 2 : 0);
+      }
+      if (need > TOPIC_LENGTH + 4)
+      {
+        Serial.println("MQTT topic too long, discarded");
+        rxState = RX_SKIP;
+        continue;
+      }
+      uint32_t chunk = need - rxPos;
+      if (chunk > (uint32_t)avail)
+      {
+        chunk = avail;
+      }
+      mqttClient->read(&rxBuffer[rxPos], chunk);
+      rxPos += chunk;
+      avail -= chunk;
+      if (rxPos == need && need > 2)
+      {
+        startStream();
+      }
+      continue;
+    }
+
+    int b = mqttClient->read();
+    avail--;
+    if (b < 0)
+    {
+      break;
+    }
+    if (rxState == RX_HEADER)
+    {
+      rxStartMicros = micros(); // packet arrival
+      if ((b & 0xF0) != MQTT_PINGRESP)
+      {
+        traffic.rxPackets++; // keep alive is not traffic
+        trafficMillis = millis();
+      }
+      rxHeader = b;
+      rxRemaining = 0;
+      rxMultiplier = 1;
+      rxState = RX_LENGTH;
+    }
+    else // RX_LENGTH
+    {
+      rxRemaining += (b & 0x7F) * rxMultiplier;
+      rxMultiplier *= 128;
+      if (b & 0x80)
+      {
+        if (rxMultiplier > 128UL * 128 * 128) // remaining length has max. 4 bytes
+        {
+          Serial.println("MQTT protocol error");
+          connectionFailed();
+        }
+        continue;
+      }
+      rxPos = 0;
+      if (rxRemaining == 0)
+      {
+        handlePacket();
+        rxState = RX_HEADER;
+      }
+      else if (rxRemaining <= MQTT_RX_BUFFER_SIZE)
+      {
+        rxState = RX_BODY;
+      }
+      else if ((rxHeader & 0xF0) == MQTT_PUBLISH) // can be streamed, if the topic has a chunk handler
+      {
+        rxState = RX_TOPIC;
+      }
+      else
+      {
+        Serial.println("MQTT packet too big, discarded");
+        rxState = RX_SKIP;
+      }
+    }
+  }
+  return !capped || (mqttState == MQTT_STATE_BACKOFF);
+}
+
+/**
+ * @brief Diese Methode wertet ein vollständig empfangenes Paket aus dem Empfangspuffer aus.
+ * Bei einer PUBLISH Nachricht wird die Callback Funktion aufgerufen.
+ *
+ */
+void wio_mqtt::handlePacket()
+{
+  switch (rxHeader & 0xF0)
+  {
+  case MQTT_CONNACK:
+    if (mqttState == MQTT_STATE_WAIT_CONNACK)
+    {
+      if (rxRemaining >= 2 && rxBuffer[1] == 0) // return code 0: connection accepted
+      {
+        (*cbMQTTLog)("- Connected", false); // write to the log
+        Serial.println("connected");
+        topicTable.restartSession(!cleanSession && (rxBuffer[0] & 0x01)); // session present: subscriptions are still active
+        subackPending = 0;
+        pingOutstanding = false;
+        pingMillis = millis(); // first PINGREQ one keep alive interval after the connect
+        requeueInflight(); // unacknowledged QoS 1 messages are sent again with the DUP flag
+        brokers[brokerIndex].connects++;
+        brokersTried = 0;
+        probeMillis = millis();
+        mqttState = MQTT_STATE_SUBSCRIBE;
+      }
+      else
+      {
+        Serial.print("failed, rc=");
+        Serial.println(rxRemaining >= 2 ? rxBuffer[1] : -1);
+        connectionFailed();
+      }
+    }
+    break;
+
+  case MQTT_PUBLISH:
+  {
+    uint32_t pos = publishHeader();
+    if (pos == 0)
+    {
+      break;
+    }
+    rxBuffer[rxRemaining] = '\0'; // terminate payload
+    msgPayload = (const char *)&rxBuffer[pos];
+    msgTopicId = topicTable.match(msgTopic);
+    topic_entry_t *entry = topicTable.get(msgTopicId);
+    cacheMessage(rxRemaining - pos); // before the handler, so it can already read the cache
+    if (entry && entry->chunkHandler)
+    {
+      countMessage(rxStartMicros);
+      subState = true;
+      entry->chunkHandler(msgTopic, &rxBuffer[pos], rxRemaining - pos, 0, rxRemaining - pos); // one single chunk
+    }
+    else if ((!entry || entry->coalesce) && queueInbound(pos))
+    {
+      // dispatched by dispatchInbox(), a newer message of the same topic replaces this one
+    }
+    else
+    {
+      dispatchMessage(rxRemaining - pos, rxStartMicros);
+    }
+  }
+  break;
+
+  case MQTT_PUBACK:
+    handlePuback();
+    break;
+
+  case MQTT_SUBACK:
+    handleSuback(false);
+    break;
+
+  case MQTT_UNSUBACK:
+    handleSuback(true);
+    break;
+
+  case MQTT_PINGRESP:
+    if (pingOutstanding)
+    {
+      traffic.rttLastMs = millis() - pingMillis;
+      traffic.pings++;
+      brokers[brokerIndex].rttAvgMs = brokerAverage(brokers[brokerIndex].rttAvgMs, traffic.rttLastMs);
+    }
+    pingOutstanding = false;
+    break;
+
+  default: // other packets are not used
+    break;
+  }
+}
+
+/**
+ * @brief Diese Methode wertet den variablen Header eines PUBLISH Paketes im Empfangspuffer aus. Das Topic wird
+ * nach @ref msgTopic kopiert, bei QoS 1 wird die Nachricht mit einem PUBACK bestätigt.
+ *
+ * @return uint32_t Position des Payloads im Paket, 0: Topic zu lang, die Nachricht wird verworfen
+ */
+uint32_t wio_mqtt::publishHeader()
+{
+  uint8_t qos = (rxHeader >> 1) & 0x03;
+  uint32_t topicLen = ((uint32_t)rxBuffer[0] << 8) | rxBuffer[1];
+  uint32_t pos = 2 + topicLen;
+
+  if (qos > 0)
+  {
+    pos += 2; // packet identifier
+  }
+  if (topicLen >= TOPIC_LENGTH || pos > rxRemaining)
+  {
+    Serial.println("MQTT topic too long, discarded");
+    return 0;
+  }
+  if (qos == 1) // acknowledge the message
+  {
+    txBegin(MQTT_PUBACK);
+    txAppend(&rxBuffer[2 + topicLen], 2);
+    txSend();
+  }
+
+  memcpy(msgTopic, &rxBuffer[2], topicLen);
+  msgTopic[topicLen] = '\0';
+  return pos;
+}
+
+/**
+ * @brief Diese Methode beginnt den Empfang einer Nachricht, welche grösser als der Empfangspuffer ist.
+ * Hat das Topic einen Handler für Teilstücke, wird der Payload in Teilstücken weitergegeben, sonst wird
+ * die Nachricht verworfen.
+ *
+ */
+void wio_mqtt::startStream()
+{
+  uint32_t pos = publishHeader();
+  msgTopicId = pos ? topicTable.match(msgTopic) : -1;
+  topic_entry_t *entry = topicTable.get(msgTopicId);
+
+  if (entry && entry->chunkHandler)
+  {
+    countMessage(rxStartMicros); // latency until the header is parsed, the payload follows chunk by chunk
+    subState = true;
+    streamHandler = entry->chunkHandler;
+    streamOffset = 0;
+    streamTotal = rxRemaining - pos;
+    rxState = RX_STREAM;
+  }
+  else
+  {
+    if (pos)
+    {
+      Serial.println("MQTT packet too big, discarded");
+    }
+    rxState = RX_SKIP;
+  }
+}
+
+/**
+ * @brief Diese Methode zählt eine empfangene Nachricht und aktualisiert die Latenz in der Statistik.
+ *
+ */
+void wio_mqtt::countMessage(unsigned long startMicros)
+{
+  uint32_t latency = micros() - startMicros;
+
+  rxStats.messages++;
+  rxStats.latencyLastUs = latency;
+  rxStats.latencyAvgUs = rxStats.latencyAvgUs - rxStats.latencyAvgUs / 8 + latency / 8; // moving average
+  if (latency > rxStats.latencyMaxUs)
+  {
+    rxStats.latencyMaxUs = latency;
+  }
+}
+
+/**
+ * @brief Diese Methode legt die Nachricht im Empfangspuffer auf den Platz ihres Topics. Liegt dort noch eine
+ * ältere Nachricht, wird sie ersetzt. Sind alle Plätze belegt, wird der Socket bis zur nächsten Weitergabe
+ * nicht mehr gelesen, die weiteren Nachrichten bleiben im TCP Puffer (Backpressure zum Broker).
+ *
+ * @param pos Position des Payloads im Empfangspuffer
+ * @return true Die Nachricht liegt auf einem Platz
+ * @return false Die Nachricht muss sofort weitergegeben werden (zu gross oder alle Plätze belegt)
+ */
+bool wio_mqtt::queueInbound(uint32_t pos)
+{
+  unsigned int len = rxRemaining - pos;
+  inbox_slot_t *slot = NULL;
+
+  if (len > MQTT_INBOX_PAYLOAD_SIZE)
+  {
+    rxStats.inboxBypass++;
+    return false;
+  }
+  for (int i = 0; i < MQTT_INBOX_SLOTS; i++) // same topic already waiting?
+  {
+    if (inbox[i].used && inbox[i].topicId == msgTopicId && strcmp(inbox[i].topic, msgTopic) == 0)
+    {
+      slot = &inbox[i];
+      rxStats.coalesced++;
+      break;
+    }
+  }
+  for (int i = 0; !slot && i < MQTT_INBOX_SLOTS; i++) // free slot
+  {
+    if (!inbox[i].used)
+    {
+      slot = &inbox[i];
+      slot->used = true;
+      strcpy(slot->topic, msgTopic);
+      slot->topicId = msgTopicId;
+      inboxCount++;
+      if (inboxCount > rxStats.inboxMax)
+      {
+        rxStats.inboxMax = inboxCount;
+      }
+    }
+  }
+  if (!slot)
+  {
+    rxStats.inboxFull++;
+    rxPaused = true; // stop draining the socket until the inbox is dispatched
+    return false;
+  }
+  memcpy(slot->payload, msgPayload, len + 1); // incl. terminator
+  slot->len = len;
+  slot->arrivalMicros = rxStartMicros;
+  return true;
+}
+
+/**
+ * @brief Diese Methode gibt die aktuelle Nachricht (@ref msgTopic, @ref msgPayload, @ref msgTopicId) an den
+ * Handler des Topics bzw. an die Callback Funktion weiter.
+ *
+ * @param len Länge des Payloads
+ * @param startMicros Zeitpunkt des Eintreffens (Latenz)
+ */
+void wio_mqtt::dispatchMessage(unsigned int len, unsigned long startMicros)
+{
+  topic_entry_t *entry = topicTable.get(msgTopicId);
+
+  if (entry && entry->handler)
+  {
+    countMessage(startMicros);
+    rxStats.dispatched++;
+    subState = true; // the callback function sets the state itself
+    entry->handler(msgTopic, msgPayload, len);
+  }
+  else if (_callback)
+  {
+    countMessage(startMicros);
+    rxStats.dispatched++;
+    _callback(len);
+  }
+}
+
+/**
+ * @brief Diese Methode gibt die zusammengefassten Nachrichten weiter, jedes Topic einmal mit seiner letzten
+ * Nachricht. Danach wird der Socket wieder gelesen, falls er pausiert war.
+ *
+ */
+void wio_mqtt::dispatchInbox()
+{
+  for (int i = 0; i < MQTT_INBOX_SLOTS && inboxCount > 0; i++)
+  {
+    inbox_slot_t *slot = &inbox[i];
+    if (!slot->used)
+    {
+      continue;
+    }
+    slot->used = false;
+    inboxCount--;
+    strcpy(msgTopic, slot->topic); // read by getMessageTopic() etc.
+    msgTopicId = slot->topicId;
+    msgPayload = slot->payload;
+    dispatchMessage(slot->len, slot->arrivalMicros);
+  }
+  rxPaused = false;
+}
+
+/**
+ * @brief Diese Methode legt die Nachricht im Empfangspuffer als letzten Wert ihres Topics ab.
+ *
+ * @param len Länge des Payloads (steht in @ref msgPayload)
+ */
+void wio_mqtt::cacheMessage(unsigned int len)
+{
+  if (msgTopicId < 0 || msgTopicId >= MQTT_MAX_SUBSCRIPTIONS)
+  {
+    return;
+  }
+  mqtt_cache_entry_t *cached = &valueCache[msgTopicId];
+  unsigned int n = min(len, (unsigned int)MQTT_CACHE_VALUE_LENGTH - 1);
+  memcpy(cached->value, msgPayload, n);
+  cached->value[n] = '\0';
+  cached->len = min(len, 0xFFFFu);
+  cached->retained = rxHeader & 0x01;
+  cached->timestamp = millis();
+  cached->count++;
+  if (cached->retained)
+  {
+    retainedMillis = cached->timestamp;
+  }
+}
+
+/**
+ * @brief Diese Methode publiziert zurückgehaltene Werte, deren Mindestintervall abgelaufen ist, und Werte,
+ * deren Heartbeat abgelaufen ist.
+ *
+ */
+void wio_mqtt::publishValues()
+{
+  unsigned long currentMillis = millis();
+
+  for (unsigned int i = 0; i < valueCount && mqttState == MQTT_STATE_CONNECTED; i++)
+  {
+    mqtt_value_t *v = &values[i];
+    if (!v->hasValue)
+    {
+      continue;
+    }
+    if (v->pending && (!v->sentOnce || currentMillis - v->sentMillis >= v->minInterval))
+    {
+      sendValue(v, false);
+    }
+    else if (v->heartbeat > 0 && v->sentOnce && currentMillis - v->sentMillis >= v->heartbeat)
+    {
+      sendValue(v, true);
+    }
+  }
+}
+
+/**
+ * @brief Diese Methode publiziert einen verwalteten Wert und aktualisiert die Statistik.
+ *
+ * @param v Verwalteter Wert
+ * @param heartbeat Der Wert wird nur wegen dem Heartbeat publiziert
+ * @return true Der Wert wurde publiziert
+ * @return false Es besteht keine Verbindung, der Wert bleibt ausstehend
+ */
+bool wio_mqtt::sendValue(mqtt_value_t *v, bool heartbeat)
+{
+  char buf[20];
+
+  snprintf(buf, sizeof(buf), "%.3f", v->value); // same format as publishTopic(topic, float, retain)
+  if (!sendPublish(v->topic, (const uint8_t *)buf, strlen(buf), v->retain))
+  {
+    return false;
+  }
+  pubState = true;
+  v->sentValue = v->value;
+  v->sentMillis = millis();
+  v->sentOnce = true;
+  v->pending = false;
+  v->stats.sent++;
+  publishStats.sent++;
+  if (heartbeat)
+  {
+    v->stats.heartbeats++;
+    publishStats.heartbeats++;
+  }
+  return true;
+}
+
+/**
+ * @brief Diese Methode sendet das CONNECT Paket mit Client ID, Benutzername und Passwort.
+ *
+ * @return true Das Paket wurde gesendet
+ * @return false Das Paket konnte nicht gesendet werden
+ */
+bool wio_mqtt::sendConnect()
+{
+  uint8_t flags = cleanSession ? 0x02 : 0x00; // clean session flag
+  const uint8_t level = 4;  // protocol level MQTT 3.1.1
+
+  if (strlen(mqtt_user) > 0)
+  {
+    flags |= 0x80; // user name flag
+    if (strlen(mqtt_password) > 0)
+    {
+      flags |= 0x40; // password flag
+    }
+  }
+
+  txBegin(MQTT_CONNECT);
+  txAppendString("MQTT");
+  txAppend(&level, 1);
+  txAppend(&flags, 1);
+  txAppendU16(MQTT_KEEP_ALIVE);
+  txAppendString(clientId);
+  if (flags & 0x80)
+  {
+    txAppendString(mqtt_user);
+  }
+  if (flags & 0x40)
+  {
+    txAppendString(mqtt_password);
+  }
+  return txSend();
+}
+
+/**
+ * @brief Diese Methode sendet ein PUBLISH Paket (QoS 0). Passt der Payload nicht in den Sendepuffer,
+ * wird er direkt nach dem Kopf des Paketes gesendet.
+ *
+ * @param topic Topic der Nachricht
+ * @param payload Payload der Nachricht
+ * @param len Länge des Payloads
+ * @param retain Wenn true: Speichert die Nachricht auf dem Broker
+ * @return true Die Nachricht wurde gesendet
+ * @return false Es besteht keine Verbindung oder die Nachricht konnte nicht gesendet werden
+ */
+bool wio_mqtt::sendPublish(const char *topic, const uint8_t *payload, unsigned int len, bool retain)
+{
+  if (mqttState != MQTT_STATE_CONNECTED)
+  {
+    return false;
+  }
+
+  txBegin(MQTT_PUBLISH | (retain ? 0x01 : 0x00));
+  txAppendString(topic);
+  if (txLen + len <= MQTT_TX_BUFFER_SIZE)
+  {
+    txAppend(payload, len);
+    return txSend();
+  }
+  return txSend(len) && writeRaw(payload, len);
+}
+
+/**
+ * @brief Diese Methode sendet eine Nachricht mit QoS 0 oder nimmt sie mit QoS 1 in die Warteschlange auf.
+ * QoS 2 wird nicht unterstützt und als QoS 1 gesendet.
+ *
+ * @param topic Topic der Nachricht
+ * @param payload Payload der Nachricht
+ * @param len Länge des Payloads
+ * @param retain Wenn true: Speichert die Nachricht auf dem Broker
+ * @param qos Quality of Service
+ * @return true Die Nachricht wurde gesendet bzw. in die Warteschlange aufgenommen
+ * @return false Die Nachricht wurde nicht gesendet bzw. verworfen
+ */
+bool wio_mqtt::publishPacket(const char *topic, const uint8_t *payload, unsigned int len, bool retain, uint8_t qos)
+{
+  if (qos == 0)
+  {
+    return sendPublish(topic, payload, len, retain);
+  }
+
+  txBegin(MQTT_PUBLISH | 0x02 | (retain ? 0x01 : 0x00)); // packet is built in the send buffer and copied into the queue
+  txAppendString(topic);
+  txAppendU16(nextPacketId());
+  txAppend(payload, len);
+  if (!queuePublish(txHeader, &txBuffer[5], txLen))
+  {
+    return false;
+  }
+  processQueue(); // send immediately if the window allows it
+  return true;
+}
+
+/**
+ * @brief Diese Methode nimmt ein PUBLISH Paket in die QoS 1 Warteschlange auf. Ist die Warteschlange voll,
+ * wird die neue Nachricht verworfen, die älteren Nachrichten bleiben in ihrer Reihenfolge erhalten.
+ *
+ * @param header Fixed Header des Paketes
+ * @param data Variabler Header (Topic, Paket ID) und Payload
+ * @param len Anzahl Bytes
+ * @return true Die Nachricht wurde aufgenommen
+ * @return false Die Warteschlange ist voll oder die Nachricht ist zu gross
+ */
+bool wio_mqtt::queuePublish(uint8_t header, const uint8_t *data, unsigned int len)
+{
+  if (txOverflow || len > MQTT_QOS1_MESSAGE_SIZE || qosStats.queueDepth >= MQTT_QOS1_QUEUE_LENGTH)
+  {
+    Serial.println("MQTT QoS 1 message discarded, queue full or message too big");
+    qosStats.dropped++;
+    return false;
+  }
+
+  qos_slot_t *slot = &qosQueue[(qosHead + qosStats.queueDepth) % MQTT_QOS1_QUEUE_LENGTH];
+  uint16_t topicLen = ((uint16_t)data[0] << 8) | data[1];
+  slot->header = header;
+  slot->packetId = ((uint16_t)data[2 + topicLen] << 8) | data[3 + topicLen];
+  slot->len = len;
+  memcpy(slot->data, data, len);
+  slot->state = QOS_QUEUED;
+  qosStats.queueDepth++;
+  qosStats.queued++;
+  return true;
+}
+
+/**
+ * @brief Diese Methode sendet wartende QoS 1 Nachrichten, solange das Fenster nicht voll ist, und wiederholt
+ * Nachrichten, deren PUBACK nach @ref MQTT_QOS1_RETRY_TIMEOUT noch fehlt. Es wird nie auf ein PUBACK gewartet.
+ *
+ */
+void wio_mqtt::processQueue()
+{
+  unsigned long currentMillis = millis();
+
+  if (currentMillis - qosRateMillis >= 1000) // throughput of the last second
+  {
+    qosStats.ackRate = qosStats.acked - qosAckedWindow;
+    qosAckedWindow = qosStats.acked;
+    qosRateMillis = currentMillis;
+  }
+
+  for (unsigned int i = 0; i < qosStats.queueDepth && mqttState == MQTT_STATE_CONNECTED; i++)
+  {
+    qos_slot_t *slot = &qosQueue[(qosHead + i) % MQTT_QOS1_QUEUE_LENGTH];
+    bool retry = slot->state == QOS_INFLIGHT && currentMillis - slot->sentMillis >= MQTT_QOS1_RETRY_TIMEOUT;
+    bool send = slot->state == QOS_QUEUED && qosStats.inflight < qosWindow;
+    if (!retry && !send)
+    {
+      continue;
+    }
+    if (retry)
+    {
+      slot->header |= 0x08; // DUP flag
+    }
+    txBegin(slot->header);
+    txAppend(slot->data, slot->len);
+    if (!txSend())
+    {
+      break; // connection lost, sent again after the reconnect
+    }
+    slot->sentMillis = currentMillis;
+    if (retry) // requeued slots are counted once in requeueInflight(), their DUP flag alone isn't a retry
+    {
+      qosStats.retransmits++;
+    }
+    if (send)
+    {
+      slot->state = QOS_INFLIGHT;
+      qosStats.inflight++;
+      if (qosStats.inflight > qosStats.inflightMax)
+      {
+        qosStats.inflightMax = qosStats.inflight;
+      }
+    }
+  }
+}
+
+/**
+ * @brief Diese Methode wertet ein empfangenes PUBACK aus. Die bestätigte Nachricht wird freigegeben, sobald
+ * alle älteren Nachrichten ebenfalls bestätigt sind.
+ *
+ */
+void wio_mqtt::handlePuback()
+{
+  uint16_t id;
+
+  if (rxRemaining < 2)
+  {
+    return;
+  }
+  id = ((uint16_t)rxBuffer[0] << 8) | rxBuffer[1];
+  for (unsigned int i = 0; i < qosStats.queueDepth; i++)
+  {
+    qos_slot_t *slot = &qosQueue[(qosHead + i) % MQTT_QOS1_QUEUE_LENGTH];
+    if (slot->state == QOS_INFLIGHT && slot->packetId == id)
+    {
+      uint32_t latency = millis() - slot->sentMillis;
+      slot->state = QOS_ACKED;
+      qosStats.inflight--;
+      qosStats.acked++;
+      qosStats.ackLatencyAvgMs = qosStats.ackLatencyAvgMs - qosStats.ackLatencyAvgMs / 8 + latency / 8; // moving average
+      break;
+    }
+  }
+
+  while (qosStats.queueDepth > 0 && qosQueue[qosHead].state == QOS_ACKED) // release acknowledged messages
+  {
+    qosQueue[qosHead].state = QOS_FREE;
+    qosHead = (qosHead + 1) % MQTT_QOS1_QUEUE_LENGTH;
+    qosStats.queueDepth--;
+  }
+}
+
+/**
+ * @brief Diese Methode setzt alle unbestätigten QoS 1 Nachrichten nach einer Wiederverbindung zurück in die
+ * Warteschlange. Sie werden mit gesetztem DUP Flag in der ursprünglichen Reihenfolge erneut gesendet.
+ *
+ */
+void wio_mqtt::requeueInflight()
+{
+  for (unsigned int i = 0; i < qosStats.queueDepth; i++)
+  {
+    qos_slot_t *slot = &qosQueue[(qosHead + i) % MQTT_QOS1_QUEUE_LENGTH];
+    if (slot->state == QOS_INFLIGHT)
+    {
+      slot->header |= 0x08; // DUP flag
+      slot->state = QOS_QUEUED;
+      qosStats.retransmits++; // one retransmit per requeue, sent by processQueue() after the reconnect
+    }
+  }
+  qosStats.inflight = 0;
+}
+
+/**
+ * @brief Diese Methode gibt die nächste Paket ID zurück (1 - 65535).
+ *
+ * @return uint16_t Paket ID
+ */
+uint16_t wio_mqtt::nextPacketId()
+{
+  packetId++;
+  if (packetId == 0)
+  {
+    packetId = 1;
+  }
+  return packetId;
+}
+
+/**
+ * @brief Diese Methode beginnt ein neues Paket im Sendepuffer.
+ *
+ * @param header Fixed Header (Pakettyp und Flags)
+ */
+void wio_mqtt::txBegin(uint8_t header)
+{
+  txHeader = header;
+  txLen = 0;
+  txOverflow = false;
+}
+
+/**
+ * @brief Diese Methode hängt Bytes an das Paket im Sendepuffer an.
+ *
+ * @param data Bytes die angehängt werden
+ * @param len Anzahl Bytes
+ */
+void wio_mqtt::txAppend(const uint8_t *data, unsigned int len)
+{
+  if (txLen + len > MQTT_TX_BUFFER_SIZE)
+  {
+    txOverflow = true;
+    return;
+  }
+  memcpy(&txBuffer[5 + txLen], data, len);
+  txLen += len;
+}
+
+/**
+ * @brief Diese Methode hängt einen 16 Bit Wert (Big Endian) an das Paket im Sendepuffer an.
+ *
+ * @param value Wert der angehängt wird
+ */
+void wio_mqtt::txAppendU16(uint16_t value)
+{
+  uint8_t buf[2] = {(uint8_t)(value >> 8), (uint8_t)(value & 0xFF)};
+  txAppend(buf, 2);
+}
+
+/**
+ * @brief Diese Methode hängt einen MQTT String (Länge und Zeichen) an das Paket im Sendepuffer an.
+ *
+ * @param s String der angehängt wird
+ */
+void wio_mqtt::txAppendString(const char *s)
+{
+  uint16_t len = strlen(s);
+  txAppendU16(len);
+  txAppend((const uint8_t *)s, len);
+}
+
+/**
+ * @brief Diese Methode setzt den Fixed Header vor das Paket im Sendepuffer und sendet es mit einem
+ * einzigen Schreibzugriff.
+ *
+ * @param extraLen Anzahl Bytes, welche nach dem Sendepuffer noch direkt gesendet werden
+ * @return true Das Paket wurde gesendet
+ * @return false Der Sendepuffer ist übergelaufen oder die Verbindung ist unterbrochen
+ */
+bool wio_mqtt::txSend(unsigned int extraLen)
+{
+  uint8_t lenBytes[4];
+  uint8_t lenCnt = 0;
+  uint32_t remaining = txLen + extraLen;
+
+  if (txOverflow)
+  {
+    Serial.println("MQTT packet too big for the send buffer");
+    return false;
+  }
+
+  do // encode remaining length
+  {
+    uint8_t b = remaining % 128;
+    remaining /= 128;
+    if (remaining > 0)
+    {
+      b |= 0x80;
+    }
+    lenBytes[lenCnt++] = b;
+  } while (remaining > 0 && lenCnt < 4);
+
+  uint8_t start = 5 - 1 - lenCnt; // fixed header is placed directly in front of the packet
+  txBuffer[start] = txHeader;
+  memcpy(&txBuffer[start + 1], lenBytes, lenCnt);
+  if (!writeRaw(&txBuffer[start], 1 + lenCnt + txLen))
+  {
+    return false;
+  }
+  if (txHeader != MQTT_PINGREQ)
+  {
+    traffic.txPackets++; // keep alive is not traffic
+    trafficMillis = millis();
+  }
+  return true;
+}
+
+/**
+ * @brief Diese Methode sendet Bytes direkt an den Broker. Schlägt das Senden fehl, wird die Verbindung
+ * als unterbrochen betrachtet.
+ *
+ * @param data Bytes die gesendet werden
+ * @param len Anzahl Bytes
+ * @return true Die Bytes wurden gesendet
+ * @return false Die Verbindung ist unterbrochen
+ */
+bool wio_mqtt::writeRaw(const uint8_t *data, unsigned int len)
+{
+  if (mqttClient->write(data, len) != len)
+  {
+    Serial.println("MQTT connection lost, write failed");
+    connectionFailed();
+    return false;
+  }
+  return true;
+}
@@ -2,7 +2,7 @@
  * @file wio_mqtt.h
  * @author Beat Sturzenegger / Fabian Reifler
  * @brief IoTB MQTT Bibliothek für das WIO Terminal
- * @version 1.3
+ * @version 1.24
  * @date 18.01.2022
  *
  * @copyright Copyright (c) 2023
@@ -11,11 +11,168 @@
 
 #ifndef WIO_MQTT_H
 #define WIO_MQTT_H
+
+#include <Arduino.h>
+#include "wio_dns_cache.h"
+
 /********************************************************************************************
 *** Defines
 ********************************************************************************************/
 #define TOPIC_LENGTH 50 ///< Maximale Länge von einem Topic
 
+#define MQTT_KEEP_ALIVE 60             ///< Keep Alive Intervall in Sekunden
+#define MQTT_TCP_CONNECT_TIMEOUT 1000  ///< Maximale Dauer eines TCP Verbindungsversuches in ms (ein Schritt der Zustandsmaschine)
+#define MQTT_MAX_BROKERS 4             ///< Maximale Anzahl Broker (default_mqtt_broker und mqtt_fallback_brokers)
+#define MQTT_BROKER_HOST_LENGTH 40     ///< Maximale Länge einer Broker Adresse
+#define MQTT_BROKER_PROBE_INTERVAL 60000 ///< Intervall, in dem während einer Verbindung ein anderer Broker gemessen wird, in ms
+#define MQTT_BROKER_PROBE_TIMEOUT 300  ///< Maximale Dauer einer Messung (TCP Verbindungsaufbau) in ms, blockiert: mit abonnierten Befehls-Topics wird nie gemessen (Reaktion < 100 ms)
+#define MQTT_BROKER_PROBE_QUIET 5000   ///< Gemessen wird nur, wenn so lange kein Paket gesendet oder empfangen wurde, in ms (die Messung blockiert)
+#define MQTT_BROKER_ORDER_WEIGHT 10    ///< Zuschlag pro Position in der Broker-Liste in ms (bevorzugt die Reihenfolge bei ähnlicher Latenz)
+#define MQTT_BROKER_HYSTERESIS 20      ///< Ein anderer Broker muss um so viele ms besser sein, damit gewechselt wird
+#define MQTT_FAILBACK_PROBES 3         ///< Anzahl erfolgreicher Messungen in Folge, bevor auf einen besseren Broker gewechselt wird
+#define MQTT_TLS_HANDSHAKE_TIMEOUT 15000 ///< Maximale Dauer des TLS Handshakes in ms (vollständiger Handshake auf dem SAMD51: mehrere Sekunden)
+#define MQTT_TLS_VERIFY_NAME 1         ///< 1: TLS nur mit Prüfung des Servernamens im Zertifikat, 0: ohne Namen nur die Zertifikatskette prüfen (unsicher, Warnung)
+#define MQTT_CONNACK_TIMEOUT 5000      ///< Maximale Wartezeit auf das CONNACK vom Broker in ms
+#define MQTT_PING_TIMEOUT 5000         ///< Maximale Wartezeit auf das PINGRESP vom Broker in ms
+#define MQTT_BACKOFF_MIN 1000          ///< Wartezeit nach dem ersten fehlgeschlagenen Verbindungsversuch in ms
+#define MQTT_BACKOFF_MAX 60000         ///< Maximale Wartezeit zwischen zwei Verbindungsversuchen in ms
+#define MQTT_RX_BUFFER_SIZE 512        ///< Grösse des Empfangspuffers, grössere Pakete werden verworfen oder in Teilstücken weitergegeben
+#define MQTT_TX_BUFFER_SIZE 1024       ///< Grösse des Sendepuffers, grössere Payloads werden direkt gesendet
+#define MQTT_SUBSCRIBE_BATCH_SIZE MQTT_TX_BUFFER_SIZE ///< Maximale Grösse eines SUBSCRIBE/UNSUBSCRIBE Paketes, so viele Topics wie möglich werden in ein Paket gepackt
+#define MQTT_SUBSCRIBE_INFLIGHT 4      ///< Maximale Anzahl SUBSCRIBE/UNSUBSCRIBE Pakete, welche ohne Bestätigung unterwegs sein dürfen
+#define MQTT_SUBACK_TIMEOUT 5000       ///< Maximale Wartezeit auf ein SUBACK/UNSUBACK vom Broker in ms
+#define MQTT_POLL_BUDGET_BYTES 2048    ///< Maximale Anzahl Bytes, welche pro @ref wio_mqtt::clientLoop() Aufruf gelesen werden
+#define MQTT_POLL_BUDGET_US 5000       ///< Maximale Dauer eines @ref wio_mqtt::clientLoop() Aufrufes in us
+#define MQTT_INBOX_SLOTS 8             ///< Anzahl Topics, deren letzte Nachricht bis zur Weitergabe zwischengespeichert wird
+#define MQTT_INBOX_PAYLOAD_SIZE 256    ///< Maximale Grösse eines zwischengespeicherten Payloads, grössere werden sofort weitergegeben
+#define MQTT_MAX_PUBLISHED_VALUES 16   ///< Maximale Anzahl Werte, welche mit @ref wio_mqtt::registerValue() verwaltet werden
+#define MQTT_CACHE_VALUE_LENGTH 20     ///< Maximale Länge eines Wertes im Zwischenspeicher inkl. Terminator, siehe @ref wio_mqtt::getCachedValue()
+#define MQTT_RETAINED_SETTLE_TIME 200  ///< Nach dem letzten Retained-Wert so lange warten, bis die Synchronisation als abgeschlossen gilt, in ms
+#define MQTT_QOS1_QUEUE_LENGTH 8       ///< Anzahl Plätze in der Warteschlange für QoS 1 Nachrichten (gesendet und ungesendet)
+#define MQTT_QOS1_MESSAGE_SIZE 128     ///< Maximale Grösse einer QoS 1 Nachricht (Topic + Payload + 4 Bytes)
+#define MQTT_QOS1_WINDOW_DEFAULT 4     ///< Anzahl QoS 1 Nachrichten, welche ohne PUBACK unterwegs sein dürfen (Standard)
+#define MQTT_QOS1_RETRY_TIMEOUT 5000   ///< Wartezeit auf das PUBACK bis die Nachricht wiederholt wird in ms
+
+/********************************************************************************************
+*** Enumerations
+********************************************************************************************/
+/// Zustände der MQTT Verbindungs-Zustandsmaschine, siehe @ref wio_mqtt::connectionHandler()
+typedef enum{
+  MQTT_STATE_IDLE,          ///< Keine Verbindung, es wurde kein Verbindungsaufbau angestossen
+  MQTT_STATE_TCP_CONNECT,   ///< Die TCP Verbindung zum Broker wird aufgebaut
+  MQTT_STATE_TLS_HANDSHAKE, ///< Der TLS Handshake wird durchgeführt (nur mit CA Zertifikat in secrets.h)
+  MQTT_STATE_WAIT_CONNACK,  ///< CONNECT wurde gesendet, es wird auf das CONNACK gewartet
+  MQTT_STATE_SUBSCRIBE,     ///< Die Topic-Liste wird abonniert
+  MQTT_STATE_CONNECTED,     ///< Verbunden mit dem Broker
+  MQTT_STATE_BACKOFF        ///< Verbindungsversuch fehlgeschlagen, es wird bis zum nächsten Versuch gewartet
+}mqtt_state_e;
+
+/// Art des Totbandes eines verwalteten Wertes, siehe @ref wio_mqtt::registerValue()
+typedef enum{
+  DEADBAND_ABSOLUTE,        ///< Der Wert wird publiziert, wenn er sich um mehr als das Totband verändert hat
+  DEADBAND_RELATIVE         ///< Der Wert wird publiziert, wenn er sich um mehr als Totband x letzter Wert verändert hat (0.01 = 1 %), mindestens um das absolute Minimum
+}deadband_e;
+
+/********************************************************************************************
+*** Datatypes
+********************************************************************************************/
+/// Handler für eingehende Nachrichten eines Topics, siehe @ref wio_mqtt::subscribe()
+typedef void (*mqtt_handler_t)(const char *topic, const char *payload, unsigned int len);
+
+/// Handler für Teilstücke des Payloads eines Topics, siehe @ref wio_mqtt::subscribeChunked()
+typedef void (*mqtt_chunk_handler_t)(const char *topic, const uint8_t *chunk, unsigned int len, uint32_t offset, uint32_t total);
+
+/// Statistik über die empfangenen Nachrichten, siehe @ref wio_mqtt::getRxStatistics()
+typedef struct{
+  uint32_t messages;          ///< Anzahl empfangener Nachrichten
+  uint32_t latencyLastUs;     ///< Zeit vom Eintreffen des Paketes bis zum Aufruf der Callback Funktion (letzte Nachricht) in us
+  uint32_t latencyAvgUs;      ///< Gleitender Mittelwert der Latenz in us
+  uint32_t latencyMaxUs;      ///< Maximale Latenz in us
+  uint32_t pollGapMaxMs;      ///< Maximale Zeit zwischen zwei @ref wio_mqtt::clientLoop() Aufrufen in ms
+  uint32_t budgetExhausted;   ///< Anzahl Aufrufe, bei denen das Zeit- oder Byte-Budget aufgebraucht wurde
+  uint32_t dispatched;        ///< Anzahl an Handler bzw. Callback Funktion weitergegebener Nachrichten
+  uint32_t coalesced;         ///< Anzahl Nachrichten, welche vor der Weitergabe durch eine neuere ersetzt wurden
+  uint32_t inboxFull;         ///< Anzahl Nachrichten, welche sofort weitergegeben wurden, weil alle Plätze belegt waren (Lesen pausiert)
+  uint32_t inboxBypass;       ///< Anzahl Nachrichten, welche für einen Platz zu gross waren und sofort weitergegeben wurden
+  uint16_t inboxMax;          ///< Maximale Anzahl gleichzeitig belegter Plätze
+}mqtt_rx_stats_t;
+
+/// Statistik eines verwalteten Wertes bzw. aller verwalteten Werte, siehe @ref wio_mqtt::getPublishStatistics()
+typedef struct{
+  uint32_t sent;              ///< Anzahl publizierter Werte
+  uint32_t suppressed;        ///< Anzahl Werte, welche nicht publiziert wurden (im Totband oder Mindestintervall)
+  uint32_t heartbeats;        ///< Anzahl publizierter Werte, welche nur wegen dem Heartbeat gesendet wurden
+}mqtt_publish_stats_t;
+
+/// Statistik der QoS 1 Nachrichten, siehe @ref wio_mqtt::getQosStatistics()
+typedef struct{
+  uint32_t queued;            ///< Anzahl QoS 1 Nachrichten, welche in die Warteschlange aufgenommen wurden
+  uint32_t acked;             ///< Anzahl vom Broker bestätigter Nachrichten (PUBACK)
+  uint32_t retransmits;       ///< Anzahl wiederholter Nachrichten (Timeout oder Wiederverbindung)
+  uint32_t dropped;           ///< Anzahl Nachrichten, welche wegen voller Warteschlange oder zu grossem Payload verworfen wurden
+  uint16_t ackRate;           ///< Durchsatz: bestätigte Nachrichten in der letzten Sekunde
+  uint16_t inflight;          ///< Anzahl Nachrichten, welche aktuell auf das PUBACK warten
+  uint16_t inflightMax;       ///< Maximale Anzahl gleichzeitig unbestätigter Nachrichten
+  uint16_t queueDepth;        ///< Anzahl belegter Plätze in der Warteschlange
+  uint32_t ackLatencyAvgMs;   ///< Gleitender Mittelwert der Zeit vom Senden bis zum PUBACK in ms
+}mqtt_qos_stats_t;
+
+/// Verkehr auf der Verbindung zum Broker, siehe @ref wio_mqtt::getTrafficStatistics()
+typedef struct{
+  uint32_t txPackets;         ///< Anzahl gesendeter Pakete ohne PINGREQ
+  uint32_t rxPackets;         ///< Anzahl empfangener Pakete ohne PINGRESP
+  uint32_t pings;             ///< Anzahl beantworteter PINGREQ
+  uint32_t rttLastMs;         ///< Umlaufzeit des letzten PINGREQ/PINGRESP in ms
+}mqtt_traffic_t;
+
+/// Letzter empfangener Wert eines Topics, siehe @ref wio_mqtt::getCachedValue()
+typedef struct{
+  char value[MQTT_CACHE_VALUE_LENGTH]; ///< Payload (nullterminiert, ggf. gekürzt)
+  uint16_t len;               ///< Länge des empfangenen Payloads, >= @ref MQTT_CACHE_VALUE_LENGTH: der Wert ist gekürzt
+  bool retained;              ///< Der Wert wurde vom Broker gespeichert (Retained Message)
+  uint32_t timestamp;         ///< Zeitpunkt des Empfangs (millis())
+  uint32_t count;             ///< Anzahl empfangener Nachrichten
+}mqtt_cache_entry_t;
+
+/// Broker der Broker-Liste mit Messwerten, siehe @ref wio_mqtt::getBroker()
+typedef struct{
+  char host[MQTT_BROKER_HOST_LENGTH]; ///< Adresse (IP oder Name)
+  uint16_t port;              ///< Port
+  uint32_t connectAvgMs;      ///< Gleitender Mittelwert der Dauer des TCP Verbindungsaufbaus in ms, 0: noch nicht gemessen
+  uint32_t rttAvgMs;          ///< Gleitender Mittelwert der PINGREQ/PINGRESP Umlaufzeit in ms, 0: noch nicht gemessen
+  uint32_t connects;          ///< Anzahl erfolgreicher Verbindungen
+  uint32_t failures;          ///< Anzahl fehlgeschlagener oder unterbrochener Verbindungen
+  uint8_t okStreak;           ///< Anzahl erfolgreicher Messungen in Folge
+}mqtt_broker_t;
+
+/// Statistik der TLS Handshakes, siehe @ref wio_mqtt::getTlsStatistics()
+typedef struct{
+  uint32_t full;              ///< Anzahl vollständiger Handshakes (Schlüsselaustausch und Zertifikatsprüfung)
+  uint32_t resumed;           ///< Anzahl Handshakes, bei denen der Broker die gespeicherte TLS Session wiederaufgenommen hat
+  uint32_t failures;          ///< Anzahl fehlgeschlagener Handshakes (z.B. Zertifikat nicht von der CA signiert)
+  uint32_t lastMs;            ///< Dauer des letzten Handshakes in ms
+  uint32_t fullAvgMs;         ///< Gleitender Mittelwert der Dauer vollständiger Handshakes in ms
+  uint32_t resumedAvgMs;      ///< Gleitender Mittelwert der Dauer wiederaufgenommener Handshakes in ms
+}mqtt_tls_stats_t;
+
+/// Verwalteter Wert, siehe @ref wio_mqtt::registerValue()
+typedef struct{
+  const char *topic;          ///< Topic, unter welchem der Wert publiziert wird
+  deadband_e mode;            ///< Art des Totbandes
+  float deadband;             ///< Totband (absolut oder relativ)
+  float deadbandMin;          ///< Absolutes Minimum des relativen Totbandes (um 0 wäre es sonst 0)
+  unsigned long minInterval;  ///< Minimale Zeit zwischen zwei Nachrichten in ms
+  unsigned long heartbeat;    ///< Maximale Zeit zwischen zwei Nachrichten in ms, 0: kein Heartbeat
+  bool retain;                ///< Nachricht auf dem Broker speichern
+  bool hasValue;              ///< Es wurde bereits ein Wert übergeben
+  bool pending;               ///< Der Wert hat das Totband verlassen, das Mindestintervall ist aber noch nicht abgelaufen
+  float value;                ///< Zuletzt übergebener Wert
+  float sentValue;            ///< Zuletzt publizierter Wert
+  unsigned long sentMillis;   ///< Zeitpunkt der letzten Nachricht
+  bool sentOnce;              ///< Der Wert wurde mindestens einmal publiziert
+  mqtt_publish_stats_t stats; ///< Statistik des Wertes
+}mqtt_value_t;
+
 /********************************************************************************************
 *** Extern Variables
 ********************************************************************************************/
@@ -24,41 +181,160 @@ extern const uint16_t default_mqtt_port;   ///< defined in secrets.h
 extern const char *mqtt_user;     ///< defined in secrets.h
 extern const char *mqtt_password; ///< defined in secrets.h
 extern const char *mqtt_id;       ///< defined in secrets.h
+extern const char *mqtt_ca_cert;  ///< defined in secrets.h
+extern const char *mqtt_tls_server_name; ///< defined in secrets.h
+extern const char *mqtt_fallback_brokers; ///< defined in secrets.h
 
 /********************************************************************************************
 *** Interface description
 ********************************************************************************************/
-class wio_mqtt
+class wio_mqtt : public Print
 {
 public:
   wio_mqtt(void (&)(const char *, bool));                                 ///< Konstruktor
   void initMQTT(void (&)(int));                                           ///< MQTT initialisieren
-  void publishTopic(const char *topic, char *payload, bool retain);       ///< Ein Topic publizieren, Payload ist ein String
-  void publishTopic(const char *topic, const char *payload, bool retain); ///< Ein Topic publizieren, Payload ist ein konstanter String
-  void publishTopic(const char *topic, int payload, bool retain);         ///< Ein Topic publizieren, Payload ist ein Integer
-  void publishTopic(const char *topic, float payload, bool retain);       ///< Ein Topic publizieren, Payload ist ein Fliesskommazahl
+  void publishTopic(const char *topic, char *payload, bool retain, uint8_t qos = 0);       ///< Ein Topic publizieren, Payload ist ein String
+  void publishTopic(const char *topic, const char *payload, bool retain, uint8_t qos = 0); ///< Ein Topic publizieren, Payload ist ein konstanter String
+  void publishTopic(const char *topic, int payload, bool retain, uint8_t qos = 0);         ///< Ein Topic publizieren, Payload ist ein Integer
+  void publishTopic(const char *topic, float payload, bool retain, uint8_t qos = 0);       ///< Ein Topic publizieren, Payload ist ein Fliesskommazahl
+  void publishTopic(const char *topic, const uint8_t *payload, unsigned int len, bool retain, uint8_t qos = 0); ///< Ein Topic publizieren, Payload sind Binärdaten (z.B. CBOR)
+  void publishRecord(const char *topic, uint32_t timestamp, float value, int32_t status, bool retain); ///< Einen Messwert mit Zeitstempel und Status als CBOR publizieren
+  bool beginMessage(const char *topic, bool retain = false, uint8_t qos = 0); ///< Eine Nachricht beginnen, der Payload wird mit print()/write() geschrieben
+  bool endMessage(void);                                                  ///< Die mit beginMessage() begonnene Nachricht senden
+  size_t write(uint8_t b) override;                                       ///< Ein Byte an den Payload der Nachricht anhängen
+  size_t write(const uint8_t *buf, size_t size) override;                 ///< Bytes an den Payload der Nachricht anhängen
+  using Print::write;
   void subscribeTopic(char *topic);                                       ///< Ein Topic abonnieren
   void addSubscribeList(char *list, unsigned int len);                    ///< Topic-Liste zur Klasse hinzufügen
+  int subscribe(const char *filter, mqtt_handler_t handler = NULL);       ///< Ein Topic zur Laufzeit abonnieren
+  int unsubscribe(const char *filter);                                    ///< Ein Abonnement zur Laufzeit kündigen
+  int subscribeChunked(const char *filter, mqtt_chunk_handler_t handler); ///< Ein Topic abonnieren, der Payload wird in Teilstücken empfangen
+  bool setCoalescing(int topicId, bool enable);                           ///< Nachrichten eines Topics zusammenfassen (Standard) oder jede einzeln weitergeben
+  unsigned int getCommandTopicCount(void);                                ///< Anzahl abonnierter Topics ohne Zusammenfassung (Befehle)
   bool isConnected(void);                                                 ///< MQTT Verbindung auslesen
-  void reconnect(void);                                                   ///< Wiederverbindung zum MQTT Broker
+  void reconnect(void);                                                   ///< Wiederverbindung zum MQTT Broker anstossen
+  void disconnect(void);                                                  ///< Verbindung zum MQTT Broker abbauen
+  void connectionHandler(void);                                           ///< Verbindungs-Zustandsmaschine um einen Schritt weiterschalten
+  mqtt_state_e getConnectionState(void);                                  ///< Zustand der Verbindungs-Zustandsmaschine auslesen
   void clientLoop(void);                                                  ///< MQTT loop für einen ordnungsgemässer Betrieb
+  const mqtt_rx_stats_t *getRxStatistics(void);                           ///< Statistik über die empfangenen Nachrichten auslesen
+  unsigned long getConnectDuration(void);                                 ///< Dauer des letzten Verbindungsaufbaus auslesen
+  const char *getClientId(void);                                          ///< MQTT Client ID auslesen
+  const mqtt_tls_stats_t *getTlsStatistics(void);                         ///< Statistik der TLS Handshakes auslesen (NULL: ohne TLS)
+  const dns_entry_t *getDnsEntry(int index);                              ///< Eintrag des DNS Caches der Broker Namen auslesen
+  int addBroker(const char *host, uint16_t port);                         ///< Einen Broker am Ende der Broker-Liste hinzufügen
+  unsigned int getBrokerCount(void);                                      ///< Anzahl Broker in der Liste
+  int getBrokerIndex(void);                                               ///< Index des aktuellen Brokers
+  const mqtt_broker_t *getBroker(int index);                              ///< Broker mit Messwerten auslesen
+  int registerValue(const char *topic, deadband_e mode, float deadband, unsigned long minInterval, unsigned long heartbeat, bool retain, float deadbandMin = -1); ///< Einen Wert für das verwaltete Publizieren registrieren
+  bool publishValue(int id, float value);                                 ///< Einen verwalteten Wert übergeben, er wird nur bei Bedarf publiziert
+  const mqtt_publish_stats_t *getPublishStatistics(int id = -1);          ///< Statistik der verwalteten Werte auslesen
+  void setInflightWindow(uint8_t window);                                 ///< Anzahl QoS 1 Nachrichten, welche ohne PUBACK unterwegs sein dürfen
+  const mqtt_qos_stats_t *getQosStatistics(void);                         ///< Statistik der QoS 1 Nachrichten auslesen
+  const mqtt_traffic_t *getTrafficStatistics(void);                       ///< Zähler der gesendeten und empfangenen Pakete auslesen
+  unsigned long getKeepAliveRemaining(void);                              ///< Zeit bis zum nächsten PINGREQ in ms
   bool getPublishState();                                                 ///< Den Publish Status auslesen
   bool getSubscribeState();                                               ///< Den Subscribe Status auslesen
   const char *getMessageTopic(void);                                            ///< Ein abbonierter Topic auslesen
   const char *getMessagePayload(void);                                              ///< Ein Payload eines abbonierten Topics auslesen
+  int getMessageTopicId(void);                                            ///< ID des Topics der aktuellen Nachricht auslesen
+  const mqtt_cache_entry_t *getCachedValue(int topicId);                  ///< Letzten Wert eines Topics auslesen
+  const mqtt_cache_entry_t *getCachedValue(const char *filter);           ///< Letzten Wert eines abonnierten Topic Filters auslesen
+  bool isSynchronizing(void);                                             ///< Abonnements bzw. Retained-Werte werden noch empfangen
   void setPublishState(bool state);                                       ///< Den Publish Status setzen
   void setSubscribeState(bool state);                                     ///< Den Subscribe Status setzen
 private:
-  char *ptr_topicList;                           ///< Pointer zu der Topic Liste
-  unsigned int topicListLen = 0;                 ///< Länge der Topic Liste
   bool pubState = false;                         ///< Publish Status
   bool subState = false;                         ///< Subscribe Status
   typedef void (*callbackFunc)(int messageSize); ///< Functionspointer auf die Callback Funktion
-  callbackFunc _callback;
+  callbackFunc _callback = NULL;
   char logText[50];
   typedef void (*cbLog)(char *s, bool b);
   static cbLog _cbLog;                              ///< Callback Funktionsvariable
-  void subscribeList(char *list, unsigned int len); ///< Eine Topic-Liste abonnieren
+  char clientId[24];                                ///< MQTT Client ID (max. 23 Zeichen)
+  mqtt_state_e mqttState = MQTT_STATE_IDLE;         ///< Zustand der Verbindungs-Zustandsmaschine
+  unsigned long stateMillis = 0;                    ///< Zeitpunkt des letzten Zustandswechsels
+  unsigned long backoffDelay = 0;                   ///< Wartezeit bis zum nächsten Verbindungsversuch
+  unsigned int connectAttempts = 0;                 ///< Anzahl fehlgeschlagener Verbindungsversuche in Folge
+  bool cleanSession = true;                         ///< Der Broker soll keine Session speichern (keine feste Client ID)
+  bool useTls = false;                              ///< Die Verbindung zum Broker ist mit TLS verschlüsselt
+  mqtt_broker_t brokers[MQTT_MAX_BROKERS];          ///< Broker-Liste, Index 0 ist der bevorzugte Broker
+  unsigned int brokerCount = 0;                     ///< Anzahl Broker in der Liste
+  int brokerIndex = 0;                              ///< Broker der aktuellen Verbindung bzw. des aktuellen Versuches
+  uint8_t brokersTried = 0;                         ///< Bit n: Broker n ist in dieser Runde fehlgeschlagen
+  int probeIndex = 0;                               ///< Zuletzt gemessener Broker
+  unsigned long probeMillis = 0;                    ///< Zeitpunkt der letzten Messung
+  unsigned long trafficMillis = 0;                  ///< Zeitpunkt des letzten gesendeten oder empfangenen Paketes ohne Keep Alive
+  uint16_t subackId[MQTT_SUBSCRIBE_INFLIGHT];       ///< Paket IDs der SUBSCRIBE/UNSUBSCRIBE Pakete, auf deren Bestätigung gewartet wird
+  unsigned int subackPending = 0;                   ///< Anzahl SUBSCRIBE/UNSUBSCRIBE Pakete, auf deren Bestätigung gewartet wird
+  unsigned long subackMillis = 0;                   ///< Zeitpunkt des ältesten unbestätigten SUBSCRIBE/UNSUBSCRIBE Paketes
+  unsigned long connectStartMillis = 0;             ///< Beginn des aktuellen Verbindungsaufbaus
+  unsigned long connectDuration = 0;                ///< Dauer des letzten Verbindungsaufbaus (TCP bis alle SUBACK) in ms
+  uint16_t packetId = 0;                            ///< Zuletzt verwendete Paket ID
+  unsigned long pingMillis = 0;                     ///< Zeitpunkt des letzten PINGREQ bzw. des Verbindungsaufbaus
+  bool pingOutstanding = false;                     ///< Es wird auf ein PINGRESP gewartet
+  uint8_t txHeader = 0;                             ///< Fixed Header des Paketes im Sendepuffer
+  unsigned int txLen = 0;                           ///< Anzahl Bytes im Sendepuffer
+  bool txOverflow = false;                          ///< Der Sendepuffer ist übergelaufen
+  bool msgOpen = false;                             ///< Eine Nachricht wurde mit beginMessage() begonnen
+  const char *msgOpenTopic = NULL;                  ///< Topic der begonnenen Nachricht
+  uint8_t msgOpenQos = 0;                           ///< QoS der begonnenen Nachricht
+  uint8_t qosWindow = MQTT_QOS1_WINDOW_DEFAULT;     ///< Anzahl QoS 1 Nachrichten, welche ohne PUBACK unterwegs sein dürfen
+  mqtt_qos_stats_t qosStats = {};                   ///< Statistik der QoS 1 Nachrichten
+  uint32_t qosAckedWindow = 0;                      ///< Anzahl bestätigter Nachrichten zu Beginn der aktuellen Sekunde
+  unsigned long qosRateMillis = 0;                  ///< Beginn der aktuellen Sekunde für den Durchsatz
+  uint8_t rxState = 0;                              ///< Zustand des Empfangsparsers
+  uint8_t rxHeader = 0;                             ///< Fixed Header des empfangenen Paketes
+  uint32_t rxRemaining = 0;                         ///< Remaining Length des empfangenen Paketes
+  uint32_t rxMultiplier = 1;                        ///< Multiplikator für die Dekodierung der Remaining Length
+  uint32_t rxPos = 0;                               ///< Anzahl empfangener Bytes des Paketes
+  unsigned long rxStartMicros = 0;                  ///< Zeitpunkt, an dem das erste Byte des Paketes gelesen wurde
+  unsigned long lastPollMillis = 0;                 ///< Zeitpunkt des letzten clientLoop() Aufrufes
+  mqtt_rx_stats_t rxStats = {};                     ///< Statistik über die empfangenen Nachrichten
+  mqtt_traffic_t traffic = {};                      ///< Zähler der gesendeten und empfangenen Pakete
+  mqtt_value_t values[MQTT_MAX_PUBLISHED_VALUES];   ///< Verwaltete Werte
+  unsigned int valueCount = 0;                      ///< Anzahl verwalteter Werte
+  mqtt_publish_stats_t publishStats = {};           ///< Statistik aller verwalteten Werte
+  const char *msgPayload = "";                      ///< Payload der aktuellen Nachricht
+  int msgTopicId = -1;                              ///< ID des Topics der aktuellen Nachricht, siehe @ref subscribe()
+  unsigned long retainedMillis = 0;                 ///< Zeitpunkt des letzten empfangenen Retained-Wertes
+  bool rxPaused = false;                            ///< Alle Plätze sind belegt, der Socket wird bis zur Weitergabe nicht mehr gelesen
+  mqtt_chunk_handler_t streamHandler = NULL;        ///< Handler der Nachricht, welche in Teilstücken empfangen wird
+  uint32_t streamOffset = 0;                        ///< Position des nächsten Teilstückes im Payload
+  uint32_t streamTotal = 0;                         ///< Gesamtlänge des Payloads
+  bool syncSubscriptions(void);                     ///< Ausstehende Abonnements und Kündigungen schrittweise in Paketen senden
+  bool sendTopicBatch(uint8_t header, uint8_t state); ///< Ein SUBSCRIBE oder UNSUBSCRIBE Paket mit ausstehenden Topics senden
+  void handleSuback(bool unsubscribe);              ///< Ein empfangenes SUBACK oder UNSUBACK auswerten
+  void connectionFailed(void);                      ///< Verbindung abbauen und Wartezeit bis zum nächsten Versuch berechnen
+  int selectBroker(uint8_t exclude);                ///< Besten erreichbaren Broker auswählen
+  uint32_t brokerScore(int index);                  ///< Bewertung eines Brokers (kleiner ist besser)
+  void probeBroker(void);                           ///< Latenz eines anderen Brokers messen und bei Bedarf wechseln
+  void parseBrokerList(const char *list);           ///< Broker-Liste "host:port,host:port" einlesen
+  bool receive(unsigned int maxBytes, unsigned long maxMicros); ///< Empfangene Bytes innerhalb eines Budgets verarbeiten
+  void handlePacket(void);                          ///< Ein vollständig empfangenes Paket auswerten
+  uint32_t publishHeader(void);                     ///< Variablen Header eines PUBLISH Paketes auswerten
+  void startStream(void);                           ///< Empfang einer Nachricht in Teilstücken beginnen
+  void countMessage(unsigned long startMicros);     ///< Empfangene Nachricht in der Statistik zählen
+  bool queueInbound(uint32_t pos);                  ///< Empfangene Nachricht auf den Platz ihres Topics legen
+  void dispatchMessage(unsigned int len, unsigned long startMicros); ///< Aktuelle Nachricht an Handler bzw. Callback Funktion weitergeben
+  void dispatchInbox(void);                         ///< Zusammengefasste Nachrichten weitergeben (einmal pro Topic)
+  void cacheMessage(unsigned int len);              ///< Empfangene Nachricht im Zwischenspeicher ablegen
+  void publishValues(void);                         ///< Fällige verwaltete Werte publizieren (Mindestintervall, Heartbeat)
+  bool sendValue(mqtt_value_t *v, bool heartbeat);  ///< Einen verwalteten Wert publizieren
+  bool sendConnect(void);                           ///< CONNECT Paket senden
+  bool sendPublish(const char *topic, const uint8_t *payload, unsigned int len, bool retain); ///< PUBLISH Paket senden
+  bool publishPacket(const char *topic, const uint8_t *payload, unsigned int len, bool retain, uint8_t qos); ///< Nachricht mit QoS 0 senden oder mit QoS 1 in die Warteschlange aufnehmen
+  bool queuePublish(uint8_t header, const uint8_t *data, unsigned int len); ///< PUBLISH Paket (ohne Fixed Header) in die QoS 1 Warteschlange aufnehmen
+  void processQueue(void);                          ///< QoS 1 Nachrichten senden und nach Timeout wiederholen
+  void handlePuback(void);                          ///< Ein empfangenes PUBACK auswerten
+  void requeueInflight(void);                       ///< Unbestätigte Nachrichten nach einer Wiederverbindung erneut senden
+  uint16_t nextPacketId(void);                      ///< Nächste freie Paket ID
+  void txBegin(uint8_t header);                     ///< Neues Paket im Sendepuffer beginnen
+  void txAppend(const uint8_t *data, unsigned int len); ///< Bytes an den Sendepuffer anhängen
+  void txAppendU16(uint16_t value);                 ///< 16 Bit Wert an den Sendepuffer anhängen
+  void txAppendString(const char *s);               ///< MQTT String (mit Längenangabe) an den Sendepuffer anhängen
+  bool txSend(unsigned int extraLen = 0);           ///< Paket aus dem Sendepuffer senden
+  bool writeRaw(const uint8_t *data, unsigned int len); ///< Bytes direkt an den Broker senden
 };
 
 #endif
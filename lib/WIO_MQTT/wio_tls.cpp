@@ -0,0 +1,532 @@
+/**
+ * @file wio_tls.cpp
+ * @author Fabian Reifler
+ * @brief TLS Verbindung über einen WiFiClient mit mbedtls, CA Pinning und Wiederaufnahme der TLS Session \n
+ * Der Broker wird nur akzeptiert, wenn sein Zertifikat vom hinterlegten CA Zertifikat signiert ist.
+ * Nach einem erfolgreichen Handshake wird die TLS Session (Session ID bzw. Session Ticket) gespeichert und
+ * beim nächsten Verbindungsaufbau angeboten. Akzeptiert der Broker die Wiederaufnahme, entfällt der
+ * Schlüsselaustausch (ECDHE/RSA) und die Prüfung der Zertifikatskette, welche auf dem SAMD51 mehrere
+ * Sekunden dauern. \n
+ * Der Handshake wird schrittweise mit @ref handshake() durchgeführt, die TCP Verbindung wird dabei nie
+ * blockierend gelesen. Die Statistik (@ref getStatistics()) vergleicht die Dauer von vollständigen und
+ * wiederaufgenommenen Handshakes.
+ * @version 1.1
+ * @date 19.10.2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+/********************************************************************************************
+*** Includes
+********************************************************************************************/
+#include "wio_tls.h"
+#include <mbedtls/net_sockets.h>
+
+/********************************************************************************************
+*** Defines
+********************************************************************************************/
+#define TLS_WRITE_RETRIES 100 // max. attempts to write a record, if the TCP connection is busy
+
+/********************************************************************************************
+*** Constructor
+********************************************************************************************/
+/**
+ * @brief Konstruktor
+ *
+ * @param tcp TCP Verbindung, über welche die TLS Records gesendet werden
+ */
+wio_tls::wio_tls(WiFiClient &tcp) : tcp(tcp)
+{
+  mbedtls_ssl_init(&ssl);
+  mbedtls_ssl_config_init(&conf);
+  mbedtls_x509_crt_init(&ca);
+  mbedtls_entropy_init(&entropy);
+  mbedtls_ctr_drbg_init(&drbg);
+  mbedtls_ssl_session_init(&session);
+}
+
+/********************************************************************************************
+*** Public Methods
+********************************************************************************************/
+/**
+ * @brief Diese Methode lädt das CA Zertifikat und konfiguriert TLS. Nur Zertifikate, welche von dieser CA
+ * signiert sind, werden akzeptiert (CA Pinning).
+ *
+ * @param caCert CA Zertifikat im PEM Format
+ * @param serverName Name im Zertifikat des Servers, wird geprüft, wenn der Server über die IP Adresse
+ * angesprochen wird (NULL oder leer: kein Name)
+ * @return true TLS ist konfiguriert
+ * @return false Das Zertifikat ist ungültig oder mbedtls konnte nicht initialisiert werden
+ */
+bool wio_tls::begin(const char *caCert, const char *serverName)
+{
+  const char *pers = "wio_tls";
+  int ret;
+
+  ready = false;
+  this->serverName = (serverName && serverName[0] != '\0') ? serverName : NULL;
+  ret = mbedtls_ctr_drbg_seed(&drbg, mbedtls_entropy_func, &entropy, (const unsigned char *)pers, strlen(pers));
+  if (ret == 0)
+  {
+    ret = mbedtls_x509_crt_parse(&ca, (const unsigned char *)caCert, strlen(caCert) + 1); // PEM incl. terminator
+  }
+  if (ret == 0)
+  {
+    ret = mbedtls_ssl_config_defaults(&conf, MBEDTLS_SSL_IS_CLIENT, MBEDTLS_SSL_TRANSPORT_STREAM, MBEDTLS_SSL_PRESET_DEFAULT);
+  }
+  if (ret != 0)
+  {
+    Serial.print("TLS init failed: -0x");
+    Serial.println(-ret, HEX);
+    return false;
+  }
+  mbedtls_ssl_conf_authmode(&conf, MBEDTLS_SSL_VERIFY_REQUIRED);
+  mbedtls_ssl_conf_ca_chain(&conf, &ca, NULL);
+  mbedtls_ssl_conf_rng(&conf, mbedtls_ctr_drbg_random, &drbg);
+#if defined(MBEDTLS_SSL_SESSION_TICKETS)
+  mbedtls_ssl_conf_session_tickets(&conf, MBEDTLS_SSL_SESSION_TICKETS_ENABLED);
+#endif
+  if (mbedtls_ssl_setup(&ssl, &conf) != 0)
+  {
+    Serial.println("TLS setup failed");
+    return false;
+  }
+  mbedtls_ssl_set_bio(&ssl, &tcp, bioSend, bioRecv, NULL);
+  ready = true;
+  return true;
+}
+
+/**
+ * @brief Diese Methode beginnt den Handshake auf der bestehenden TCP Verbindung. Ist eine TLS Session
+ * gespeichert, wird sie dem Broker zur Wiederaufnahme angeboten.
+ *
+ * @param hostname Name des Brokers für SNI und die Prüfung des Zertifikates, NULL: der Name aus @ref begin()
+ * wird verwendet (z.B. wenn der Broker über die IP Adresse angesprochen wird)
+ * @return true Der Handshake wurde begonnen, weiter mit @ref handshake()
+ * @return false TLS ist nicht konfiguriert oder es ist kein Name für die Prüfung des Zertifikates bekannt
+ * (mit MQTT_TLS_VERIFY_NAME 0 wird nur gewarnt und die Zertifikatskette geprüft)
+ */
+bool wio_tls::startHandshake(const char *hostname)
+{
+  if (!ready)
+  {
+    return false;
+  }
+  if (hostname == NULL || hostname[0] == '\0')
+  {
+    hostname = serverName;
+  }
+  if (hostname == NULL)
+  {
+#if MQTT_TLS_VERIFY_NAME
+    Serial.println("TLS: no server name, certificate can't be verified");
+    return false;
+#else
+    Serial.println("TLS warning: no server name, any certificate of the CA is accepted");
+#endif
+  }
+  established = false;
+  fullHandshake = false;
+  peekByte = -1;
+  mbedtls_ssl_session_reset(&ssl);
+  mbedtls_ssl_set_hostname(&ssl, hostname);
+  if (sessionValid)
+  {
+    mbedtls_ssl_set_session(&ssl, &session); // offer the session for resumption
+  }
+  handshakeMillis = millis();
+  return true;
+}
+
+/**
+ * @brief Diese Methode führt den Handshake um einen Schritt weiter. Fehlen Daten vom Broker, kehrt sie
+ * sofort zurück. Der Schlüsselaustausch ist ein einzelner Schritt und dauert bei einem vollständigen
+ * Handshake entsprechend lange.
+ *
+ * @return int 1: Handshake abgeschlossen, 0: Handshake läuft, -1: Handshake fehlgeschlagen
+ */
+int wio_tls::handshake()
+{
+  int ret;
+
+  if (established)
+  {
+    return 1;
+  }
+  ret = mbedtls_ssl_handshake_step(&ssl);
+  if (ssl.state == MBEDTLS_SSL_CLIENT_KEY_EXCHANGE) // only reached if the broker didn't resume the session
+  {
+    fullHandshake = true;
+  }
+  if (ret == MBEDTLS_ERR_SSL_WANT_READ || ret == MBEDTLS_ERR_SSL_WANT_WRITE)
+  {
+    return 0;
+  }
+  if (ret != 0)
+  {
+    Serial.print("TLS handshake failed: -0x");
+    Serial.print(-ret, HEX);
+    Serial.print(", verify=0x");
+    Serial.println(mbedtls_ssl_get_verify_result(&ssl), HEX);
+    stats.failures++;
+    clearSession(); // next attempt with a full handshake
+    return -1;
+  }
+  if (ssl.state != MBEDTLS_SSL_HANDSHAKE_OVER)
+  {
+    return 0;
+  }
+  handshakeDone();
+  return 1;
+}
+
+/**
+ * @brief Diese Methode verwirft die gespeicherte TLS Session. Der nächste Handshake ist vollständig.
+ *
+ */
+void wio_tls::clearSession()
+{
+  mbedtls_ssl_session_free(&session);
+  mbedtls_ssl_session_init(&session);
+  sessionValid = false;
+}
+
+/**
+ * @brief Diese Methode gibt die Statistik der Handshakes zurück. Damit kann die Dauer eines vollständigen
+ * Handshakes mit der Dauer einer Wiederaufnahme mit dem realen Broker verglichen werden.
+ *
+ * @return const mqtt_tls_stats_t* Zeiger auf die Statistik
+ */
+const mqtt_tls_stats_t *wio_tls::getStatistics()
+{
+  return &stats;
+}
+
+/**
+ * @brief Diese Methode baut die TCP Verbindung auf und führt den Handshake blockierend durch.
+ * @note Für den nicht blockierenden Verbindungsaufbau die TCP Verbindung selbst aufbauen und
+ * @ref startHandshake() und @ref handshake() verwenden.
+ *
+ * @param ip IP Adresse des Servers
+ * @param port Port des Servers
+ * @return int 1: verbunden, 0: fehlgeschlagen
+ */
+int wio_tls::connect(IPAddress ip, uint16_t port)
+{
+  if (!tcp.connect(ip, port) || !startHandshake(NULL))
+  {
+    return 0;
+  }
+  return blockingHandshake();
+}
+
+/**
+ * @brief Diese Methode baut die TCP Verbindung auf und führt den Handshake blockierend durch.
+ *
+ * @param host Name des Servers, wird auch für die Prüfung des Zertifikates verwendet
+ * @param port Port des Servers
+ * @return int 1: verbunden, 0: fehlgeschlagen
+ */
+int wio_tls::connect(const char *host, uint16_t port)
+{
+  if (!tcp.connect(host, port) || !startHandshake(host))
+  {
+    return 0;
+  }
+  return blockingHandshake();
+}
+
+/**
+ * @brief Diese Methode sendet ein Byte verschlüsselt.
+ *
+ * @param b Byte
+ * @return size_t Anzahl gesendeter Bytes
+ */
+size_t wio_tls::write(uint8_t b)
+{
+  return write(&b, 1);
+}
+
+/**
+ * @brief Diese Methode sendet Bytes verschlüsselt. Ist die TCP Verbindung ausgelastet, wird es
+ * mehrmals versucht.
+ *
+ * @param buf Bytes
+ * @param size Anzahl Bytes
+ * @return size_t Anzahl gesendeter Bytes, weniger als @p size: die Verbindung ist unterbrochen
+ */
+size_t wio_tls::write(const uint8_t *buf, size_t size)
+{
+  size_t written = 0;
+  unsigned int retries = 0;
+
+  if (!established)
+  {
+    return 0;
+  }
+  while (written < size)
+  {
+    int ret = mbedtls_ssl_write(&ssl, buf + written, size - written);
+    if (ret > 0)
+    {
+      written += ret;
+    }
+    else if ((ret != MBEDTLS_ERR_SSL_WANT_WRITE && ret != MBEDTLS_ERR_SSL_WANT_READ) || ++retries > TLS_WRITE_RETRIES)
+    {
+      break;
+    }
+  }
+  return written;
+}
+
+/**
+ * @brief Diese Methode gibt die Anzahl entschlüsselter Bytes zurück. Sind keine vorhanden, aber verschlüsselte
+ * Daten eingetroffen, wird der nächste TLS Record entschlüsselt.
+ *
+ * @return int Anzahl Bytes, welche ohne Warten gelesen werden können
+ */
+int wio_tls::available()
+{
+  if (!established)
+  {
+    return 0;
+  }
+  if (peekByte < 0 && mbedtls_ssl_get_bytes_avail(&ssl) == 0)
+  {
+    fillPeek();
+  }
+  return mbedtls_ssl_get_bytes_avail(&ssl) + (peekByte >= 0 ? 1 : 0);
+}
+
+/**
+ * @brief Diese Methode liest ein entschlüsseltes Byte.
+ *
+ * @return int Byte, -1: keine Daten vorhanden
+ */
+int wio_tls::read()
+{
+  uint8_t b;
+
+  return read(&b, 1) == 1 ? b : -1;
+}
+
+/**
+ * @brief Diese Methode liest entschlüsselte Bytes. Es werden nur bereits eingetroffene Daten gelesen.
+ *
+ * @param buf Puffer
+ * @param size Grösse des Puffers
+ * @return int Anzahl gelesener Bytes, -1: keine Daten vorhanden
+ */
+int wio_tls::read(uint8_t *buf, size_t size)
+{
+  size_t n = 0;
+
+  if (size == 0 || available() <= 0)
+  {
+    return -1;
+  }
+  if (peekByte >= 0)
+  {
+    buf[n++] = peekByte;
+    peekByte = -1;
+  }
+  size_t avail = mbedtls_ssl_get_bytes_avail(&ssl);
+  if (n < size && avail > 0)
+  {
+    int ret = mbedtls_ssl_read(&ssl, buf + n, min(size - n, avail)); // decrypted data only, never blocks
+    if (ret > 0)
+    {
+      n += ret;
+    }
+  }
+  return n;
+}
+
+/**
+ * @brief Diese Methode gibt das nächste entschlüsselte Byte zurück, ohne es zu entfernen.
+ *
+ * @return int Byte, -1: keine Daten vorhanden
+ */
+int wio_tls::peek()
+{
+  if (peekByte < 0 && available() > 0)
+  {
+    uint8_t b;
+    if (mbedtls_ssl_read(&ssl, &b, 1) == 1)
+    {
+      peekByte = b;
+    }
+  }
+  return peekByte;
+}
+
+/**
+ * @brief Diese Methode leert den Sendepuffer der TCP Verbindung.
+ *
+ */
+void wio_tls::flush()
+{
+  tcp.flush();
+}
+
+/**
+ * @brief Diese Methode baut die Verbindung ab. Die TLS Session bleibt gespeichert und wird beim nächsten
+ * Verbindungsaufbau zur Wiederaufnahme angeboten.
+ *
+ */
+void wio_tls::stop()
+{
+  if (established && tcp.connected())
+  {
+    mbedtls_ssl_close_notify(&ssl);
+  }
+  established = false;
+  peekByte = -1;
+  tcp.stop();
+}
+
+/**
+ * @brief Diese Methode gibt zurück, ob die Verbindung besteht oder noch entschlüsselte Daten vorhanden sind.
+ *
+ * @return uint8_t 1: verbunden, 0: nicht verbunden
+ */
+uint8_t wio_tls::connected()
+{
+  return established && (tcp.connected() || peekByte >= 0 || mbedtls_ssl_get_bytes_avail(&ssl) > 0);
+}
+
+/**
+ * @brief Diese Methode gibt zurück, ob die Verbindung besteht.
+ *
+ */
+wio_tls::operator bool()
+{
+  return connected();
+}
+
+/********************************************************************************************
+*** Private Methods
+********************************************************************************************/
+/**
+ * @brief Diese Methode entschlüsselt den nächsten TLS Record, falls verschlüsselte Daten eingetroffen sind.
+ * Das erste Byte wird in @ref peekByte abgelegt, der Rest bleibt im Puffer von mbedtls.
+ *
+ */
+void wio_tls::fillPeek()
+{
+  uint8_t b;
+  int ret;
+
+  if (tcp.available() <= 0)
+  {
+    return;
+  }
+  ret = mbedtls_ssl_read(&ssl, &b, 1);
+  if (ret == 1)
+  {
+    peekByte = b;
+  }
+  else if (ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE)
+  {
+    established = false; // close notify or error, the connection is lost
+    tcp.stop();
+  }
+}
+
+/**
+ * @brief Diese Methode wird nach einem erfolgreichen Handshake aufgerufen. Sie führt die Statistik nach und
+ * speichert die TLS Session für den nächsten Verbindungsaufbau.
+ *
+ */
+void wio_tls::handshakeDone()
+{
+  uint32_t duration = millis() - handshakeMillis;
+
+  established = true;
+  stats.lastMs = duration;
+  if (fullHandshake)
+  {
+    stats.full++;
+    stats.fullAvgMs = stats.full == 1 ? duration : stats.fullAvgMs - stats.fullAvgMs / 4 + duration / 4; // moving average
+  }
+  else
+  {
+    stats.resumed++;
+    stats.resumedAvgMs = stats.resumed == 1 ? duration : stats.resumedAvgMs - stats.resumedAvgMs / 4 + duration / 4;
+  }
+  Serial.print("TLS handshake ");
+  Serial.print(fullHandshake ? "(full): " : "(resumed): ");
+  Serial.print(duration);
+  Serial.println(" ms");
+
+  clearSession();
+  sessionValid = mbedtls_ssl_get_session(&ssl, &session) == 0; // session for the next connection
+}
+
+/**
+ * @brief Diese Methode führt den Handshake bis zum Ende durch (max. @ref MQTT_TLS_HANDSHAKE_TIMEOUT).
+ *
+ * @return int 1: verbunden, 0: fehlgeschlagen
+ */
+int wio_tls::blockingHandshake()
+{
+  int ret;
+
+  while ((ret = handshake()) == 0)
+  {
+    if (millis() - handshakeMillis >= MQTT_TLS_HANDSHAKE_TIMEOUT)
+    {
+      break;
+    }
+    delay(1);
+  }
+  if (ret != 1)
+  {
+    tcp.stop();
+    return 0;
+  }
+  return 1;
+}
+
+/**
+ * @brief Callback von mbedtls, sendet verschlüsselte Bytes an die TCP Verbindung.
+ *
+ * @param ctx TCP Verbindung
+ * @param buf Bytes
+ * @param len Anzahl Bytes
+ * @return int Anzahl gesendeter Bytes oder Fehlercode von mbedtls
+ */
+int wio_tls::bioSend(void *ctx, const unsigned char *buf, size_t len)
+{
+  WiFiClient *client = (WiFiClient *)ctx;
+  size_t n;
+
+  if (!client->connected())
+  {
+    return MBEDTLS_ERR_NET_CONN_RESET;
+  }
+  n = client->write(buf, len);
+  return n > 0 ? (int)n : MBEDTLS_ERR_SSL_WANT_WRITE;
+}
+
+/**
+ * @brief Callback von mbedtls, liest verschlüsselte Bytes von der TCP Verbindung. Sind keine Bytes vorhanden,
+ * wird nicht gewartet, mbedtls setzt den Vorgang beim nächsten Aufruf fort.
+ *
+ * @param ctx TCP Verbindung
+ * @param buf Puffer
+ * @param len Grösse des Puffers
+ * @return int Anzahl gelesener Bytes oder Fehlercode von mbedtls
+ */
+int wio_tls::bioRecv(void *ctx, unsigned char *buf, size_t len)
+{
+  WiFiClient *client = (WiFiClient *)ctx;
+  int avail = client->available();
+
+  if (avail <= 0)
+  {
+    return client->connected() ? MBEDTLS_ERR_SSL_WANT_READ : MBEDTLS_ERR_NET_CONN_RESET;
+  }
+  return client->read(buf, min(len, (size_t)avail));
+}
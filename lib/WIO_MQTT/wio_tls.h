@@ -0,0 +1,70 @@
+/**
+ * @file wio_tls.h
+ * @author Fabian Reifler
+ * @brief TLS Verbindung über einen WiFiClient mit mbedtls, CA Pinning und Wiederaufnahme der TLS Session
+ * @version 1.1
+ * @date 19.10.2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef WIO_TLS_H
+#define WIO_TLS_H
+
+#include <Arduino.h>
+#include <rpcWiFi.h>
+#include <mbedtls/ssl.h>
+#include <mbedtls/entropy.h>
+#include <mbedtls/ctr_drbg.h>
+#include <mbedtls/x509_crt.h>
+#include "wio_mqtt.h"
+
+/********************************************************************************************
+*** Interface description
+********************************************************************************************/
+class wio_tls : public Client
+{
+public:
+  wio_tls(WiFiClient &tcp);                                ///< Konstruktor
+  bool begin(const char *caCert, const char *serverName = NULL); ///< CA Zertifikat laden und TLS konfigurieren
+  bool startHandshake(const char *hostname);               ///< Handshake auf der bestehenden TCP Verbindung beginnen
+  int handshake(void);                                     ///< Handshake um einen Schritt weiterführen
+  void clearSession(void);                                 ///< Gespeicherte TLS Session verwerfen
+  const mqtt_tls_stats_t *getStatistics(void);             ///< Statistik der Handshakes auslesen
+  int connect(IPAddress ip, uint16_t port) override;       ///< TCP Verbindung aufbauen und Handshake durchführen (blockierend)
+  int connect(const char *host, uint16_t port) override;   ///< TCP Verbindung aufbauen und Handshake durchführen (blockierend)
+  size_t write(uint8_t b) override;                        ///< Ein Byte verschlüsselt senden
+  size_t write(const uint8_t *buf, size_t size) override;  ///< Bytes verschlüsselt senden
+  int available(void) override;                            ///< Anzahl entschlüsselter Bytes, welche gelesen werden können
+  int read(void) override;                                 ///< Ein entschlüsseltes Byte lesen
+  int read(uint8_t *buf, size_t size) override;            ///< Entschlüsselte Bytes lesen
+  int peek(void) override;                                 ///< Nächstes entschlüsseltes Byte lesen, ohne es zu entfernen
+  void flush(void) override;                               ///< Sendepuffer leeren
+  void stop(void) override;                                ///< Verbindung abbauen, die TLS Session bleibt gespeichert
+  uint8_t connected(void) override;                        ///< Verbindung besteht
+  operator bool() override;                                ///< Verbindung besteht
+private:
+  WiFiClient &tcp;                                         ///< TCP Verbindung
+  mbedtls_ssl_context ssl;                                 ///< TLS Verbindung
+  mbedtls_ssl_config conf;                                 ///< TLS Konfiguration
+  mbedtls_x509_crt ca;                                     ///< Vertrauenswürdiges CA Zertifikat (Pinning)
+  mbedtls_entropy_context entropy;                         ///< Entropiequelle
+  mbedtls_ctr_drbg_context drbg;                           ///< Zufallszahlengenerator
+  mbedtls_ssl_session session;                             ///< Gespeicherte TLS Session für die Wiederaufnahme
+  const char *serverName = NULL;                           ///< Name im Zertifikat, falls der Server über die IP Adresse angesprochen wird
+  bool ready = false;                                      ///< begin() war erfolgreich
+  bool sessionValid = false;                               ///< Eine TLS Session ist gespeichert
+  bool established = false;                                ///< Der Handshake ist abgeschlossen
+  bool fullHandshake = false;                              ///< Der aktuelle Handshake tauscht Schlüssel aus (keine Wiederaufnahme)
+  int peekByte = -1;                                       ///< Bereits entschlüsseltes Byte, -1: keines
+  unsigned long handshakeMillis = 0;                       ///< Beginn des aktuellen Handshakes
+  mqtt_tls_stats_t stats = {};                             ///< Statistik der Handshakes
+  void fillPeek(void);                                     ///< Nächsten TLS Record entschlüsseln, falls Daten vorhanden sind
+  void handshakeDone(void);                                ///< Statistik nachführen und Session speichern
+  int blockingHandshake(void);                             ///< Handshake bis zum Ende durchführen
+  static int bioSend(void *ctx, const unsigned char *buf, size_t len); ///< Verschlüsselte Bytes an die TCP Verbindung senden
+  static int bioRecv(void *ctx, unsigned char *buf, size_t len);       ///< Verschlüsselte Bytes von der TCP Verbindung lesen (nicht blockierend)
+};
+
+#endif
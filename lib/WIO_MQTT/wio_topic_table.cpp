@@ -0,0 +1,416 @@
+/**
+ * @file wio_topic_table.cpp
+ * @author Fabian Reifler
+ * @brief Tabelle der abonnierten MQTT Topics mit Hash-Index für die Zuordnung Topic zu Handler \n
+ * Topics ohne Wildcards werden über einen Hash-Index gefunden, Topic Filter mit Wildcards stehen in einer
+ * separaten Liste. Beim Hinzufügen und Entfernen wird nur der betroffene Eintrag im Index nachgeführt.
+ * Die ID eines Topics (Index in der Tabelle) bleibt gültig, bis das Topic gekündigt wurde.
+ * @version 1.2
+ * @date 19.10.2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+/********************************************************************************************
+*** Includes
+********************************************************************************************/
+#include "wio_topic_table.h"
+
+/********************************************************************************************
+*** Constructor
+********************************************************************************************/
+/**
+ * @brief Konstruktor, alle Einträge sind frei
+ *
+ */
+wio_topic_table::wio_topic_table()
+{
+  for (int i = 0; i < MQTT_TOPIC_HASH_SIZE; i++)
+  {
+    buckets[i] = -1;
+  }
+  for (int i = 0; i < MQTT_MAX_SUBSCRIPTIONS; i++)
+  {
+    entries[i].state = TOPIC_FREE;
+    entries[i].filter[0] = '\0';
+    entries[i].next = -1;
+  }
+}
+
+/********************************************************************************************
+*** Public Methodes
+********************************************************************************************/
+/**
+ * @brief Diese Methode fügt einen Topic Filter hinzu. Ist der Filter bereits vorhanden, werden nur die Handler ersetzt.
+ *
+ * @param filter Topic Filter
+ * @param handler Handler für eingehende Nachrichten (darf NULL sein)
+ * @param chunkHandler Handler für Teilstücke des Payloads (darf NULL sein)
+ * @return int ID des Eintrages oder -1, wenn die Tabelle voll oder der Filter zu lang ist
+ */
+int wio_topic_table::add(const char *filter, mqtt_handler_t handler, mqtt_chunk_handler_t chunkHandler)
+{
+  int id = find(filter);
+
+  if (id >= 0)
+  {
+    entries[id].handler = handler; // already subscribed, only update the handlers
+    entries[id].chunkHandler = chunkHandler;
+    return id;
+  }
+  if (strlen(filter) >= TOPIC_LENGTH || filter[0] == '\0')
+  {
+    return -1;
+  }
+  for (id = 0; id < MQTT_MAX_SUBSCRIPTIONS; id++) // search free entry
+  {
+    if (entries[id].state == TOPIC_FREE)
+    {
+      strcpy(entries[id].filter, filter);
+      entries[id].handler = handler;
+      entries[id].chunkHandler = chunkHandler;
+      entries[id].packetId = 0;
+      entries[id].coalesce = true;
+      count++;
+      setState(id, TOPIC_SUBSCRIBE);
+      link(id);
+      return id;
+    }
+  }
+  return -1;
+}
+
+/**
+ * @brief Diese Methode markiert einen Topic Filter zum Kündigen. Der Eintrag wird sofort aus dem Index
+ * entfernt, d.h. es werden keine Nachrichten mehr an seinen Handler weitergeleitet.
+ *
+ * @param filter Topic Filter
+ * @return int ID des Eintrages oder -1, wenn der Filter nicht abonniert ist
+ */
+int wio_topic_table::remove(const char *filter)
+{
+  int id = find(filter);
+
+  if (id < 0)
+  {
+    return -1;
+  }
+  unlink(id);
+  if (entries[id].state == TOPIC_SUBSCRIBE || entries[id].state == TOPIC_REJECTED) // never reached the broker
+  {
+    release(id);
+  }
+  else
+  {
+    setState(id, TOPIC_UNSUBSCRIBE);
+  }
+  return id;
+}
+
+/**
+ * @brief Diese Methode sucht den Eintrag eines Topic Filters.
+ *
+ * @param filter Topic Filter
+ * @return int ID des Eintrages oder -1, wenn der Filter nicht vorhanden ist
+ */
+int wio_topic_table::find(const char *filter)
+{
+  for (int16_t id = *chainOf(filter); id >= 0; id = entries[id].next)
+  {
+    if (strcmp(entries[id].filter, filter) == 0)
+    {
+      return id;
+    }
+  }
+  return -1;
+}
+
+/**
+ * @brief Diese Methode sucht den Eintrag für ein empfangenes Topic. Zuerst wird im Hash-Index nach
+ * einem identischen Filter gesucht, danach in der Liste der Filter mit Wildcards.
+ *
+ * @param topic Empfangenes Topic (ohne Wildcards)
+ * @return int ID des Eintrages oder -1, wenn kein Filter passt
+ */
+int wio_topic_table::match(const char *topic)
+{
+  int id = find(topic);
+
+  if (id >= 0)
+  {
+    return id;
+  }
+  for (id = wildcards; id >= 0; id = entries[id].next)
+  {
+    if (matches(entries[id].filter, topic))
+    {
+      return id;
+    }
+  }
+  return -1;
+}
+
+/**
+ * @brief Diese Methode gibt einen Eintrag frei. Danach wird der Handler von @ref setReleaseHandler() aufgerufen,
+ * auch wenn der Eintrag durch @ref remove() oder @ref restartSession() freigegeben wird.
+ *
+ * @param id ID des Eintrages
+ */
+void wio_topic_table::release(int id)
+{
+  if (id < 0 || id >= MQTT_MAX_SUBSCRIPTIONS || entries[id].state == TOPIC_FREE)
+  {
+    return;
+  }
+  if (entries[id].state != TOPIC_UNSUBSCRIBE && entries[id].state != TOPIC_UNSUBSCRIBE_SENT)
+  {
+    unlink(id); // still in the index
+  }
+  setState(id, TOPIC_FREE);
+  entries[id].filter[0] = '\0';
+  count--;
+  if (releaseHandler)
+  {
+    releaseHandler(id); // the ID may be reused by another topic
+  }
+}
+
+/**
+ * @brief Diese Methode passt die Zustände nach einem Verbindungsaufbau an. Hat der Broker die Session
+ * behalten, müssen nur die unbestätigten Pakete wiederholt werden, sonst werden alle Topics neu abonniert.
+ *
+ * @param sessionPresent Der Broker hat die Session (und damit die Abonnements) behalten
+ */
+void wio_topic_table::restartSession(bool sessionPresent)
+{
+  for (int id = 0; id < MQTT_MAX_SUBSCRIPTIONS; id++)
+  {
+    switch (entries[id].state)
+    {
+    case TOPIC_SUBSCRIBE_SENT:
+      setState(id, TOPIC_SUBSCRIBE);
+      break;
+    case TOPIC_ACTIVE:
+    case TOPIC_REJECTED:
+      if (!sessionPresent)
+      {
+        setState(id, TOPIC_SUBSCRIBE);
+      }
+      break;
+    case TOPIC_UNSUBSCRIBE:
+    case TOPIC_UNSUBSCRIBE_SENT:
+      if (sessionPresent)
+      {
+        setState(id, TOPIC_UNSUBSCRIBE);
+      }
+      else
+      {
+        release(id); // the broker has forgotten the subscription anyway
+      }
+      break;
+    default:
+      break;
+    }
+  }
+}
+
+/**
+ * @brief Diese Methode gibt einen Eintrag zurück.
+ *
+ * @param id ID des Eintrages
+ * @return topic_entry_t* Zeiger auf den Eintrag oder NULL bei einer ungültigen ID
+ */
+topic_entry_t *wio_topic_table::get(int id)
+{
+  if (id < 0 || id >= MQTT_MAX_SUBSCRIPTIONS)
+  {
+    return NULL;
+  }
+  return &entries[id];
+}
+
+/**
+ * @brief Diese Methode gibt die Anzahl belegter Einträge zurück.
+ *
+ * @return unsigned int Anzahl Einträge
+ */
+unsigned int wio_topic_table::getCount()
+{
+  return count;
+}
+
+/**
+ * @brief Diese Methode gibt die Anzahl Einträge zurück, für welche noch ein SUBSCRIBE oder UNSUBSCRIBE
+ * gesendet werden muss. Ist der Wert 0, muss die Tabelle nicht durchsucht werden.
+ *
+ * @return unsigned int Anzahl Einträge
+ */
+unsigned int wio_topic_table::getPendingCount()
+{
+  return pending;
+}
+
+/**
+ * @brief Diese Methode markiert einen Eintrag als gesendet.
+ *
+ * @param id ID des Eintrages
+ * @param packetId Paket ID des SUBSCRIBE oder UNSUBSCRIBE Paketes
+ * @param batchPos Position des Topics im Paket, das SUBACK enthält die Return Codes in dieser Reihenfolge
+ */
+void wio_topic_table::markSent(int id, uint16_t packetId, uint8_t batchPos)
+{
+  entries[id].packetId = packetId;
+  entries[id].batchPos = batchPos;
+  setState(id, entries[id].state == TOPIC_SUBSCRIBE ? TOPIC_SUBSCRIBE_SENT : TOPIC_UNSUBSCRIBE_SENT);
+}
+
+/**
+ * @brief Diese Methode setzt den Handler, welcher nach dem Freigeben eines Eintrages aufgerufen wird. Damit
+ * können Daten, welche zur ID gespeichert sind, verworfen werden, bevor die ID wiederverwendet wird.
+ *
+ * @param handler Handler, NULL: kein Handler
+ */
+void wio_topic_table::setReleaseHandler(topic_release_handler_t handler)
+{
+  releaseHandler = handler;
+}
+
+/********************************************************************************************
+*** Private Methodes
+********************************************************************************************/
+/**
+ * @brief Diese Methode berechnet den Hash (FNV-1a) eines Topics.
+ *
+ * @param s Topic
+ * @return uint16_t Hash
+ */
+uint16_t wio_topic_table::hash(const char *s)
+{
+  uint32_t h = 2166136261UL;
+
+  while (*s)
+  {
+    h ^= (uint8_t)*s++;
+    h *= 16777619UL;
+  }
+  return (uint16_t)(h ^ (h >> 16));
+}
+
+/**
+ * @brief Diese Methode prüft, ob ein Topic Filter Wildcards enthält.
+ *
+ * @param filter Topic Filter
+ * @return true Der Filter enthält '+' oder '#'
+ * @return false Der Filter enthält keine Wildcards
+ */
+bool wio_topic_table::isWildcard(const char *filter)
+{
+  return strchr(filter, '+') != NULL || strchr(filter, '#') != NULL;
+}
+
+/**
+ * @brief Diese Methode prüft, ob ein Topic zu einem Topic Filter mit Wildcards passt.
+ *
+ * @param filter Topic Filter
+ * @param topic Topic
+ * @return true Das Topic passt zum Filter
+ * @return false Das Topic passt nicht zum Filter
+ */
+bool wio_topic_table::matches(const char *filter, const char *topic)
+{
+  while (*filter)
+  {
+    if (*filter == '#') // matches the rest of the topic
+    {
+      return true;
+    }
+    if (*filter == '+') // matches one level
+    {
+      while (*topic && *topic != '/')
+      {
+        topic++;
+      }
+      filter++;
+      continue;
+    }
+    if (*filter != *topic)
+    {
+      // "a/#" also matches the parent level "a"
+      return *topic == '\0' && filter[0] == '/' && filter[1] == '#' && filter[2] == '\0';
+    }
+    filter++;
+    topic++;
+  }
+  return *topic == '\0';
+}
+
+/**
+ * @brief Diese Methode gibt die Liste zurück, in welcher ein Filter eingetragen wird.
+ *
+ * @param filter Topic Filter
+ * @return int16_t* Zeiger auf den Anfang der Liste
+ */
+int16_t *wio_topic_table::chainOf(const char *filter)
+{
+  if (isWildcard(filter))
+  {
+    return &wildcards;
+  }
+  return &buckets[hash(filter) & (MQTT_TOPIC_HASH_SIZE - 1)];
+}
+
+/**
+ * @brief Diese Methode nimmt einen Eintrag in den Index auf.
+ *
+ * @param id ID des Eintrages
+ */
+void wio_topic_table::link(int id)
+{
+  int16_t *head = chainOf(entries[id].filter);
+
+  entries[id].next = *head;
+  *head = id;
+}
+
+/**
+ * @brief Diese Methode entfernt einen Eintrag aus dem Index.
+ *
+ * @param id ID des Eintrages
+ */
+void wio_topic_table::unlink(int id)
+{
+  int16_t *link = chainOf(entries[id].filter);
+
+  while (*link >= 0)
+  {
+    if (*link == id)
+    {
+      *link = entries[id].next;
+      break;
+    }
+    link = &entries[*link].next;
+  }
+  entries[id].next = -1;
+}
+
+/**
+ * @brief Diese Methode setzt den Zustand eines Eintrages und führt den Zähler der ausstehenden Einträge nach.
+ *
+ * @param id ID des Eintrages
+ * @param state Neuer Zustand
+ */
+void wio_topic_table::setState(int id, uint8_t state)
+{
+  uint8_t old = entries[id].state;
+
+  if (old == TOPIC_SUBSCRIBE || old == TOPIC_UNSUBSCRIBE)
+  {
+    pending--;
+  }
+  if (state == TOPIC_SUBSCRIBE || state == TOPIC_UNSUBSCRIBE)
+  {
+    pending++;
+  }
+  entries[id].state = state;
+}
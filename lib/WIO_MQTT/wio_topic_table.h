@@ -0,0 +1,90 @@
+/**
+ * @file wio_topic_table.h
+ * @author Fabian Reifler
+ * @brief Tabelle der abonnierten MQTT Topics mit Hash-Index für die Zuordnung Topic zu Handler
+ * @version 1.3
+ * @date 19.10.2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef WIO_TOPIC_TABLE_H
+#define WIO_TOPIC_TABLE_H
+
+#include <Arduino.h>
+#include "wio_mqtt.h"
+
+/********************************************************************************************
+*** Defines
+********************************************************************************************/
+#define MQTT_MAX_SUBSCRIPTIONS 64  ///< Maximale Anzahl gleichzeitig abonnierter Topics
+#define MQTT_TOPIC_HASH_SIZE 64    ///< Anzahl Einträge im Hash-Index (Zweierpotenz)
+
+/********************************************************************************************
+*** Enumerations
+********************************************************************************************/
+/// Zustand eines Eintrages der Topic Tabelle
+typedef enum{
+  TOPIC_FREE,             ///< Eintrag ist frei
+  TOPIC_SUBSCRIBE,        ///< Topic muss noch abonniert werden
+  TOPIC_SUBSCRIBE_SENT,   ///< SUBSCRIBE wurde gesendet, es wird auf das SUBACK gewartet
+  TOPIC_ACTIVE,           ///< Topic ist abonniert
+  TOPIC_REJECTED,         ///< Der Broker hat das Abonnement abgelehnt
+  TOPIC_UNSUBSCRIBE,      ///< Abonnement muss noch gekündigt werden
+  TOPIC_UNSUBSCRIBE_SENT  ///< UNSUBSCRIBE wurde gesendet, es wird auf das UNSUBACK gewartet
+}topic_state_e;
+
+/********************************************************************************************
+*** Datatypes
+********************************************************************************************/
+/// Handler, welcher nach dem Freigeben eines Eintrages aufgerufen wird (ID eines Eintrages)
+typedef void (*topic_release_handler_t)(int id);
+
+/// Eintrag der Topic Tabelle
+typedef struct{
+  char filter[TOPIC_LENGTH]; ///< Topic Filter, darf die Wildcards '+' und '#' enthalten
+  mqtt_handler_t handler;    ///< Handler für eingehende Nachrichten, NULL: Callback Funktion von @ref wio_mqtt::initMQTT()
+  mqtt_chunk_handler_t chunkHandler; ///< Handler für Teilstücke des Payloads, hat Vorrang vor handler
+  uint16_t packetId;         ///< Paket ID des letzten SUBSCRIBE/UNSUBSCRIBE Paketes
+  uint8_t batchPos;          ///< Position im letzten SUBSCRIBE/UNSUBSCRIBE Paket (Index des Return Codes im SUBACK)
+  uint8_t state;             ///< Zustand, siehe @ref topic_state_e
+  int16_t next;              ///< Nächster Eintrag im selben Hash-Bucket bzw. in der Wildcard-Liste
+  bool coalesce;             ///< Nachrichten werden pro Topic zusammengefasst, siehe @ref wio_mqtt::setCoalescing()
+}topic_entry_t;
+
+/********************************************************************************************
+*** Interface description
+********************************************************************************************/
+class wio_topic_table
+{
+public:
+  wio_topic_table();                                      ///< Konstruktor
+  int add(const char *filter, mqtt_handler_t handler, mqtt_chunk_handler_t chunkHandler); ///< Topic Filter hinzufügen
+  int remove(const char *filter);                         ///< Topic Filter zum Kündigen markieren
+  int find(const char *filter);                           ///< Eintrag eines Topic Filters suchen
+  int match(const char *topic);                           ///< Eintrag für ein empfangenes Topic suchen
+  void release(int id);                                   ///< Eintrag freigeben
+  void restartSession(bool sessionPresent);               ///< Zustände nach einem Verbindungsaufbau anpassen
+  topic_entry_t *get(int id);                             ///< Eintrag auslesen
+  unsigned int getCount(void);                            ///< Anzahl belegter Einträge
+  unsigned int getPendingCount(void);                     ///< Anzahl Einträge, die noch gesendet werden müssen
+  void markSent(int id, uint16_t packetId, uint8_t batchPos); ///< Eintrag als gesendet markieren
+  void setReleaseHandler(topic_release_handler_t handler); ///< Handler für freigegebene Einträge setzen
+private:
+  topic_entry_t entries[MQTT_MAX_SUBSCRIPTIONS];          ///< Einträge
+  int16_t buckets[MQTT_TOPIC_HASH_SIZE];                  ///< Hash-Index, erster Eintrag pro Bucket
+  int16_t wildcards = -1;                                 ///< Erster Eintrag der Wildcard-Liste
+  unsigned int count = 0;                                 ///< Anzahl belegter Einträge
+  unsigned int pending = 0;                               ///< Anzahl Einträge in TOPIC_SUBSCRIBE oder TOPIC_UNSUBSCRIBE
+  topic_release_handler_t releaseHandler = NULL;          ///< Wird nach jedem Freigeben eines Eintrages aufgerufen
+  static uint16_t hash(const char *s);                    ///< Hash eines Topics
+  static bool isWildcard(const char *filter);             ///< Enthält der Filter Wildcards?
+  static bool matches(const char *filter, const char *topic); ///< Passt das Topic zum Filter?
+  int16_t *chainOf(const char *filter);                   ///< Liste, in welcher der Filter eingetragen ist
+  void link(int id);                                      ///< Eintrag in den Index aufnehmen
+  void unlink(int id);                                    ///< Eintrag aus dem Index entfernen
+  void setState(int id, uint8_t state);                   ///< Zustand setzen und Zähler nachführen
+};
+
+#endif
@@ -0,0 +1,246 @@
+/**
+ * @file wio_link_monitor.cpp
+ * @author Fabian Reifler
+ * @brief Überwachung der aktuellen WLAN Verbindung (RSSI, Kanal, BSSID) ohne Netzwerk Scan \n
+ * Der RSSI wird direkt von der bestehenden Verbindung gelesen, der Funk bleibt dabei auf dem Kanal.
+ * Ein vollständiger Scan (alle Kanäle) wird nur auf Anfrage oder im Intervall @ref WIFI_SCAN_INTERVAL gestartet.
+ * Der RSSI wird mit einem gleitenden Mittelwert geglättet und mit Hysterese auf Qualitätsstufen abgebildet,
+ * damit die Anzeige nicht bei jedem Schwanken um 1 dB neu gezeichnet werden muss.
+ * @version 1.3
+ * @date 19.10.2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+/********************************************************************************************
+*** Includes
+********************************************************************************************/
+#include "wio_link_monitor.h"
+
+/********************************************************************************************
+*** Constructor
+********************************************************************************************/
+/**
+ * @brief Konstruktor
+ *
+ * @param wifi WLAN Schnittstelle
+ */
+wio_link_monitor::wio_link_monitor(wio_wifi &wifi) : wifi(wifi)
+{
+  reset();
+  link.samples = 0;
+  link.scans = 0;
+  link.networks = -1;
+  link.scanRssi = -99;
+}
+
+/********************************************************************************************
+*** Public Methodes
+********************************************************************************************/
+/**
+ * @brief Diese Methode liest im Intervall @ref WIFI_LINK_SAMPLE_INTERVAL die Werte der Verbindung
+ * und führt angeforderte Scans aus. Sie muss im loop() aufgerufen werden.
+ *
+ * @param connected Die WLAN Verbindung besteht
+ * @return true Es wurde eine neue Messung durchgeführt
+ * @return false Keine neue Messung
+ */
+bool wio_link_monitor::handler(bool connected)
+{
+  unsigned long now = millis();
+
+  if (!connected)
+  {
+    if (link.rssi != -99)
+    {
+      reset();
+      return true;
+    }
+    return false;
+  }
+
+  scanHandler();
+
+  if (link.timestamp != 0 && now - sampleMillis < WIFI_LINK_SAMPLE_INTERVAL)
+  {
+    return false;
+  }
+  sampleMillis = now;
+  sample();
+  return true;
+}
+
+/**
+ * @brief Diese Methode fordert einen vollständigen Scan an. Er wird beim nächsten Aufruf von
+ * @ref handler() gestartet, sofern die Verbindung besteht.
+ *
+ */
+void wio_link_monitor::requestScan(void)
+{
+  scanRequested = true;
+}
+
+/**
+ * @brief Diese Methode gibt zurück, ob ein Scan läuft.
+ *
+ * @return true Scan läuft
+ * @return false Kein Scan aktiv
+ */
+bool wio_link_monitor::isScanning(void)
+{
+  return scanRunning;
+}
+
+/**
+ * @brief Diese Methode gibt den zuletzt gemessenen Zustand der Verbindung zurück.
+ *
+ * @return const wifi_link_t* Zustand der Verbindung
+ */
+const wifi_link_t *wio_link_monitor::getLink(void)
+{
+  return &link;
+}
+
+/**
+ * @brief Diese Methode setzt einen Handler, welcher nach jedem abgeschlossenen Scan aufgerufen wird.
+ * Die Resultate können im Handler gelesen werden, danach werden sie gelöscht.
+ *
+ * @param handler Handler, NULL: keiner
+ */
+void wio_link_monitor::setScanHandler(wifi_scan_handler_t handler)
+{
+  scanHandlerCb = handler;
+}
+
+/********************************************************************************************
+*** Private Methodes
+********************************************************************************************/
+/**
+ * @brief Diese Methode liest den RSSI der Verbindung. Kanal und BSSID ändern sich nur bei einem
+ * Wechsel des Access Points und werden deshalb nur bei jeder @ref WIFI_LINK_INFO_SAMPLES -ten Messung gelesen.
+ *
+ */
+void wio_link_monitor::sample(void)
+{
+  link.rssi = WiFi.RSSI(); // RSSI of the associated AP, no scan needed
+  filter();
+  if (link.channel == 0 || link.samples % WIFI_LINK_INFO_SAMPLES == 0)
+  {
+    link.channel = WiFi.channel();
+    uint8_t *bssid = WiFi.BSSID();
+    if (bssid != NULL)
+    {
+      memcpy(link.bssid, bssid, sizeof(link.bssid));
+    }
+  }
+  link.samples++;
+  link.timestamp = millis();
+}
+
+/**
+ * @brief Diese Methode führt den gleitenden Mittelwert (EMA) der Signalstärke und die Qualitätsstufe nach.
+ * Die Stufe steigt erst, wenn der Mittelwert die Grenze um @ref WIFI_QUALITY_HYSTERESIS überschreitet, und
+ * sinkt erst, wenn er sie um diesen Wert unterschreitet.
+ *
+ */
+void wio_link_monitor::filter(void)
+{
+  static const int lowerBound[] = {0, -1000, WIFI_QUALITY_LOW_RSSI, WIFI_QUALITY_MID_RSSI, WIFI_QUALITY_FULL_RSSI}; // per wifi_quality_e
+
+  if (link.quality == WIFI_QUALITY_NONE) // first sample after connecting
+  {
+    rssiSum = (int32_t)link.rssi << WIFI_RSSI_FILTER_SHIFT;
+  }
+  else
+  {
+    rssiSum += link.rssi - (rssiSum >> WIFI_RSSI_FILTER_SHIFT);
+  }
+  link.rssiFiltered = rssiSum >> WIFI_RSSI_FILTER_SHIFT;
+
+  if (link.quality == WIFI_QUALITY_NONE)
+  {
+    link.quality = WIFI_QUALITY_WEAK;
+    while (link.quality < WIFI_QUALITY_FULL && link.rssiFiltered >= lowerBound[link.quality + 1])
+    {
+      link.quality++; // no hysteresis for the initial level
+    }
+    return;
+  }
+  while (link.quality < WIFI_QUALITY_FULL && link.rssiFiltered >= lowerBound[link.quality + 1] + WIFI_QUALITY_HYSTERESIS)
+  {
+    link.quality++;
+  }
+  while (link.quality > WIFI_QUALITY_WEAK && link.rssiFiltered < lowerBound[link.quality] - WIFI_QUALITY_HYSTERESIS)
+  {
+    link.quality--;
+  }
+}
+
+/**
+ * @brief Diese Methode setzt die Werte der Verbindung zurück.
+ *
+ */
+void wio_link_monitor::reset(void)
+{
+  link.rssi = -99;
+  link.rssiFiltered = -99;
+  link.quality = WIFI_QUALITY_NONE;
+  link.channel = 0;
+  memset(link.bssid, 0, sizeof(link.bssid));
+  link.timestamp = 0;
+}
+
+/**
+ * @brief Diese Methode startet einen angeforderten oder fälligen Scan und wertet die Resultate aus,
+ * sobald der Scan abgeschlossen ist. Die Resultate werden dabei in den Snapshot von @ref wio_wifi kopiert.
+ *
+ */
+void wio_link_monitor::scanHandler(void)
+{
+  unsigned long now = millis();
+
+  if (!scanRunning)
+  {
+    bool due = WIFI_SCAN_INTERVAL > 0 && now - scanMillis >= WIFI_SCAN_INTERVAL;
+    if (scanRequested || due)
+    {
+      scanRequested = false;
+      scanRunning = true;
+      scanMillis = now;
+      wifi.scanNetwork(); // asynchronous, the results are polled below
+    }
+    return;
+  }
+
+  int found = wifi.getNetworksFound();
+  if (found == -1) // scan not completed yet
+  {
+    return;
+  }
+  if (found < 0) // scan could not be started, try again at the next cadence
+  {
+    scanRunning = false;
+    return;
+  }
+
+  // found is the number of networks in the snapshot, the results are already freed in the WiFi chip
+  int best = -99;
+  for (int i = 0; i < found; i++)
+  {
+    const wifi_scan_entry_t *entry = wifi.getScanResult(i);
+    if (strcmp(entry->ssid, wifi.getSSID()) == 0) // several APs may share the SSID, the snapshot is sorted by RSSI
+    {
+      best = entry->rssi;
+      break;
+    }
+  }
+  if (scanHandlerCb != NULL)
+  {
+    scanHandlerCb(found);
+  }
+  link.networks = found;
+  link.scanRssi = best;
+  link.scans++;
+  scanRunning = false;
+}
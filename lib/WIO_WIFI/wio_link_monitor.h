@@ -0,0 +1,89 @@
+/**
+ * @file wio_link_monitor.h
+ * @author Fabian Reifler
+ * @brief Überwachung der aktuellen WLAN Verbindung (RSSI, Kanal, BSSID) ohne Netzwerk Scan
+ * @version 1.3
+ * @date 19.10.2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef WIO_LINK_MONITOR_H
+#define WIO_LINK_MONITOR_H
+
+#include <Arduino.h>
+#include "wio_wifi.h"
+
+/********************************************************************************************
+*** Defines
+********************************************************************************************/
+#define WIFI_LINK_SAMPLE_INTERVAL 1000  ///< Intervall in ms, in welchem der RSSI der Verbindung gelesen wird
+#define WIFI_LINK_INFO_SAMPLES 10       ///< Kanal und BSSID werden bei jeder n-ten Messung neu gelesen
+#define WIFI_SCAN_INTERVAL 300000       ///< Intervall in ms für einen vollständigen Scan, 0: nur auf Anfrage
+#define WIFI_RSSI_FILTER_SHIFT 2        ///< Gewicht einer neuen Messung im gleitenden Mittelwert: 1/2^n
+#define WIFI_QUALITY_HYSTERESIS 3       ///< Hysterese in dB beim Wechsel der Qualitätsstufe
+#define WIFI_QUALITY_FULL_RSSI -49      ///< Untere Grenze (dBm) der Stufe WIFI_QUALITY_FULL
+#define WIFI_QUALITY_MID_RSSI -59       ///< Untere Grenze (dBm) der Stufe WIFI_QUALITY_MID
+#define WIFI_QUALITY_LOW_RSSI -69       ///< Untere Grenze (dBm) der Stufe WIFI_QUALITY_LOW
+
+/********************************************************************************************
+*** Enumerations
+********************************************************************************************/
+/// Qualitätsstufe der Verbindung, aus der gefilterten Signalstärke mit Hysterese
+typedef enum{
+  WIFI_QUALITY_NONE,      ///< Nicht verbunden
+  WIFI_QUALITY_WEAK,      ///< Schwach, unter WIFI_QUALITY_LOW_RSSI
+  WIFI_QUALITY_LOW,       ///< Schlecht
+  WIFI_QUALITY_MID,       ///< Gut
+  WIFI_QUALITY_FULL       ///< Sehr gut
+}wifi_quality_e;
+
+/********************************************************************************************
+*** Datatypes
+********************************************************************************************/
+/// Handler für abgeschlossene Scans, die Resultate stehen im Snapshot von @ref wio_wifi (Parameter: Anzahl Netzwerke im Snapshot)
+typedef void (*wifi_scan_handler_t)(int found);
+
+/// Zustand der aktuellen WLAN Verbindung
+typedef struct{
+  int rssi;                    ///< Gemessene Signalstärke in dBm (ungefiltert), -99: nicht verbunden
+  int rssiFiltered;            ///< Gleitender Mittelwert der Signalstärke in dBm, -99: nicht verbunden
+  int quality;                 ///< Qualitätsstufe, siehe @ref wifi_quality_e
+  int channel;                 ///< WLAN Kanal, 0: unbekannt
+  uint8_t bssid[6];            ///< BSSID des Access Points
+  unsigned long timestamp;     ///< Zeitpunkt der letzten Messung (millis)
+  unsigned long samples;       ///< Anzahl Messungen
+  unsigned long scans;         ///< Anzahl abgeschlossener Scans
+  int networks;                ///< Anzahl gefundener Netzwerke beim letzten Scan, -1: noch kein Scan
+  int scanRssi;                ///< Beste Signalstärke der eigenen SSID beim letzten Scan
+}wifi_link_t;
+
+/********************************************************************************************
+*** Interface description
+********************************************************************************************/
+class wio_link_monitor
+{
+public:
+  wio_link_monitor(wio_wifi &wifi);                        ///< Konstruktor
+  bool handler(bool connected);                            ///< Messungen und Scans ausführen, im loop() aufrufen
+  void requestScan(void);                                  ///< Einen vollständigen Scan anfordern
+  bool isScanning(void);                                   ///< Ein Scan läuft
+  const wifi_link_t *getLink(void);                        ///< Zustand der Verbindung auslesen
+  void setScanHandler(wifi_scan_handler_t handler);        ///< Handler für abgeschlossene Scans setzen
+private:
+  wio_wifi &wifi;                                          ///< WLAN Schnittstelle
+  wifi_link_t link;                                        ///< Zustand der Verbindung
+  wifi_scan_handler_t scanHandlerCb = NULL;                ///< Handler für abgeschlossene Scans
+  bool scanRequested = false;                              ///< Ein Scan wurde angefordert
+  bool scanRunning = false;                                ///< Ein asynchroner Scan läuft
+  unsigned long sampleMillis = 0;                          ///< Zeitpunkt der letzten Messung
+  unsigned long scanMillis = 0;                            ///< Zeitpunkt des letzten Scans
+  int32_t rssiSum = 0;                                     ///< Gleitender Mittelwert mal 2^WIFI_RSSI_FILTER_SHIFT
+  void filter(void);                                       ///< Mittelwert und Qualitätsstufe nachführen
+  void sample(void);                                       ///< RSSI (und Kanal, BSSID) der Verbindung lesen
+  void reset(void);                                        ///< Werte nach einem Verbindungsabbruch zurücksetzen
+  void scanHandler(void);                                  ///< Scan starten und Resultate auswerten
+};
+
+#endif
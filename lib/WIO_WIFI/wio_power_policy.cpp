@@ -0,0 +1,207 @@
+/**
+ * @file wio_power_policy.cpp
+ * @author Fabian Reifler
+ * @brief Stromsparmodus des WLAN abhängig vom Verkehr der Anwendung \n
+ * Der Stromsparmodus ist nur mit @ref WIFI_PS_ENABLE aktiv. Solange Pakete gesendet oder empfangen werden,
+ * Nachrichten ausstehen, Befehls-Topics abonniert sind oder eine Verbindung aufgebaut wird, läuft der Funk mit
+ * voller Leistung. Nach @ref WIFI_PS_IDLE_TIME ohne Verkehr wird in den Stromsparmodus
+ * (Modem Sleep) gewechselt. Kurz vor dem Keep Alive wird wieder auf volle Leistung gewechselt, damit die Antwort
+ * des Brokers nicht bis zum nächsten Beacon verzögert wird. Jedes @ref WIFI_PS_CALIBRATION_PINGS -te Keep Alive
+ * bleibt im Stromsparmodus, so wird die Umlaufzeit in beiden Modi gemessen und die zusätzliche Latenz sichtbar.
+ * @version 1.1
+ * @date 19.10.2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+/********************************************************************************************
+*** Includes
+********************************************************************************************/
+#include "wio_power_policy.h"
+
+/**
+ * @brief Gleitender Mittelwert einer Umlaufzeit
+ *
+ * @param avg Bisheriger Mittelwert, 0: noch kein Wert
+ * @param value Neuer Wert
+ * @return unsigned long Neuer Mittelwert
+ */
+static unsigned long rttAverage(unsigned long avg, unsigned long value)
+{
+  return avg == 0 ? value : avg - avg / 4 + value / 4;
+}
+
+/********************************************************************************************
+*** Constructor
+********************************************************************************************/
+/**
+ * @brief Konstruktor
+ *
+ * @param wifi WLAN Schnittstelle
+ */
+wio_power_policy::wio_power_policy(wio_wifi &wifi) : wifi(wifi)
+{
+  stats.mode = WIFI_POWER_PERFORMANCE;
+}
+
+/********************************************************************************************
+*** Public Methodes
+********************************************************************************************/
+/**
+ * @brief Diese Methode wählt den Modus anhand des Verkehrs und setzt ihn, wenn er sich geändert hat. Nach jedem
+ * Verbindungsaufbau wird der Modus neu gesetzt. Sie muss im loop() aufgerufen werden.
+ *
+ * @param connected Die WLAN Verbindung besteht
+ * @param traffic Verkehr der Anwendung
+ * @return true Der Modus wurde gewechselt
+ * @return false Keine Änderung
+ */
+bool wio_power_policy::handler(bool connected, const wifi_traffic_t *traffic)
+{
+  unsigned long now = millis();
+
+  if (accountMillis != 0) // time in the current mode, only while connected
+  {
+    if (stats.mode == WIFI_POWER_SAVE)
+    {
+      stats.sleepMs += now - accountMillis;
+    }
+    else
+    {
+      stats.awakeMs += now - accountMillis;
+    }
+  }
+  if (!connected)
+  {
+    applied = false; // set the mode again on the next connection
+    accountMillis = 0;
+    pinging = false;
+    stats.mode = WIFI_POWER_PERFORMANCE;
+    return false;
+  }
+  accountMillis = now;
+
+  if (traffic->packets != lastPackets)
+  {
+    lastPackets = traffic->packets;
+    activityMillis = now;
+  }
+  if (traffic->session && traffic->keepAliveMs == 0 && !pinging)
+  {
+    pinging = true;
+    pingClean = true;
+  }
+  if (traffic->pings != lastPings)
+  {
+    lastPings = traffic->pings;
+    if (pinging && pingClean)
+    {
+      sample(traffic->rttMs);
+    }
+    pinging = false;
+  }
+
+  int wanted = decide(now, traffic);
+  if (applied && wanted == stats.mode)
+  {
+    return false;
+  }
+  wifi.setPowerSave(wanted == WIFI_POWER_SAVE);
+  if (applied)
+  {
+    stats.switches++;
+    pingClean = false; // a sample of this keep alive would mix both modes
+  }
+  applied = true;
+  stats.mode = wanted;
+  return true;
+}
+
+/**
+ * @brief Diese Methode gibt die Statistik der Leistungsmodi zurück.
+ *
+ * @return const wifi_power_stats_t* Statistik
+ */
+const wifi_power_stats_t *wio_power_policy::getStatistics(void)
+{
+  return &stats;
+}
+
+/**
+ * @brief Diese Methode gibt den Anteil der verbundenen Zeit zurück, in welcher der Funk mit voller Leistung lief.
+ *
+ * @return uint8_t Anteil in %, 100: noch keine Zeit erfasst oder nie im Stromsparmodus
+ */
+uint8_t wio_power_policy::getDutyCycle(void)
+{
+  unsigned long total = stats.awakeMs + stats.sleepMs;
+
+  if (total == 0)
+  {
+    return 100;
+  }
+  return (uint8_t)((unsigned long long)stats.awakeMs * 100 / total);
+}
+
+/********************************************************************************************
+*** Private Methodes
+********************************************************************************************/
+/**
+ * @brief Diese Methode bestimmt den gewünschten Modus.
+ * - Volle Leistung: keine Sitzung (Verbindungsaufbau), ausstehende Nachrichten, abonnierte Befehls-Topics (die
+ *   Latenz eingehender Befehle zählt) oder Verkehr in den letzten @ref WIFI_PS_IDLE_TIME ms, sowie ab @ref WIFI_PS_KEEPALIVE_GUARD ms vor dem Keep Alive (ausser zur Kalibrierung).
+ * - Während ein Keep Alive läuft, bleibt der Modus unverändert, damit die Messung einem Modus zugeordnet werden kann.
+ * - Sonst Stromsparmodus.
+ *
+ * @param now Aktuelle Zeit (millis)
+ * @param traffic Verkehr der Anwendung
+ * @return int Gewünschter Modus, siehe @ref wifi_power_e
+ */
+int wio_power_policy::decide(unsigned long now, const wifi_traffic_t *traffic)
+{
+  if (!WIFI_PS_ENABLE || !traffic->session || traffic->pending > 0 || traffic->commands > 0 ||
+      now - activityMillis < WIFI_PS_IDLE_TIME)
+  {
+    return WIFI_POWER_PERFORMANCE;
+  }
+  if (traffic->keepAliveMs == 0) // keep alive running
+  {
+    return stats.mode;
+  }
+  if (traffic->keepAliveMs > WIFI_PS_KEEPALIVE_GUARD)
+  {
+    guard = false;
+    return WIFI_POWER_SAVE;
+  }
+  if (!guard) // keep alive due soon, decided once per keep alive
+  {
+    guard = true;
+    keepAlives++;
+    calibrate = WIFI_PS_CALIBRATION_PINGS > 0 && keepAlives % WIFI_PS_CALIBRATION_PINGS == 0;
+    if (!calibrate)
+    {
+      stats.keepAliveWakes++;
+    }
+  }
+  return calibrate ? WIFI_POWER_SAVE : WIFI_POWER_PERFORMANCE;
+}
+
+/**
+ * @brief Diese Methode ordnet die Umlaufzeit eines Keep Alive dem aktuellen Modus zu.
+ *
+ * @param rttMs Umlaufzeit in ms
+ */
+void wio_power_policy::sample(uint32_t rttMs)
+{
+  if (stats.mode == WIFI_POWER_SAVE)
+  {
+    stats.rttSleepAvgMs = rttAverage(stats.rttSleepAvgMs, rttMs);
+    stats.rttSleepSamples++;
+  }
+  else
+  {
+    stats.rttAwakeAvgMs = rttAverage(stats.rttAwakeAvgMs, rttMs);
+    stats.rttAwakeSamples++;
+  }
+}
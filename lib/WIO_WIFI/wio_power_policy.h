@@ -0,0 +1,89 @@
+/**
+ * @file wio_power_policy.h
+ * @author Fabian Reifler
+ * @brief Stromsparmodus des WLAN abhängig vom Verkehr der Anwendung (volle Leistung bei Verkehr, Modem Sleep im Leerlauf)
+ * @version 1.1
+ * @date 19.10.2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef WIO_POWER_POLICY_H
+#define WIO_POWER_POLICY_H
+
+#include <Arduino.h>
+#include "wio_wifi.h"
+
+/********************************************************************************************
+*** Defines
+********************************************************************************************/
+#define WIFI_PS_ENABLE 0                ///< 1: Stromsparmodus im Leerlauf (verzögert eingehende Nachrichten bis zum nächsten Beacon), 0: immer volle Leistung
+#define WIFI_PS_IDLE_TIME 3000          ///< Ohne Verkehr während dieser Zeit in ms wird in den Stromsparmodus gewechselt
+#define WIFI_PS_KEEPALIVE_GUARD 1000    ///< So viele ms vor dem Keep Alive wird auf volle Leistung gewechselt
+#define WIFI_PS_CALIBRATION_PINGS 8     ///< Jedes n-te Keep Alive wird im Stromsparmodus gemessen (Latenz Vergleich), 0: nie
+
+/********************************************************************************************
+*** Enumerations
+********************************************************************************************/
+/// Leistungsmodus des WLAN
+typedef enum{
+  WIFI_POWER_PERFORMANCE, ///< Volle Leistung, der Funk ist immer bereit
+  WIFI_POWER_SAVE         ///< Modem Sleep, der Funk schläft zwischen den Beacons
+}wifi_power_e;
+
+/********************************************************************************************
+*** Datatypes
+********************************************************************************************/
+/// Verkehr der Anwendung, wird bei jedem Aufruf von @ref wio_power_policy::handler() übergeben
+typedef struct{
+  bool session;               ///< Die Sitzung besteht (z.B. MQTT verbunden), sonst läuft ein Verbindungsaufbau
+  uint32_t packets;           ///< Zähler der gesendeten und empfangenen Pakete ohne Keep Alive
+  uint16_t pending;           ///< Anzahl Nachrichten, die noch gesendet oder bestätigt werden müssen
+  uint16_t commands;          ///< Anzahl abonnierter Befehls-Topics, solange > 0 bleibt die volle Leistung
+  uint32_t keepAliveMs;       ///< Zeit bis zum nächsten Keep Alive in ms, 0: Keep Alive läuft
+  uint32_t pings;             ///< Zähler der beantworteten Keep Alive
+  uint32_t rttMs;             ///< Umlaufzeit des letzten Keep Alive in ms
+}wifi_traffic_t;
+
+/// Statistik der Leistungsmodi
+typedef struct{
+  int mode;                        ///< Aktueller Modus, siehe @ref wifi_power_e
+  unsigned long switches;          ///< Anzahl Wechsel des Modus
+  unsigned long awakeMs;           ///< Verbundene Zeit mit voller Leistung in ms
+  unsigned long sleepMs;           ///< Verbundene Zeit im Stromsparmodus in ms
+  unsigned long keepAliveWakes;    ///< Anzahl Wechsel auf volle Leistung nur für ein Keep Alive
+  unsigned long rttAwakeAvgMs;     ///< Gleitender Mittelwert der Keep Alive Umlaufzeit mit voller Leistung
+  unsigned long rttSleepAvgMs;     ///< Gleitender Mittelwert der Keep Alive Umlaufzeit im Stromsparmodus
+  unsigned long rttAwakeSamples;   ///< Anzahl Messungen mit voller Leistung
+  unsigned long rttSleepSamples;   ///< Anzahl Messungen im Stromsparmodus
+}wifi_power_stats_t;
+
+/********************************************************************************************
+*** Interface description
+********************************************************************************************/
+class wio_power_policy
+{
+public:
+  wio_power_policy(wio_wifi &wifi);                        ///< Konstruktor
+  bool handler(bool connected, const wifi_traffic_t *traffic); ///< Modus anhand des Verkehrs wählen, im loop() aufrufen
+  const wifi_power_stats_t *getStatistics(void);           ///< Statistik auslesen
+  uint8_t getDutyCycle(void);                              ///< Anteil der verbundenen Zeit mit voller Leistung in %
+private:
+  wio_wifi &wifi;                                          ///< WLAN Schnittstelle
+  wifi_power_stats_t stats = {};                           ///< Statistik
+  bool applied = false;                                    ///< Der Modus wurde für die aktuelle Verbindung gesetzt
+  unsigned long accountMillis = 0;                         ///< Zeitpunkt des letzten Aufrufes, 0: nicht verbunden
+  unsigned long activityMillis = 0;                        ///< Zeitpunkt des letzten Verkehrs
+  uint32_t lastPackets = 0;                                ///< Paketzähler beim letzten Aufruf
+  uint32_t lastPings = 0;                                  ///< Keep Alive Zähler beim letzten Aufruf
+  unsigned long keepAlives = 0;                            ///< Anzahl Keep Alive im Stromsparbetrieb (für die Kalibrierung)
+  bool guard = false;                                      ///< Das nächste Keep Alive ist bald fällig
+  bool calibrate = false;                                  ///< Das nächste Keep Alive wird im Stromsparmodus gemessen
+  bool pinging = false;                                    ///< Ein Keep Alive läuft
+  bool pingClean = false;                                  ///< Der Modus hat während des laufenden Keep Alive nicht gewechselt
+  int decide(unsigned long now, const wifi_traffic_t *traffic); ///< Gewünschten Modus bestimmen
+  void sample(uint32_t rttMs);                             ///< Umlaufzeit dem aktuellen Modus zuordnen
+};
+
+#endif
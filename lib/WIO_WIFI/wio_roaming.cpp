@@ -0,0 +1,218 @@
+/**
+ * @file wio_roaming.cpp
+ * @author Fabian Reifler
+ * @brief Roaming zwischen mehreren Access Points der bekannten WLAN Netzwerke anhand der Signalstärke \n
+ * Fällt die Signalstärke der Verbindung unter @ref WIFI_ROAM_RSSI_THRESHOLD, wird ein Scan angefordert. Die Access Points
+ * der bekannten Netzwerke werden in einer kleinen Tabelle gehalten. Ist ein anderer Access Point um mindestens
+ * @ref WIFI_ROAM_HYSTERESIS dB stärker, wird direkt zu diesem gewechselt (BSSID und Kanal, ohne weiteren Scan).
+ * @version 1.2
+ * @date 19.10.2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+/********************************************************************************************
+*** Includes
+********************************************************************************************/
+#include "wio_roaming.h"
+
+/********************************************************************************************
+*** Constructor
+********************************************************************************************/
+/**
+ * @brief Konstruktor, die Scan Tabelle ist leer
+ *
+ * @param wifi WLAN Schnittstelle
+ * @param monitor Überwachung der aktuellen Verbindung, führt die Scans aus
+ */
+wio_roaming::wio_roaming(wio_wifi &wifi, wio_link_monitor &monitor) : wifi(wifi), monitor(monitor)
+{
+  for (int i = 0; i < WIFI_ROAM_TABLE_SIZE; i++)
+  {
+    table[i].network = -1;
+  }
+}
+
+/********************************************************************************************
+*** Public Methodes
+********************************************************************************************/
+/**
+ * @brief Diese Methode misst die Verbindungsunterbrüche und fordert bei schwachem Signal einen Scan an.
+ * Sie wird nach jeder Messung des @ref wio_link_monitor aufgerufen.
+ *
+ */
+void wio_roaming::handler(void)
+{
+  const wifi_link_t *link = monitor.getLink();
+  unsigned long now = millis();
+
+  if (link->timestamp == 0) // not connected
+  {
+    if (outageMillis == 0 && link->samples > 0) // count only after the first connection, not the boot
+    {
+      outageMillis = now;
+    }
+    return;
+  }
+
+  if (outageMillis != 0)
+  {
+    stats.outages++;
+    stats.lastOutageMs = now - outageMillis;
+    stats.totalOutageMs += stats.lastOutageMs;
+    if (stats.lastOutageMs > stats.maxOutageMs)
+    {
+      stats.maxOutageMs = stats.lastOutageMs;
+    }
+    outageMillis = 0;
+    Serial.printf("WiFi outage: %lu ms\n", stats.lastOutageMs);
+  }
+
+  if (link->rssiFiltered >= WIFI_ROAM_RSSI_THRESHOLD || monitor.isScanning()) // filtered, a single dip does not trigger a scan
+  {
+    return;
+  }
+  if (roamMillis != 0 && now - roamMillis < WIFI_ROAM_HOLD_TIME)
+  {
+    return; // give the new AP time, no ping-pong between two weak APs
+  }
+  if (scanMillis == 0 || now - scanMillis >= WIFI_ROAM_SCAN_INTERVAL)
+  {
+    scanMillis = now;
+    stats.scans++;
+    monitor.requestScan(); // the results arrive in scanDone()
+  }
+}
+
+/**
+ * @brief Diese Methode übernimmt die Access Points der bekannten Netzwerke aus einem abgeschlossenen Scan
+ * in die Tabelle und wechselt bei Bedarf zum besten Access Point. Sie wird vom Scan Handler des
+ * @ref wio_link_monitor aufgerufen, die Resultate werden aus dem Scan Snapshot von @ref wio_wifi gelesen.
+ *
+ * @param found Anzahl Netzwerke im Snapshot
+ */
+void wio_roaming::scanDone(int found)
+{
+  unsigned long now = millis();
+
+  for (int i = 0; i < found; i++)
+  {
+    const wifi_scan_entry_t *entry = wifi.getScanResult(i);
+    int network = wifi.findNetwork(entry->ssid);
+    if (network >= 0)
+    {
+      store(network, entry->bssid, entry->rssi, entry->channel, now);
+    }
+  }
+  evaluate();
+}
+
+/**
+ * @brief Diese Methode gibt die Scan Tabelle zurück.
+ *
+ * @return const wifi_ap_t* Tabelle mit @ref WIFI_ROAM_TABLE_SIZE Einträgen, freie Einträge haben network = -1
+ */
+const wifi_ap_t *wio_roaming::getTable(void)
+{
+  return table;
+}
+
+/**
+ * @brief Diese Methode gibt die Statistik der Roaming Entscheidungen und Unterbrüche zurück.
+ *
+ * @return const wifi_roam_stats_t* Statistik
+ */
+const wifi_roam_stats_t *wio_roaming::getStatistics(void)
+{
+  return &stats;
+}
+
+/********************************************************************************************
+*** Private Methodes
+********************************************************************************************/
+/**
+ * @brief Diese Methode trägt einen Access Point in die Tabelle ein. Ist die BSSID bereits vorhanden, wird der
+ * Eintrag aktualisiert, sonst wird ein freier oder der älteste Eintrag verwendet.
+ *
+ * @param network Index des bekannten Netzwerkes
+ * @param bssid BSSID
+ * @param rssi Signalstärke in dBm
+ * @param channel WLAN Kanal
+ * @param now Zeitpunkt des Scans
+ */
+void wio_roaming::store(int network, const uint8_t *bssid, int rssi, int channel, unsigned long now)
+{
+  int slot = 0;
+
+  if (bssid == NULL)
+  {
+    return;
+  }
+  for (int i = 0; i < WIFI_ROAM_TABLE_SIZE; i++)
+  {
+    if (table[i].network >= 0 && memcmp(table[i].bssid, bssid, sizeof(table[i].bssid)) == 0)
+    {
+      slot = i;
+      break;
+    }
+    if (table[slot].network >= 0 && (table[i].network < 0 || now - table[i].timestamp > now - table[slot].timestamp))
+    {
+      slot = i; // free or older entry
+    }
+  }
+  memcpy(table[slot].bssid, bssid, sizeof(table[slot].bssid));
+  table[slot].network = network;
+  table[slot].rssi = rssi;
+  table[slot].channel = channel;
+  table[slot].timestamp = now;
+}
+
+/**
+ * @brief Diese Methode wählt den stärksten aktuellen Access Point der Tabelle. Ist dieser um mindestens
+ * @ref WIFI_ROAM_HYSTERESIS dB stärker als die aktuelle Verbindung, wird zu ihm gewechselt.
+ *
+ */
+void wio_roaming::evaluate(void)
+{
+  const wifi_link_t *link = monitor.getLink();
+  unsigned long now = millis();
+  int best = -1;
+
+  if (link->timestamp == 0 || link->rssiFiltered >= WIFI_ROAM_RSSI_THRESHOLD)
+  {
+    return;
+  }
+  if (roamMillis != 0 && now - roamMillis < WIFI_ROAM_HOLD_TIME)
+  {
+    return;
+  }
+  for (int i = 0; i < WIFI_ROAM_TABLE_SIZE; i++)
+  {
+    if (table[i].network < 0 || now - table[i].timestamp > WIFI_ROAM_MAX_AGE)
+    {
+      continue;
+    }
+    if (memcmp(table[i].bssid, link->bssid, sizeof(link->bssid)) == 0)
+    {
+      continue; // current AP
+    }
+    if (table[i].rssi >= link->rssiFiltered + WIFI_ROAM_HYSTERESIS && (best < 0 || table[i].rssi > table[best].rssi))
+    {
+      best = i;
+    }
+  }
+  if (best < 0)
+  {
+    return;
+  }
+
+  const uint8_t *b = table[best].bssid;
+  Serial.printf("Roam to %02X:%02X:%02X:%02X:%02X:%02X ch %d: %d -> %d dBm\n", b[0], b[1], b[2], b[3], b[4], b[5],
+                table[best].channel, link->rssiFiltered, table[best].rssi);
+  stats.roams++;
+  stats.lastFromRssi = link->rssiFiltered;
+  stats.lastToRssi = table[best].rssi;
+  roamMillis = now;
+  wifi.roam(table[best].network, table[best].bssid, table[best].channel);
+}
@@ -0,0 +1,76 @@
+/**
+ * @file wio_roaming.h
+ * @author Fabian Reifler
+ * @brief Roaming zwischen mehreren Access Points der bekannten WLAN Netzwerke anhand der Signalstärke
+ * @version 1.1
+ * @date 19.10.2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef WIO_ROAMING_H
+#define WIO_ROAMING_H
+
+#include <Arduino.h>
+#include "wio_wifi.h"
+#include "wio_link_monitor.h"
+
+/********************************************************************************************
+*** Defines
+********************************************************************************************/
+#define WIFI_ROAM_TABLE_SIZE 8          ///< Anzahl Access Points in der Scan Tabelle
+#define WIFI_ROAM_RSSI_THRESHOLD -70    ///< Unterhalb dieser Signalstärke (dBm, gefiltert) wird nach einem besseren Access Point gesucht
+#define WIFI_ROAM_HYSTERESIS 8          ///< Ein anderer Access Point muss um so viele dB stärker sein
+#define WIFI_ROAM_SCAN_INTERVAL 30000   ///< Minimale Zeit in ms zwischen zwei Scans bei schwachem Signal
+#define WIFI_ROAM_HOLD_TIME 60000       ///< Minimale Zeit in ms zwischen zwei Wechseln
+#define WIFI_ROAM_MAX_AGE 60000         ///< Einträge der Scan Tabelle, die älter sind, werden nicht mehr verwendet
+
+/********************************************************************************************
+*** Datatypes
+********************************************************************************************/
+/// Access Point eines bekannten Netzwerkes aus einem Scan
+typedef struct{
+  uint8_t bssid[6];          ///< BSSID
+  int8_t network;            ///< Index des bekannten Netzwerkes, -1: Eintrag frei
+  int8_t rssi;               ///< Signalstärke in dBm
+  uint8_t channel;           ///< WLAN Kanal
+  unsigned long timestamp;   ///< Zeitpunkt des Scans (millis)
+}wifi_ap_t;
+
+/// Statistik der Roaming Entscheidungen und Verbindungsunterbrüche
+typedef struct{
+  unsigned long scans;       ///< Anzahl wegen schwachem Signal angeforderter Scans
+  unsigned long roams;       ///< Anzahl Wechsel des Access Points
+  int lastFromRssi;          ///< Signalstärke vor dem letzten Wechsel
+  int lastToRssi;            ///< Signalstärke des gewählten Access Points beim letzten Wechsel
+  unsigned long outages;     ///< Anzahl Verbindungsunterbrüche (inkl. Wechsel)
+  unsigned long lastOutageMs;  ///< Dauer des letzten Unterbruches
+  unsigned long maxOutageMs;   ///< Längster Unterbruch
+  unsigned long totalOutageMs; ///< Summe aller Unterbrüche
+}wifi_roam_stats_t;
+
+/********************************************************************************************
+*** Interface description
+********************************************************************************************/
+class wio_roaming
+{
+public:
+  wio_roaming(wio_wifi &wifi, wio_link_monitor &monitor); ///< Konstruktor
+  void handler(void);                                      ///< Signal überwachen und bei Bedarf wechseln, nach jeder Messung aufrufen
+  void scanDone(int found);                                ///< Scan Resultate in die Tabelle übernehmen
+  const wifi_ap_t *getTable(void);                         ///< Scan Tabelle auslesen (WIFI_ROAM_TABLE_SIZE Einträge)
+  const wifi_roam_stats_t *getStatistics(void);            ///< Statistik auslesen
+private:
+  wio_wifi &wifi;                                          ///< WLAN Schnittstelle
+  wio_link_monitor &monitor;                               ///< Überwachung der aktuellen Verbindung
+  wifi_ap_t table[WIFI_ROAM_TABLE_SIZE];                   ///< Scan Tabelle
+  wifi_roam_stats_t stats = {};                            ///< Statistik
+  unsigned long scanMillis = 0;                            ///< Zeitpunkt des letzten angeforderten Scans
+  unsigned long roamMillis = 0;                            ///< Zeitpunkt des letzten Wechsels
+  unsigned long outageMillis = 0;                          ///< Beginn des aktuellen Unterbruches, 0: verbunden
+  void store(int network, const uint8_t *bssid, int rssi, int channel, unsigned long now); ///< Access Point in die Tabelle eintragen
+  void evaluate(void);                                     ///< Besten Access Point wählen und wechseln
+};
+
+#endif
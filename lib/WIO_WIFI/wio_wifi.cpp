@@ -2,8 +2,8 @@
  * @file wio_wifi.cpp
  * @author Beat Sturzenegger
  * @brief IoTB WiFi Bibliothek für das WIO Terminal
- * @version 1.2
- * @date 18.01.2022
+ * @version 1.11
+ * @date 19.10.2026
  * 
  * @copyright Copyright (c) 2022
  * 
@@ -13,12 +13,14 @@
 *** Defines and Constants
 ********************************************************************************************/
 #define DEBUG_ON 0
+#define WIFI_CACHE_MAGIC 0x57494602 ///< Kennung der Cache Datei ("WIF" + Version 2, ohne IP Konfiguration)
 
 /********************************************************************************************
 *** Includes
 ********************************************************************************************/
 #include "wio_wifi.h"
 #include <rpcWiFi.h>
+#include "Seeed_FS.h"     // SD card library, the card is mounted by the display
 
 /********************************************************************************************
 *** Variables
@@ -28,11 +30,30 @@ static IPAddress ip;
 static char logText[50];
 typedef void (*cbLog)  (const char *s, bool b);
 static cbLog cbWiFiLog;
+// event queue, filled by onWiFiEvent() in the context of the rpc task and drained by connectionHandler() in loop()
+static volatile uint8_t eventIds[WIFI_EVENT_QUEUE_LENGTH];
+static volatile unsigned long eventTimes[WIFI_EVENT_QUEUE_LENGTH];
+static volatile uint8_t eventHead = 0;          // written by onWiFiEvent() only
+static volatile uint8_t eventTail = 0;          // written by connectionHandler() only
+static volatile unsigned long eventsDropped = 0;
 
 /********************************************************************************************
 *** Functionprototypes
 ********************************************************************************************/
 void onWiFiEvent(WiFiEvent_t event);
+static void logWiFiEvent(WiFiEvent_t event);
+
+/**
+ * @brief Gleitender Mittelwert einer Verbindungsdauer
+ *
+ * @param avg Bisheriger Mittelwert, 0: noch kein Wert
+ * @param value Neuer Wert
+ * @return unsigned long Neuer Mittelwert
+ */
+static unsigned long connectAverage(unsigned long avg, unsigned long value)
+{
+  return avg == 0 ? value : avg - avg / 4 + value / 4;
+}
 
 /********************************************************************************************
 *** Constructor
@@ -53,75 +74,332 @@ wio_wifi::wio_wifi(void (&func)(const char *, bool b))
 ********************************************************************************************/
 
 /**
- * @brief Diese Methode setzt die Wifi-Parameter und stellt eine Verbindung zum Access Point her.
+ * @brief Diese Methode setzt die Wifi-Parameter und startet die Verbindung zum Access Point.
+ * @note Die Methode blockiert nicht. Der Verbindungsaufbau (Verbindung, DHCP, Wiederholungen) wird
+ * von @ref connectionHandler() weitergeführt, welcher im loop() aufgerufen werden muss.
  * 
  */
 void wio_wifi::initWifi(void)
 {
   (*cbWiFiLog)("Start WiFi Init", false);   // write to the log
 
-  if(DEBUG_ON){
-    WiFi.onEvent(onWiFiEvent);
-  }
+  WiFi.onEvent(onWiFiEvent); // events are the primary source of the connection state
   
   WiFi.disconnect(true,false);
   WiFi.mode(WIFI_STA);
   WiFi.setAutoConnect(false);
 
-  sprintf(logText, "- Connecting to %s", ssid);   // write to the log 
+  networkCount = 0;
+  addNetwork(ssid, password); // preferred network
+  parseNetworkList(wifi_fallback_networks);
+  networkIndex = 0;
+  networksTried = 0;
+  if (networkCount > 1)
+  {
+    sprintf(logText, "- %d fallback networks", networkCount - 1); // write to the log
+    (*cbWiFiLog)(logText, false);
+  }
+
+  loadCache(); // may select the network of the last connection
+  snprintf(logText, sizeof(logText), "- Connecting to %s", getSSID());   // write to the log 
   (*cbWiFiLog)(logText, false);
 
-  Serial.println(ssid);                     // print ssid to SerialPort
-  WiFi.begin(ssid, password);
+  Serial.println(getSSID());                // print ssid to SerialPort
+  if (cacheValid)
+  {
+    (*cbWiFiLog)("- Fast connect (cached AP)", false);   // write to the log
+  }
+  beginMillis = millis();
+  begin();
+}
+
+/**
+ * @brief Diese Methode führt den Verbindungsaufbau weiter. Sie blockiert nicht und muss in jedem Durchlauf von loop() aufgerufen werden.
+ * - Die WiFi Events (GOT_IP, STA_DISCONNECTED, LOST_IP) aus der Warteschlange bestimmen den Zustand, ein Abbruch wird
+ *   dadurch innerhalb eines Durchlaufes erkannt und dem Handler von @ref setLinkHandler() gemeldet.
+ * - Der Status wird nur alle @ref WIFI_STATUS_POLL_INTERVAL abgefragt, als Absicherung gegen verlorene Events.
+ * - Nach @ref WIFI_CONNECT_TIMEOUT ohne Verbindung wird der Versuch abgebrochen und nach @ref WIFI_RETRY_DELAY wiederholt.
+ * - Geht die Verbindung verloren, wird sofort ein neuer Versuch gestartet.
+ * 
+ * @return int Zustand des Verbindungsaufbaus, siehe @ref wifi_state_e
+ */
+int wio_wifi::connectionHandler(void)
+{
+  unsigned long now = millis();
+  bool poll = now - pollMillis >= WIFI_STATUS_POLL_INTERVAL;
+
+  while (eventTail != eventHead)
+  {
+    uint8_t tail = eventTail;
+    handleEvent(eventIds[tail], eventTimes[tail], now);
+    eventTail = (tail + 1) % WIFI_EVENT_QUEUE_LENGTH;
+  }
+  if (eventsDropped != eventStats.dropped) // the queue overflowed, the state may be stale
+  {
+    eventStats.dropped = eventsDropped;
+    poll = true;
+  }
+  if (poll)
+  {
+    pollMillis = now;
+  }
 
-  while (WiFi.status() != WL_CONNECTED)  // do begin WiFi connection until connected
+  switch (state)
   {
-    delay(500);
-    Serial.println("try again to connect WiFi..");   // print to SerialPort
-    (*cbWiFiLog)("try again to connect WiFi..", false);   // write to the log 
-    (*cbWiFiLog)(logText, false);
-    WiFi.begin(ssid, password);
+  case WIFI_STATE_CONNECTING:
+    // GOT_IP normally ends this state, the status is only read as a safety check and before giving up
+    if ((poll || now - stateMillis >= (fastAttempt ? WIFI_FAST_CONNECT_TIMEOUT : WIFI_CONNECT_TIMEOUT)) && WiFi.status() == WL_CONNECTED)
+    {
+      linkUp(now);
+    }
+    else if (fastAttempt && now - stateMillis >= WIFI_FAST_CONNECT_TIMEOUT)
+    {
+      // the cached AP is gone or the channel changed: fall back to scan and DHCP right away
+      Serial.println("Fast connect failed, full connect");
+      (*cbWiFiLog)("- Fast connect failed", false);       // write to the log
+      stats.fastFailed++;
+      cacheValid = false; // rewritten after the next successful connect
+      WiFi.disconnect(true,false);
+      beginFull();
+    }
+    else if (now - stateMillis >= WIFI_CONNECT_TIMEOUT)
+    {
+      WiFi.disconnect(true,false);
+      networksTried++;
+      if (networkCount > 1)
+      {
+        networkIndex = (networkIndex + 1) % networkCount; // next known network
+      }
+      if (networksTried < networkCount)
+      {
+        snprintf(logText, sizeof(logText), "- Trying %s", getSSID());   // write to the log
+        (*cbWiFiLog)(logText, false);
+        Serial.println(logText);
+        beginFull(); // try the next network right away, wait only after a whole round
+        break;
+      }
+      networksTried = 0;
+      Serial.println("try again to connect WiFi..");        // print to SerialPort
+      (*cbWiFiLog)("try again to connect WiFi..", false);   // write to the log 
+      state = WIFI_STATE_BACKOFF;
+      stateMillis = now;
+    }
+    break;
+
+  case WIFI_STATE_BACKOFF:
+    if (now - stateMillis >= WIFI_RETRY_DELAY)
+    {
+      begin();
+    }
+    break;
+
+  case WIFI_STATE_CONNECTED:
+    if (poll && WiFi.status() != WL_CONNECTED) // the disconnect event got lost
+    {
+      eventStats.polledDrops++;
+      linkLost(now);
+    }
+    break;
+
+  default: // WIFI_STATE_IDLE, initWifi() not called yet
+    break;
   }
-  (*cbWiFiLog)("- Connected", false);       // write to the log
+  return state;
 }
 
 /**
- * @brief Diese Methode verbindet sich mit dem Access Point
+ * @brief Diese Methode gibt den Zustand des Verbindungsaufbaus zurück, ohne den Status abzufragen.
+ * 
+ * @return int Zustand, siehe @ref wifi_state_e
+ */
+int wio_wifi::getState(void)
+{
+  return state;
+}
+
+/**
+ * @brief Diese Methode gibt die Dauer des letzten Verbindungsaufbaus zurück, vom Start bis zur IP Adresse,
+ * inklusive aller Wiederholungen.
+ * 
+ * @return unsigned long Dauer in ms, 0: noch nie verbunden
+ */
+unsigned long wio_wifi::getConnectTime(void)
+{
+  return connectTime;
+}
+
+/**
+ * @brief Diese Methode gibt die Anzahl gestarteter Verbindungsversuche zurück (schnelle und vollständige).
+ * Die Differenz zwischen zwei Zeitpunkten ergibt die Anzahl Versuche bis zur Wiederherstellung einer Verbindung.
+ * 
+ * @return unsigned long Anzahl Versuche seit dem Start
+ */
+unsigned long wio_wifi::getConnectAttempts(void)
+{
+  return connectAttempts;
+}
+
+/**
+ * @brief Diese Methode gibt die Statistik der Verbindungsaufbauten zurück. Damit kann die Dauer
+ * schneller Verbindungen (BSSID und Kanal aus dem Cache) mit vollständigen Verbindungen verglichen werden.
+ * 
+ * @return const wifi_connect_stats_t* Statistik
+ */
+const wifi_connect_stats_t *wio_wifi::getConnectStatistics(void)
+{
+  return &stats;
+}
+
+/**
+ * @brief Diese Methode löscht die gespeicherten Verbindungsdaten, z.B. nach einem Wechsel des Netzwerkes.
+ * Der nächste Verbindungsaufbau erfolgt vollständig mit Scan und DHCP.
+ * 
+ */
+void wio_wifi::clearCache(void)
+{
+  cacheValid = false;
+  SD.remove(WIFI_CACHE_FILE);
+}
+
+/**
+ * @brief Diese Methode gibt die Anzahl bekannter Netzwerke zurück (ssid und wifi_fallback_networks aus secrets.h).
+ * 
+ * @return int Anzahl Netzwerke
+ */
+int wio_wifi::getNetworkCount(void)
+{
+  return networkCount;
+}
+
+/**
+ * @brief Diese Methode sucht ein bekanntes Netzwerk anhand der SSID.
+ * 
+ * @param name SSID
+ * @return int Index des Netzwerkes oder -1, wenn das Netzwerk nicht bekannt ist
+ */
+int wio_wifi::findNetwork(const char *name)
+{
+  for (int i = 0; i < networkCount; i++)
+  {
+    if (strcmp(networks[i].ssid, name) == 0)
+    {
+      return i;
+    }
+  }
+  return -1;
+}
+
+/**
+ * @brief Diese Methode wechselt direkt zu einem bestimmten Access Point (Roaming). Innerhalb desselben Netzwerkes
+ * bleibt die IP Konfiguration erhalten, bei einem anderen Netzwerk wird DHCP verwendet.
+ * Schlägt der Wechsel fehl, wird wie beim schnellen Verbindungsaufbau ein vollständiger Aufbau gestartet.
+ * 
+ * @param network Index des bekannten Netzwerkes, siehe @ref findNetwork()
+ * @param bssid BSSID des Access Points
+ * @param channel WLAN Kanal des Access Points
+ */
+void wio_wifi::roam(int network, const uint8_t *bssid, int32_t channel)
+{
+  if (network < 0 || network >= networkCount)
+  {
+    return;
+  }
+  if (network != networkIndex || !cacheValid)
+  {
+    memset(&cache, 0, sizeof(cache)); // other network: DHCP
+    leaseValid = false;
+    cache.magic = WIFI_CACHE_MAGIC;
+    strncpy(cache.ssid, networks[network].ssid, sizeof(cache.ssid) - 1);
+  }
+  networkIndex = network;
+  memcpy(cache.bssid, bssid, sizeof(cache.bssid));
+  cache.channel = channel;
+  cacheValid = true;
+
+  beginMillis = millis();
+  WiFi.disconnect(true,false);
+  begin();
+}
+
+/**
+ * @brief Diese Methode setzt den Handler, der bei jedem Zustandswechsel der Verbindung (verbunden / unterbrochen)
+ * aufgerufen wird, z.B. um die MQTT Verbindung sofort abzubauen.
+ * @note Der Handler wird aus @ref connectionHandler() aufgerufen, also im Kontext von loop() und nicht im
+ * Kontext der WiFi Events.
+ * 
+ * @param handler Funktion, NULL: kein Handler
+ */
+void wio_wifi::setLinkHandler(wifi_link_handler_t handler)
+{
+  linkHandlerCb = handler;
+}
+
+/**
+ * @brief Diese Methode schaltet den Stromsparmodus des Funkmoduls ein oder aus. Im Stromsparmodus (Modem Sleep)
+ * schläft der Funk zwischen den Beacons des Access Points, eingehende Pakete werden dadurch verzögert.
+ * @note Die Einstellung gilt für die aktuelle Verbindung, siehe @ref wio_power_policy.
+ * 
+ * @param enable true: Modem Sleep, false: volle Leistung
+ * @return true Die Einstellung wurde übernommen
+ * @return false Das Funkmodul hat die Einstellung abgelehnt
+ */
+bool wio_wifi::setPowerSave(bool enable)
+{
+  return WiFi.setSleep(enable);
+}
+
+/**
+ * @brief Diese Methode gibt die Statistik der WiFi Events zurück (Anzahl, verlorene Events, Verzögerung bis zur Verarbeitung).
+ * 
+ * @return const wifi_event_stats_t* Statistik
+ */
+const wifi_event_stats_t *wio_wifi::getEventStatistics(void)
+{
+  return &eventStats;
+}
+
+/**
+ * @brief Diese Methode verbindet sich mit dem Access Point.
+ * @note Läuft bereits ein Verbindungsaufbau, wird dieser nicht unterbrochen.
  * 
  */
 void wio_wifi::reconnect(void)
 {
+  if (state == WIFI_STATE_CONNECTING || state == WIFI_STATE_BACKOFF)
+  {
+    return; // the connection handler is already retrying
+  }
   Serial.println("Reconnect WiFi");
+  beginMillis = millis();
   WiFi.disconnect(true,false);
-  WiFi.begin(ssid, password);
+  begin();
 }
 
 /**
- * @brief Diese Methode gibt die Signalstärke (RSSI) zurück.
- * @note Es wird Empfohlen vorher das Netzwerk zu scannen mit @ref scanNetwork() , damit man 
- * herausfinden kann welcher Indexnummer die verbundene Verbindung hat.
+ * @brief Diese Methode gibt die Signalstärke (RSSI) eines gefundenen Netzwerkes zurück.
+ * @note Der Wert stammt aus dem Scan Snapshot (@ref takeScanSnapshot()), es wird keine Anfrage an den WLAN Chip gesendet.
+ * Für die Signalstärke der aktuellen Verbindung ist kein Scan nötig, siehe @ref wio_link_monitor.
  * 
- * @param index Indexnummer des Netzwerkes
- * @return int RSSI als integer Wert
+ * @param index Indexnummer des Netzwerkes im Snapshot
+ * @return int RSSI als integer Wert, -99: ungültiger Index
  */
 int wio_wifi::measureRSSI(int index)
 {
-  long rssi = WiFi.RSSI(index);   // read rssi
-  return (int)rssi;               // parse and return rssi
+  const wifi_scan_entry_t *entry = getScanResult(index);
+  return entry != NULL ? entry->rssi : -99;
 }
 
 /**
- * @brief Diese Methode liest den WLAn Kanal aus.
- * @note Es wird Empfohlen vorher das Netzwerk zu scannen mit @ref scanNetwork() , damit man 
- * herausfinden kann welcher Indexnummer die verbundene Verbindung hat.
+ * @brief Diese Methode liest den WLAN Kanal eines gefundenen Netzwerkes aus.
+ * @note Der Wert stammt aus dem Scan Snapshot (@ref takeScanSnapshot()).
  * 
- * @param index Indexnummer des Netzwerkes
- * @return int WLAN Kanal als integer Wert
+ * @param index Indexnummer des Netzwerkes im Snapshot
+ * @return int WLAN Kanal als integer Wert, 0: ungültiger Index
  */
 int wio_wifi::readChannel(int index)
 {
-  long ch = WiFi.channel(index);    // read channel
-  return (int)ch;                   // parse and return channel
+  const wifi_scan_entry_t *entry = getScanResult(index);
+  return entry != NULL ? entry->channel : 0;
 }
 
 /**
@@ -136,26 +414,135 @@ void wio_wifi::scanNetwork(void)
 
 /**
  * @brief Diese Methode gibt den aktuellen Scan Status zurück oder, bei abgeschlossenem Scan, die Anzahl der gefundenen Netzwerke zurück.
+ * @note Ist der Scan abgeschlossen, werden die Resultate in den Snapshot kopiert und im WLAN Chip gelöscht. Weitere
+ * Aufrufe geben danach -2 zurück, der Snapshot bleibt bis zum nächsten Scan erhalten (@ref getScanCount()).
  * 
  * @return int Anzahl gefundene Netzwerke oder Scan Status
  * - -2: Scan wurde noch nicht getriggert/ausgelöst
  * - -1: Scan ist noch nicht abgeschlossen
- * - >0: Anzahl der gefundenen Netzwerke
+ * - >=0: Anzahl der gefundenen Netzwerke im Snapshot
  */
 int wio_wifi::getNetworksFound(void)
 {
-  return WiFi.scanComplete();    // check if scan is completed, if complete
+  int found = WiFi.scanComplete();    // check if scan is completed, if complete
+  if (found < 0)
+  {
+    return found;
+  }
+  return takeScanSnapshot();
+}
+
+/**
+ * @brief Diese Methode gibt, anhand der Indexnummer im Scan Snapshot, den SSID Namen zurück.
+ * 
+ * @param index Indexnummer des Netzwerkes im Snapshot
+ * @return const char* SSID-Namen als String, gültig bis zum nächsten Snapshot; "" bei ungültigem Index
+ */
+const char *wio_wifi::getScannedSSID(int index)
+{
+  const wifi_scan_entry_t *entry = getScanResult(index);
+  return entry != NULL ? entry->ssid : "";
+}
+
+/**
+ * @brief Diese Methode kopiert die Resultate eines abgeschlossenen Scans in einem Durchgang in den Snapshot
+ * und löscht sie danach im WLAN Chip. Pro Netzwerk wird nur eine Abfrage (getNetworkInfo) benötigt, alle weiteren
+ * Abfragen werden aus dem RAM beantwortet. Die Netzwerke sind nach Signalstärke sortiert (stärkstes zuerst),
+ * bei mehr als @ref WIFI_SCAN_MAX_RESULTS Netzwerken werden die schwächsten verworfen.
+ * 
+ * @return int Anzahl Netzwerke im Snapshot oder -1, wenn kein abgeschlossener Scan vorhanden ist
+ */
+int wio_wifi::takeScanSnapshot(void)
+{
+  int found = WiFi.scanComplete();
+  if (found < 0)
+  {
+    return -1;
+  }
+
+  scanCount = 0;
+  for (int i = 0; i < found; i++)
+  {
+    String name;
+    uint8_t encryption;
+    int32_t rssi;
+    uint8_t *bssid;
+    int32_t channel;
+    if (!WiFi.getNetworkInfo(i, name, encryption, rssi, bssid, channel))
+    {
+      continue;
+    }
+
+    // insertion sort by RSSI, the weakest entry drops out when the snapshot is full
+    int pos = scanCount;
+    while (pos > 0 && scanResults[pos - 1].rssi < rssi)
+    {
+      pos--;
+    }
+    if (pos >= WIFI_SCAN_MAX_RESULTS)
+    {
+      continue;
+    }
+    int last = scanCount < WIFI_SCAN_MAX_RESULTS ? scanCount : WIFI_SCAN_MAX_RESULTS - 1;
+    memmove(&scanResults[pos + 1], &scanResults[pos], (last - pos) * sizeof(scanResults[0]));
+    if (scanCount < WIFI_SCAN_MAX_RESULTS)
+    {
+      scanCount++;
+    }
+
+    wifi_scan_entry_t *entry = &scanResults[pos];
+    strncpy(entry->ssid, name.c_str(), sizeof(entry->ssid) - 1);
+    entry->ssid[sizeof(entry->ssid) - 1] = '\0';
+    if (bssid != NULL)
+    {
+      memcpy(entry->bssid, bssid, sizeof(entry->bssid));
+    }
+    else
+    {
+      memset(entry->bssid, 0, sizeof(entry->bssid));
+    }
+    entry->rssi = rssi;
+    entry->channel = channel;
+    entry->encryption = encryption;
+  }
+  WiFi.scanDelete(); // the results live in the snapshot now
+  scanTime = millis();
+  return scanCount;
+}
+
+/**
+ * @brief Diese Methode gibt die Anzahl Netzwerke im Scan Snapshot zurück.
+ * 
+ * @return int Anzahl Netzwerke, 0: noch kein Scan
+ */
+int wio_wifi::getScanCount(void)
+{
+  return scanCount;
+}
+
+/**
+ * @brief Diese Methode gibt ein Netzwerk aus dem Scan Snapshot zurück.
+ * 
+ * @param index Indexnummer im Snapshot (0: stärkstes Netzwerk)
+ * @return const wifi_scan_entry_t* Netzwerk, NULL bei ungültigem Index
+ */
+const wifi_scan_entry_t *wio_wifi::getScanResult(int index)
+{
+  if (index < 0 || index >= scanCount)
+  {
+    return NULL;
+  }
+  return &scanResults[index];
 }
 
 /**
- * @brief Diese Methode gibt, anhand der Indexnummer der gescannten Netzwerke, den SSID Namen zurück.
+ * @brief Diese Methode gibt den Zeitpunkt des Scan Snapshots zurück.
  * 
- * @param index Indexnummer des Netzwerkes
- * @return char* SSID-Namen als String
+ * @return unsigned long Zeitpunkt (millis), 0: noch kein Scan
  */
-char *wio_wifi::getScannedSSID(int index)
+unsigned long wio_wifi::getScanTime(void)
 {
-  return (char *)WiFi.SSID(index).c_str();
+  return scanTime;
 }
 
 /**
@@ -165,16 +552,21 @@ char *wio_wifi::getScannedSSID(int index)
  */
 const char *wio_wifi::getSSID()
 {
-  return ssid;
+  if (networkCount == 0) // initWifi() not called yet
+  {
+    return ssid;
+  }
+  return networks[networkIndex].ssid;
 }
 
 /**
- * @brief Diese Methode löscht die Scan Resultate.
+ * @brief Diese Methode löscht die Scan Resultate im WLAN Chip und den Snapshot.
  * 
  */
 void wio_wifi::deleteScanResults()
 {
   WiFi.scanDelete();
+  scanCount = 0;
 }
 
 /********************************************************************************************
@@ -182,11 +574,328 @@ void wio_wifi::deleteScanResults()
 ********************************************************************************************/
 
 /**
- * @brief Diese Funktion reagiert auf WiFi Events und gibt diesen Event auf das Log und SerialPort aus.
+ * @brief Diese Methode startet einen Verbindungsversuch. Sind Daten der letzten Verbindung vorhanden, wird
+ * direkt mit diesem Access Point auf dem gespeicherten Kanal verbunden (ohne Scan), optional mit der
+ * IP Konfiguration des letzten DHCP (ohne DHCP). Diese liegt nur im RAM, wird also nur innerhalb desselben Starts
+ * verwendet, und höchstens @ref WIFI_CACHE_LEASE_TIME lang, sonst könnte die Adresse bereits neu vergeben sein.
+ * 
+ */
+void wio_wifi::begin(void)
+{
+  leaveConnected();
+  if (!cacheValid)
+  {
+    beginFull();
+    return;
+  }
+  leaseUsed = WIFI_CACHE_LEASE && leaseValid && millis() - leaseMillis < WIFI_CACHE_LEASE_TIME;
+  if (leaseUsed)
+  {
+    WiFi.config(IPAddress(lease.ip), IPAddress(lease.gateway), IPAddress(lease.subnet), IPAddress(lease.dns));
+  }
+  WiFi.begin(networks[networkIndex].ssid, networks[networkIndex].password, cache.channel, cache.bssid);
+  connectAttempts++;
+  fastAttempt = true;
+  state = WIFI_STATE_CONNECTING;
+  stateMillis = millis();
+}
+
+/**
+ * @brief Diese Methode startet einen vollständigen Verbindungsversuch mit Scan über alle Kanäle und DHCP.
+ * 
+ */
+void wio_wifi::beginFull(void)
+{
+  leaveConnected();
+  if (leaseUsed)
+  {
+    WiFi.config(IPAddress(), IPAddress(), IPAddress()); // back to DHCP
+    leaseUsed = false;
+  }
+  WiFi.begin(networks[networkIndex].ssid, networks[networkIndex].password);
+  connectAttempts++;
+  fastAttempt = false;
+  state = WIFI_STATE_CONNECTING;
+  stateMillis = millis();
+}
+
+/**
+ * @brief Diese Methode schliesst einen erfolgreichen Verbindungsaufbau ab und meldet die Verbindung dem Handler.
+ * 
+ * @param now Aktuelle Zeit (millis)
+ */
+void wio_wifi::linkUp(unsigned long now)
+{
+  connected(now);
+  networksTried = 0;
+  state = WIFI_STATE_CONNECTED;
+  stateMillis = now;
+  ip = WiFi.localIP();
+  sprintf(logText, "- Connected after %lu ms%s", connectTime, fastAttempt ? " (fast)" : "");   // write to the log
+  (*cbWiFiLog)(logText, false);
+  Serial.println(logText);
+  if (linkHandlerCb != NULL)
+  {
+    linkHandlerCb(true);
+  }
+}
+
+/**
+ * @brief Diese Methode meldet den Abbruch der Verbindung dem Handler und startet sofort einen neuen Versuch.
+ * 
+ * @param now Aktuelle Zeit (millis)
+ */
+void wio_wifi::linkLost(unsigned long now)
+{
+  Serial.println("Reconnect WiFi");
+  beginMillis = now;
+  leaveConnected(); // notify before the rpc calls of the new attempt
+  WiFi.disconnect(true,false);
+  begin();
+}
+
+/**
+ * @brief Diese Methode verlässt den Zustand @ref WIFI_STATE_CONNECTED und meldet den Abbruch dem Handler. Sie wird
+ * vor jedem Verbindungsversuch aufgerufen, damit auch ein Wechsel mit @ref roam() oder @ref reconnect() gemeldet wird.
+ * 
+ */
+void wio_wifi::leaveConnected(void)
+{
+  if (state != WIFI_STATE_CONNECTED)
+  {
+    return;
+  }
+  state = WIFI_STATE_CONNECTING;
+  if (linkHandlerCb != NULL)
+  {
+    linkHandlerCb(false);
+  }
+}
+
+/**
+ * @brief Diese Methode verarbeitet ein WiFi Event aus der Warteschlange.
+ * - @p SYSTEM_EVENT_STA_GOT_IP: Der laufende Verbindungsaufbau ist abgeschlossen (wird mit dem Status bestätigt,
+ *   ein verspätetes Event eines abgebrochenen Versuches wird so ignoriert).
+ * - @p SYSTEM_EVENT_STA_DISCONNECTED, @p SYSTEM_EVENT_STA_LOST_IP: Die Verbindung ist verloren.
+ * - @p SYSTEM_EVENT_STA_CONNECTED: Mit dem Access Point verbunden, nutzbar ist die Verbindung erst mit der IP Adresse.
+ * 
+ * @param event Event, siehe @p WiFiEvent_t
+ * @param timestamp Zeitpunkt des Events (millis)
+ * @param now Aktuelle Zeit (millis)
+ */
+void wio_wifi::handleEvent(int event, unsigned long timestamp, unsigned long now)
+{
+  eventStats.events++;
+  eventStats.lastLatencyMs = now - timestamp;
+  if (eventStats.lastLatencyMs > eventStats.maxLatencyMs)
+  {
+    eventStats.maxLatencyMs = eventStats.lastLatencyMs;
+  }
+  if (DEBUG_ON)
+  {
+    logWiFiEvent((WiFiEvent_t)event);
+  }
+
+  switch (event)
+  {
+  case SYSTEM_EVENT_STA_GOT_IP:
+    if (state == WIFI_STATE_CONNECTING && WiFi.status() == WL_CONNECTED)
+    {
+      linkUp(now);
+    }
+    break;
+  case SYSTEM_EVENT_STA_DISCONNECTED:
+  case SYSTEM_EVENT_STA_LOST_IP:
+    if (state == WIFI_STATE_CONNECTED) // while connecting, a disconnect is the result of our own WiFi.disconnect()
+    {
+      linkLost(now);
+    }
+    break;
+  default:
+    break;
+  }
+}
+
+/**
+ * @brief Diese Methode führt die Statistik nach einem erfolgreichen Verbindungsaufbau nach und speichert
+ * BSSID und Kanal. Die SD Karte wird nur beschrieben, wenn sich die Daten geändert haben. Eine über DHCP bezogene
+ * IP Konfiguration wird nur im RAM gehalten (siehe @ref WIFI_CACHE_LEASE).
+ * 
+ * @param now Aktuelle Zeit (millis)
+ */
+void wio_wifi::connected(unsigned long now)
+{
+  connectTime = now - beginMillis;
+  if (fastAttempt)
+  {
+    stats.fast++;
+    stats.fastAvgMs = connectAverage(stats.fastAvgMs, connectTime);
+  }
+  else
+  {
+    stats.full++;
+    stats.fullAvgMs = connectAverage(stats.fullAvgMs, connectTime);
+  }
+  stats.lastFast = fastAttempt;
+  if (!leaseUsed)
+  {
+    leaseMillis = now; // address assigned by DHCP, the lease starts now
+    lease.ip = (uint32_t)WiFi.localIP();
+    lease.gateway = (uint32_t)WiFi.gatewayIP();
+    lease.subnet = (uint32_t)WiFi.subnetMask();
+    lease.dns = (uint32_t)WiFi.dnsIP(0);
+    leaseValid = true;
+  }
+
+  wifi_cache_t fresh;
+  memset(&fresh, 0, sizeof(fresh)); // no padding garbage, the struct is compared and written as a block
+  fresh.magic = WIFI_CACHE_MAGIC;
+  strncpy(fresh.ssid, getSSID(), sizeof(fresh.ssid) - 1);
+  uint8_t *bssid = WiFi.BSSID();
+  if (bssid == NULL)
+  {
+    return;
+  }
+  memcpy(fresh.bssid, bssid, sizeof(fresh.bssid));
+  fresh.channel = WiFi.channel();
+
+  if (!cacheValid || memcmp(&fresh, &cache, sizeof(cache)) != 0)
+  {
+    cache = fresh;
+    saveCache();
+  }
+  cacheValid = true;
+}
+
+/**
+ * @brief Diese Methode fügt ein Netzwerk zur Liste der bekannten Netzwerke hinzu.
+ * 
+ * @param name SSID
+ * @param pass Passwort
+ * @return int Index des Netzwerkes oder -1, wenn die Liste voll oder die Daten zu lang sind
+ */
+int wio_wifi::addNetwork(const char *name, const char *pass)
+{
+  if (networkCount >= WIFI_MAX_NETWORKS || strlen(name) >= sizeof(networks[0].ssid) || strlen(pass) >= sizeof(networks[0].password))
+  {
+    return -1;
+  }
+  strcpy(networks[networkCount].ssid, name);
+  strcpy(networks[networkCount].password, pass);
+  return networkCount++;
+}
+
+/**
+ * @brief Diese Methode fügt die Netzwerke einer Liste hinzu.
+ * @note SSID und Passwort werden beim ersten ':' getrennt, die Einträge mit ','. Das Passwort darf deshalb kein ',' enthalten.
+ * 
+ * @param list Liste im Format "ssid:password,ssid:password"
+ */
+void wio_wifi::parseNetworkList(const char *list)
+{
+  char entry[sizeof(wifi_network_t)]; // ssid, ':' and password
+
+  while (list && *list)
+  {
+    while (*list == ' ')
+    {
+      list++;
+    }
+    const char *end = strchr(list, ',');
+    unsigned int len = end ? (unsigned int)(end - list) : strlen(list);
+    if (len > 0 && len < sizeof(entry))
+    {
+      memcpy(entry, list, len);
+      entry[len] = '\0';
+      char *colon = strchr(entry, ':');
+      const char *pass = "";
+      if (colon)
+      {
+        *colon = '\0';
+        pass = colon + 1;
+      }
+      if (addNetwork(entry, pass) < 0)
+      {
+        Serial.print("Invalid WiFi network: ");
+        Serial.println(entry);
+      }
+    }
+    list = end ? end + 1 : list + len;
+  }
+}
+
+/**
+ * @brief Diese Methode liest die Daten der letzten Verbindung von der SD Karte. Die Daten sind nur gültig,
+ * wenn sie zu einem bekannten Netzwerk gehören, dieses wird dann als aktuelles Netzwerk gewählt.
+ * 
+ */
+void wio_wifi::loadCache(void)
+{
+  cacheValid = false;
+  File f = SD.open(WIFI_CACHE_FILE, FILE_READ);
+  if (!f) // no SD card or no cache file yet
+  {
+    return;
+  }
+  size_t len = f.read(&cache, sizeof(cache));
+  f.close();
+  if (len != sizeof(cache) || cache.magic != WIFI_CACHE_MAGIC || cache.channel <= 0)
+  {
+    return;
+  }
+  cache.ssid[sizeof(cache.ssid) - 1] = '\0';
+  int network = findNetwork(cache.ssid); // the data is only valid for a known network
+  if (network >= 0)
+  {
+    networkIndex = network;
+    cacheValid = true;
+  }
+}
+
+/**
+ * @brief Diese Methode schreibt die Daten der letzten Verbindung auf die SD Karte.
+ * 
+ */
+void wio_wifi::saveCache(void)
+{
+  SD.remove(WIFI_CACHE_FILE); // FILE_WRITE may append, start with an empty file
+  File f = SD.open(WIFI_CACHE_FILE, FILE_WRITE);
+  if (!f) // no SD card
+  {
+    return;
+  }
+  f.write((const uint8_t *)&cache, sizeof(cache));
+  f.close();
+}
+
+/**
+ * @brief Diese Funktion reagiert auf WiFi Events und legt sie mit dem Zeitpunkt in die Warteschlange, verarbeitet
+ * werden sie in @ref wio_wifi::connectionHandler().
+ * @note Sie wird im Kontext des RPC Tasks aufgerufen und darf deshalb weder das Log noch die WiFi Schnittstelle verwenden.
+ * 
+ * @param event Der Event der ausgelöst wurde.
+ */
+void onWiFiEvent(WiFiEvent_t event)
+{
+  uint8_t head = eventHead;
+  uint8_t next = (head + 1) % WIFI_EVENT_QUEUE_LENGTH;
+
+  if (next == eventTail)
+  {
+    eventsDropped++; // queue full, connectionHandler() falls back to polling the status
+    return;
+  }
+  eventIds[head] = (uint8_t)event;
+  eventTimes[head] = millis();
+  eventHead = next;
+}
+
+/**
+ * @brief Diese Funktion gibt einen WiFi Event auf das Log und SerialPort aus (nur mit DEBUG_ON).
  * 
  * @param event Der Event der ausgelöst wurde.
  */
-void onWiFiEvent(WiFiEvent_t event) {
+static void logWiFiEvent(WiFiEvent_t event) {
   switch (event) {
     case SYSTEM_EVENT_WIFI_READY: 
       (*cbWiFiLog)("- WiFi interface ready", false);
@@ -2,8 +2,8 @@
  * @file wio_wifi.h
  * @author Beat Sturzenegger
  * @brief IoTB WiFi Bibliothek für das WIO Terminal
- * @version 1.1
- * @date 18.01.2022
+ * @version 1.10
+ * @date 19.10.2026
  * 
  * @copyright Copyright (c) 2022
  * 
@@ -20,12 +20,90 @@
 // MQTT und WiFI defines
 #define CONNECTED 1    ///< Verbindungsstatus für MQTT and WiFi
 #define DISCONNECTED 0 ///< Verbindungsstatus für MQTT and WiFi
+#define WIFI_CONNECT_TIMEOUT 10000 ///< Maximale Zeit in ms für Verbindung und DHCP, danach wird neu begonnen
+#define WIFI_RETRY_DELAY 2000      ///< Wartezeit in ms nach einem fehlgeschlagenen Verbindungsversuch
+#define WIFI_FAST_CONNECT_TIMEOUT 3000 ///< Maximale Zeit in ms für die direkte Verbindung mit den gespeicherten Daten
+#define WIFI_CACHE_FILE "sys/wifi.bin" ///< Datei auf der SD Karte mit SSID, BSSID und Kanal der letzten Verbindung
+#define WIFI_MAX_NETWORKS 4            ///< Maximale Anzahl bekannter WLAN Netzwerke (secrets.h: ssid und wifi_fallback_networks)
+#define WIFI_SCAN_MAX_RESULTS 16       ///< Anzahl Netzwerke im Scan Snapshot, bei mehr Netzwerken werden die stärksten behalten
+#define WIFI_CACHE_LEASE 0             ///< 1: Die IP Konfiguration des letzten DHCP ohne DHCP wiederverwenden (nur während WIFI_CACHE_LEASE_TIME), 0: nur BSSID und Kanal
+#define WIFI_CACHE_LEASE_TIME 1800000  ///< Maximale Zeit in ms seit dem letzten DHCP, während der die IP Konfiguration wiederverwendet wird (kürzer als die Lease des DHCP Servers)
+#define WIFI_STATUS_POLL_INTERVAL 5000 ///< Intervall in ms der Statusabfrage als Absicherung, Zustandswechsel kommen über die WiFi Events
+#define WIFI_EVENT_QUEUE_LENGTH 16     ///< Anzahl WiFi Events, die zwischen zwei Aufrufen von connectionHandler() gepuffert werden
+
+/********************************************************************************************
+*** Enumerations
+********************************************************************************************/
+/// Zustand des WLAN Verbindungsaufbaus, siehe @ref wio_wifi::connectionHandler()
+typedef enum{
+  WIFI_STATE_IDLE,        ///< initWifi() wurde noch nicht aufgerufen
+  WIFI_STATE_CONNECTING,  ///< Verbindung zum Access Point und DHCP laufen
+  WIFI_STATE_CONNECTED,   ///< Verbunden, IP Adresse erhalten
+  WIFI_STATE_BACKOFF      ///< Warten nach einem fehlgeschlagenen Versuch
+}wifi_state_e;
+
+/********************************************************************************************
+*** Datatypes
+********************************************************************************************/
+/// Bekanntes WLAN Netzwerk
+typedef struct{
+  char ssid[33];          ///< SSID
+  char password[64];      ///< Passwort
+}wifi_network_t;
+
+/// Gefundenes Netzwerk eines Scans, siehe @ref wio_wifi::takeScanSnapshot()
+typedef struct{
+  char ssid[33];          ///< SSID
+  uint8_t bssid[6];       ///< BSSID des Access Points
+  int8_t rssi;            ///< Signalstärke in dBm
+  uint8_t channel;        ///< WLAN Kanal
+  uint8_t encryption;     ///< Verschlüsselung (ENC_TYPE_...)
+}wifi_scan_entry_t;
+
+/// Daten der letzten erfolgreichen Verbindung für den schnellen Verbindungsaufbau
+typedef struct{
+  uint32_t magic;         ///< Kennung und Version der Datei
+  char ssid[33];          ///< SSID, die Daten gelten nur für diese SSID
+  uint8_t bssid[6];       ///< BSSID des Access Points
+  int32_t channel;        ///< WLAN Kanal
+}wifi_cache_t;
+
+/// IP Konfiguration des letzten DHCP, nur im RAM (nach einem Neustart ist unbekannt, ob die Lease noch gilt)
+typedef struct{
+  uint32_t ip;            ///< IP Adresse
+  uint32_t gateway;       ///< Gateway
+  uint32_t subnet;        ///< Subnetzmaske
+  uint32_t dns;           ///< DNS Server
+}wifi_lease_t;
+
+/// Statistik der Verbindungsaufbauten
+typedef struct{
+  unsigned long fast;       ///< Anzahl Verbindungen über BSSID/Kanal aus dem Cache
+  unsigned long full;       ///< Anzahl Verbindungen mit Scan und DHCP
+  unsigned long fastFailed; ///< Anzahl fehlgeschlagener schneller Versuche (danach vollständiger Aufbau)
+  unsigned long fastAvgMs;  ///< Gleitender Mittelwert der Dauer schneller Verbindungen
+  unsigned long fullAvgMs;  ///< Gleitender Mittelwert der Dauer vollständiger Verbindungen (inkl. fehlgeschlagenem schnellen Versuch)
+  bool lastFast;            ///< Die letzte Verbindung war schnell
+}wifi_connect_stats_t;
+
+/// Statistik der WiFi Events
+typedef struct{
+  unsigned long events;        ///< Anzahl verarbeiteter Events
+  unsigned long dropped;       ///< Anzahl verlorener Events (Warteschlange voll), danach wird der Status sofort abgefragt
+  unsigned long polledDrops;   ///< Unterbrüche, die erst von der Statusabfrage erkannt wurden
+  unsigned long lastLatencyMs; ///< Zeit vom letzten Event bis zur Verarbeitung in connectionHandler()
+  unsigned long maxLatencyMs;  ///< Längste Zeit vom Event bis zur Verarbeitung
+}wifi_event_stats_t;
+
+/// Handler für Zustandswechsel der Verbindung, wird aus @ref wio_wifi::connectionHandler() aufgerufen (Parameter: true: verbunden, false: unterbrochen)
+typedef void (*wifi_link_handler_t)(bool up);
 
 /********************************************************************************************
 *** Extern Variables
 ********************************************************************************************/
 extern const char* ssid;        ///< defined in secrets.h
 extern const char* password;    ///< defined in secrets.h
+extern const char* wifi_fallback_networks; ///< defined in secrets.h
 
 /********************************************************************************************
 *** Interface description
@@ -34,7 +112,19 @@ class wio_wifi
 {
   public:
     wio_wifi(void (&)(const char *, bool));   ///< Konstruktor
-    void initWifi(void);                ///< WiFi initialisieren
+    void initWifi(void);                ///< WiFi initialisieren und Verbindungsaufbau starten (nicht blockierend)
+    int connectionHandler(void);        ///< Verbindungsaufbau weiterführen, im loop() aufrufen
+    int getState(void);                 ///< Zustand des Verbindungsaufbaus auslesen
+    unsigned long getConnectTime(void); ///< Dauer des letzten Verbindungsaufbaus in ms
+    unsigned long getConnectAttempts(void); ///< Anzahl gestarteter Verbindungsversuche seit dem Start
+    const wifi_connect_stats_t *getConnectStatistics(void); ///< Statistik schneller und vollständiger Verbindungen
+    void clearCache(void);              ///< Gespeicherte Verbindungsdaten löschen
+    int getNetworkCount(void);          ///< Anzahl bekannter Netzwerke
+    int findNetwork(const char *name);  ///< Index eines bekannten Netzwerkes suchen
+    void roam(int network, const uint8_t *bssid, int32_t channel); ///< Zu einem bestimmten Access Point wechseln
+    void setLinkHandler(wifi_link_handler_t handler); ///< Handler für Zustandswechsel der Verbindung setzen
+    bool setPowerSave(bool enable);     ///< Stromsparmodus (Modem Sleep) ein- oder ausschalten
+    const wifi_event_stats_t *getEventStatistics(void); ///< Statistik der WiFi Events
     int WiFiStatus();                   ///< WiFi Verbindungsstatus auslesen
     void reconnect();                   ///< verbindet sich wieder mit dem WLAN
     void getIP(char *);                 ///< aktuelle IP Adresse auslesen
@@ -44,7 +134,46 @@ class wio_wifi
     int getNetworksFound(void);         ///< Anzahl der gefundenen Netzwerke auslesen
     int measureRSSI(int);               ///< Signalstärke auslesen
     int readChannel(int);               ///< WLAN Kanal auslesen
-    char *getScannedSSID(int index);    ///< SSID des gefunden Netzwerkes auslesen
+    const char *getScannedSSID(int index); ///< SSID des gefunden Netzwerkes auslesen
+    int takeScanSnapshot(void);         ///< Resultate eines abgeschlossenen Scans in den Snapshot kopieren
+    int getScanCount(void);             ///< Anzahl Netzwerke im Snapshot
+    const wifi_scan_entry_t *getScanResult(int index); ///< Netzwerk aus dem Snapshot auslesen
+    unsigned long getScanTime(void);    ///< Zeitpunkt des Snapshots (millis)
+  private:
+    int state = WIFI_STATE_IDLE;        ///< Zustand des Verbindungsaufbaus, siehe @ref wifi_state_e
+    unsigned long stateMillis = 0;      ///< Zeitpunkt des letzten Zustandswechsels
+    unsigned long beginMillis = 0;      ///< Beginn des aktuellen Verbindungsaufbaus (inkl. Wiederholungen)
+    unsigned long connectTime = 0;      ///< Dauer des letzten Verbindungsaufbaus in ms
+    unsigned long connectAttempts = 0;  ///< Anzahl gestarteter Verbindungsversuche
+    unsigned long pollMillis = 0;       ///< Zeitpunkt der letzten Statusabfrage
+    wifi_link_handler_t linkHandlerCb = NULL; ///< Handler für Zustandswechsel der Verbindung
+    wifi_event_stats_t eventStats = {}; ///< Statistik der WiFi Events
+    wifi_cache_t cache;                 ///< Daten der letzten Verbindung
+    bool cacheValid = false;            ///< cache enthält gültige Daten für die aktuelle SSID
+    bool fastAttempt = false;           ///< Der aktuelle Versuch verwendet die Daten aus dem Cache
+    bool leaseUsed = false;             ///< Der aktuelle Versuch verwendet die IP Konfiguration ohne DHCP
+    bool leaseValid = false;            ///< lease enthält eine seit dem Start über DHCP bezogene IP Konfiguration
+    wifi_lease_t lease = {};            ///< IP Konfiguration des letzten DHCP
+    unsigned long leaseMillis = 0;      ///< Zeitpunkt des letzten DHCP
+    wifi_connect_stats_t stats = {};    ///< Statistik der Verbindungsaufbauten
+    wifi_network_t networks[WIFI_MAX_NETWORKS]; ///< Bekannte Netzwerke, Index 0: ssid aus secrets.h
+    wifi_scan_entry_t scanResults[WIFI_SCAN_MAX_RESULTS]; ///< Snapshot des letzten Scans, nach Signalstärke sortiert
+    int scanCount = 0;                  ///< Anzahl Netzwerke im Snapshot
+    unsigned long scanTime = 0;         ///< Zeitpunkt des Snapshots
+    int networkCount = 0;               ///< Anzahl bekannter Netzwerke
+    int networkIndex = 0;               ///< Aktuelles Netzwerk
+    int networksTried = 0;              ///< Anzahl Netzwerke ohne Erfolg in der aktuellen Runde
+    int addNetwork(const char *name, const char *pass); ///< Netzwerk zur Liste hinzufügen
+    void parseNetworkList(const char *list); ///< Netzwerke aus einer Liste "ssid:password,ssid:password" hinzufügen
+    void begin(void);                   ///< Verbindungsversuch starten (schnell, falls Daten im Cache)
+    void beginFull(void);               ///< Vollständigen Verbindungsversuch mit Scan und DHCP starten
+    void connected(unsigned long now);  ///< Statistik nachführen und Cache aktualisieren
+    void linkUp(unsigned long now);     ///< Verbindung hergestellt: Zustand wechseln und Handler aufrufen
+    void linkLost(unsigned long now);   ///< Verbindung verloren: Handler aufrufen und neuen Versuch starten
+    void leaveConnected(void);          ///< Zustand CONNECTED verlassen und Handler aufrufen
+    void handleEvent(int event, unsigned long timestamp, unsigned long now); ///< Ein WiFi Event aus der Warteschlange verarbeiten
+    void loadCache(void);               ///< Cache von der SD Karte lesen
+    void saveCache(void);               ///< Cache auf die SD Karte schreiben
 };
 
 #endif
@@ -2,8 +2,8 @@
  * @file secrets.h
  * @author Beat Sturzenegger / Fabian Reifler
  * @brief Zugangsdaten für die WiFi Verbindung und den MQTT Broker
- * @version 1.1
- * @date 08.03.2023
+ * @version 1.4
+ * @date 19.10.2026
  *
  * @copyright Copyright (c) 2023
  *
@@ -15,12 +15,20 @@
 // WiFi data
 const char *ssid = "";     ///< WLAN SSID
 const char *password = ""; ///< WLAN Password
+const char *wifi_fallback_networks = ""; ///< further WLANs "ssid:password,ssid:password" in order of preference, empty: none
 
 // MQTT data
-const char *default_mqtt_broker = "172.20.1.51"; ///< MQTT Broker URL
+const char *default_mqtt_broker = "172.20.1.51"; ///< MQTT Broker IP address or hostname (names are cached, the broker address can change without reflashing)
 const uint16_t default_mqtt_port = 1883;         ///< port for the Broker
+const char *mqtt_fallback_brokers = "";          ///< further Brokers "host:port,host:port" in order of preference, empty: none
 const char *mqtt_user = "";                     ///< user for the Broker
 const char *mqtt_password = "";        ///< password for the Broker
-const char *mqtt_id = "";                       ///< not used yet
+const char *mqtt_id = "";                       ///< fixed client ID (persistent session), empty: random ID
+// CA certificate (PEM) which signed the broker certificate, empty: no TLS (use port 8883 with TLS), e.g.
+// "-----BEGIN CERTIFICATE-----\n"
+// "MIIDdzCCAl+gAwIBAgIE...\n"
+// "-----END CERTIFICATE-----\n";
+const char *mqtt_ca_cert = "";                  ///< CA certificate of the Broker (TLS)
+const char *mqtt_tls_server_name = "";          ///< name in the Broker certificate, required with TLS if a Broker is given by IP address
 
 #endif
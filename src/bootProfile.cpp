@@ -0,0 +1,59 @@
+/**
+ * @file bootProfile.cpp
+ * @author Fabian Reifler
+ * @brief Messung der Aufstartzeiten (erstes Bild, WLAN verbunden, MQTT verbunden) \n
+ * Jeder Messpunkt wird beim ersten Erreichen mit der Zeit seit dem Reset gespeichert und auf dem SerialPort ausgegeben.
+ * @version 0.1
+ * @date 19.10.2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "bootProfile.h"
+#include <Arduino.h>
+
+/********************************************************************************************
+*** Module Global Parameters
+********************************************************************************************/
+static unsigned long bootTimes[BOOT_MARK_COUNT]; ///< ms since reset per mark, 0: not reached yet
+static const char *bootMarkNames[BOOT_MARK_COUNT] = {"setup done", "first frame", "WiFi connected", "MQTT connected"};
+
+/**
+ * @brief Speichert die Zeit seit dem Reset für einen Messpunkt. Wird der Messpunkt später nochmals erreicht
+ * (z.B. nach einem Verbindungsabbruch), bleibt die erste Zeit erhalten.
+ *
+ * @param mark Messpunkt, siehe @ref boot_mark_e
+ */
+void bootProfileMark(int mark)
+{
+  if (mark < 0 || mark >= BOOT_MARK_COUNT || bootTimes[mark] != 0)
+  {
+    return;
+  }
+  bootTimes[mark] = millis();
+  if (bootTimes[mark] == 0)
+  {
+    bootTimes[mark] = 1; // 0 is reserved for "not reached"
+  }
+  Serial.print(F("Boot: "));
+  Serial.print(bootMarkNames[mark]);
+  Serial.print(F(" after "));
+  Serial.print(bootTimes[mark]);
+  Serial.println(F(" ms"));
+}
+
+/**
+ * @brief Gibt die Zeit seit dem Reset bis zum ersten Erreichen des Messpunktes zurück.
+ *
+ * @param mark Messpunkt, siehe @ref boot_mark_e
+ * @return unsigned long Zeit in ms, 0: Messpunkt noch nicht erreicht
+ */
+unsigned long getBootProfileTime(int mark)
+{
+  if (mark < 0 || mark >= BOOT_MARK_COUNT)
+  {
+    return 0;
+  }
+  return bootTimes[mark];
+}
@@ -0,0 +1,27 @@
+/**
+ * @file bootProfile.h
+ * @author Fabian Reifler
+ * @brief Messung der Aufstartzeiten (erstes Bild, WLAN verbunden, MQTT verbunden)
+ * @version 0.1
+ * @date 19.10.2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef _BOOT_PROFILE_H_
+#define _BOOT_PROFILE_H_
+
+/// Messpunkte beim Aufstarten
+typedef enum{
+  BOOT_SETUP_DONE,      ///< setup() ist abgeschlossen
+  BOOT_FIRST_FRAME,     ///< Die erste Seite ist gezeichnet
+  BOOT_WIFI_CONNECTED,  ///< WLAN verbunden, IP Adresse erhalten
+  BOOT_MQTT_CONNECTED,  ///< MQTT Broker verbunden
+  BOOT_MARK_COUNT       ///< Anzahl Messpunkte
+}boot_mark_e;
+
+void bootProfileMark(int mark); ///< Messpunkt erreicht, nur das erste Erreichen wird gespeichert
+unsigned long getBootProfileTime(int mark); ///< gibt die Zeit seit dem Reset bis zum Messpunkt zurück
+
+#endif
@@ -0,0 +1,354 @@
+/**
+ * @file connectivityHistory.cpp
+ * @author Fabian Reifler
+ * @brief Verlauf der WLAN und MQTT Verbindungsunterbrüche mit Statistik, Diagnoseseite und Publizieren über MQTT \n
+ * Jeder Unterbruch wird mit Zeitpunkt, Dauer, Signalstärke vor dem Abbruch und Anzahl Verbindungsversuchen in einem
+ * Ringpuffer gespeichert. Die zusammengefasste Statistik wird auf der Diagnoseseite @ref CONN_HISTORY_PAGE_TITLE angezeigt
+ * und im Intervall @ref CONN_HISTORY_PUBLISH_INTERVAL als JSON publiziert, zusammen mit den neuen Unterbrüchen
+ * und dem Einfluss des WLAN Stromsparmodus (Anteil volle Leistung, Umlaufzeit pro Modus).
+ * Der Aufstart zählt nicht als Unterbruch, erfasst wird erst nach der ersten Verbindung.
+ * @version 0.3
+ * @date 19.10.2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "connectivityHistory.h"
+#include "networkConnection.h"
+#include "display.h"
+#include "pages.h"
+#include "wio_json.h"
+#include <Arduino.h>
+
+/********************************************************************************************
+*** Module Global Parameters
+********************************************************************************************/
+extern page_t pages_array[]; ///< extern Page Array, is coded in pages.c
+
+static wio_wifi *historyWifi = NULL;
+static wio_mqtt *historyMQTT = NULL;
+static conn_event_t events[CONN_HISTORY_LENGTH];        ///< ring buffer, index = sequence % CONN_HISTORY_LENGTH
+static uint32_t eventCount = 0;                         ///< number of events since start (sequence of the next event)
+static uint32_t publishedCount = 0;                     ///< events before this sequence are published
+static conn_link_stats_t linkStats[CONN_LINK_COUNT];
+static bool linkUp[CONN_LINK_COUNT];                    ///< state at the last call of the handler
+static int32_t openEvent[CONN_LINK_COUNT] = {-1, -1};   ///< sequence of the open outage per link, -1: none
+static uint32_t attemptsAtDrop[CONN_LINK_COUNT];        ///< attempt counter when the link dropped
+static int lastRssi = -99;                              ///< filtered RSSI while the WLAN was up
+static const char *linkNames[CONN_LINK_COUNT] = {"wifi", "mqtt"};
+static int16_t historyPage = -1;                        ///< diagnostics page in pages_array, -1: not present
+
+/********************************************************************************************
+*** Functionprototypes
+********************************************************************************************/
+static uint32_t attemptCounter(int link);
+static void updatePage(uint16_t currentPage);
+static void writeLinkStats(wio_json_writer &writer, int link);
+static void writePowerStats(wio_json_writer &writer);
+
+/**
+ * @brief Initialisiert den Verlauf und sucht die Diagnoseseite anhand ihres Titels. Fehlt sie in pages.c,
+ * wird der Verlauf nur publiziert.
+ *
+ * @param wio_Wifi Zeiger auf das wio_wifi Objekt (Anzahl Verbindungsversuche)
+ * @param wio_MQTT Zeiger auf das wio_mqtt Objekt (Publizieren, Anzahl Verbindungsversuche)
+ */
+void initConnectivityHistory(wio_wifi *wio_Wifi, wio_mqtt *wio_MQTT)
+{
+  historyWifi = wio_Wifi;
+  historyMQTT = wio_MQTT;
+  historyPage = -1;
+  for (int16_t i = 0; strcmp(pages_array[i].title, "NULL"); i++) // the last page is marked with the title "NULL"
+  {
+    if (strcmp(pages_array[i].title, CONN_HISTORY_PAGE_TITLE) == 0)
+    {
+      historyPage = i;
+      break;
+    }
+  }
+  if (historyPage < 0)
+  {
+    Serial.println("Connectivity page \"" CONN_HISTORY_PAGE_TITLE "\" not found");
+  }
+}
+
+/**
+ * @brief Erfasst Abbrüche und Wiederherstellungen der WLAN und MQTT Verbindung. Muss nach
+ * @ref networkConnectionHandler() in jedem Durchlauf von loop() aufgerufen werden.
+ *
+ * @param currentPage Aktuelle Seite, die Diagnoseseite wird nur gezeichnet, wenn sie angezeigt wird
+ */
+void connectivityHistoryHandler(uint16_t currentPage)
+{
+  static long previousMillis[] = {0, 0}; // previousMillis[0]: diagnostics page, previousMillis[1]: publish
+  connection_state_t *state = getConnectionStatePtr();
+  bool up[CONN_LINK_COUNT] = {state->wlan_status == CONNECTED, state->mqtt_status == CONNECTED};
+  long currentMillis = millis();
+
+  if (historyWifi == NULL)
+  {
+    return;
+  }
+  if (up[CONN_LINK_WIFI] && state->wlan_strength != -99)
+  {
+    lastRssi = state->wlan_strength;
+  }
+
+  for (int link = 0; link < CONN_LINK_COUNT; link++)
+  {
+    if (linkUp[link] && !up[link]) // dropped
+    {
+      conn_event_t *e = &events[eventCount % CONN_HISTORY_LENGTH];
+      e->downAt = currentMillis;
+      e->durationMs = 0;
+      e->rssi = lastRssi;
+      e->link = link;
+      e->attempts = 0;
+      openEvent[link] = eventCount++;
+      attemptsAtDrop[link] = attemptCounter(link);
+      linkStats[link].drops++;
+      linkStats[link].lastRssi = lastRssi;
+    }
+    else if (!linkUp[link] && up[link] && openEvent[link] >= 0) // recovered
+    {
+      uint32_t duration = currentMillis - events[openEvent[link] % CONN_HISTORY_LENGTH].downAt;
+      uint32_t attempts = attemptCounter(link) - attemptsAtDrop[link];
+      if (eventCount - (uint32_t)openEvent[link] <= CONN_HISTORY_LENGTH) // not overwritten in the meantime
+      {
+        conn_event_t *e = &events[openEvent[link] % CONN_HISTORY_LENGTH];
+        e->durationMs = duration > 0 ? duration : 1;
+        e->attempts = attempts;
+      }
+      linkStats[link].lastDownMs = duration;
+      linkStats[link].totalDownMs += duration;
+      linkStats[link].attempts += attempts;
+      if (duration > linkStats[link].maxDownMs)
+      {
+        linkStats[link].maxDownMs = duration;
+      }
+      openEvent[link] = -1;
+    }
+    linkUp[link] = up[link];
+  }
+
+  if (currentMillis - previousMillis[0] >= 1000 || previousMillis[0] == 0)
+  {
+    previousMillis[0] = currentMillis;
+    updatePage(currentPage);
+  }
+  if (up[CONN_LINK_MQTT] && (currentMillis - previousMillis[1] >= CONN_HISTORY_PUBLISH_INTERVAL || previousMillis[1] == 0))
+  {
+    previousMillis[1] = currentMillis;
+    publishConnectivityHistory();
+  }
+}
+
+/**
+ * @brief Gibt die zusammengefasste Statistik einer Verbindung zurück.
+ *
+ * @param link Verbindung, siehe @ref conn_link_e
+ * @return const conn_link_stats_t* Statistik, NULL bei ungültiger Verbindung
+ */
+const conn_link_stats_t *getConnectivityStats(int link)
+{
+  if (link < 0 || link >= CONN_LINK_COUNT)
+  {
+    return NULL;
+  }
+  return &linkStats[link];
+}
+
+/**
+ * @brief Gibt einen Unterbruch aus dem Ringpuffer zurück.
+ *
+ * @param age 0: neuster Unterbruch, 1: der davor, ...
+ * @return const conn_event_t* Unterbruch, NULL wenn nicht (mehr) vorhanden
+ */
+const conn_event_t *getConnectivityEvent(unsigned int age)
+{
+  if (age >= eventCount || age >= CONN_HISTORY_LENGTH)
+  {
+    return NULL;
+  }
+  return &events[(eventCount - 1 - age) % CONN_HISTORY_LENGTH];
+}
+
+/**
+ * @brief Publiziert die Statistik beider Verbindungen und die seit der letzten Nachricht abgeschlossenen
+ * Unterbrüche (höchstens @ref CONN_HISTORY_PUBLISH_EVENTS) als JSON Objekt, z.B. \n
+ * <tt>{"uptime":3600,"rssi":-61,"power":{"duty":12,...},"wifi":{"drops":2,...},"mqtt":{...},"events":[{"link":"wifi","at":1200,"ms":3400,"rssi":-78,"attempts":2}]}</tt>
+ *
+ * @return true Die Nachricht wurde gesendet
+ * @return false Keine Verbindung oder der Sendepuffer ist zu klein
+ */
+bool publishConnectivityHistory(void)
+{
+  char topic[TOPIC_LENGTH];
+  wio_json_writer writer(*historyMQTT);
+
+  snprintf(topic, sizeof(topic), CONN_HISTORY_TOPIC, historyMQTT->getClientId());
+  if (!historyMQTT->beginMessage(topic, false))
+  {
+    return false;
+  }
+  writer.beginObject();
+  writer.key("uptime");
+  writer.value(millis() / 1000);
+  writer.key("rssi");
+  writer.value(lastRssi);
+  writePowerStats(writer);
+  for (int link = 0; link < CONN_LINK_COUNT; link++)
+  {
+    writer.key(linkNames[link]);
+    writeLinkStats(writer, link);
+  }
+
+  uint32_t first = publishedCount;
+  if (eventCount - first > CONN_HISTORY_LENGTH) // older events are overwritten
+  {
+    first = eventCount - CONN_HISTORY_LENGTH;
+  }
+  writer.key("events");
+  writer.beginArray();
+  uint32_t seq = first;
+  for (; seq < eventCount && seq - first < CONN_HISTORY_PUBLISH_EVENTS; seq++)
+  {
+    const conn_event_t *e = &events[seq % CONN_HISTORY_LENGTH];
+    if (e->durationMs == 0)
+    {
+      break; // still down, published once it has recovered
+    }
+    writer.beginObject();
+    writer.key("link");
+    writer.value(linkNames[e->link]);
+    writer.key("at");
+    writer.value((unsigned long)(e->downAt / 1000));
+    writer.key("ms");
+    writer.value((unsigned long)e->durationMs);
+    writer.key("rssi");
+    writer.value((int)e->rssi);
+    writer.key("attempts");
+    writer.value((int)e->attempts);
+    writer.endObject();
+  }
+  writer.endArray();
+  writer.endObject();
+
+  if (!historyMQTT->endMessage())
+  {
+    return false;
+  }
+  publishedCount = seq;
+  return true;
+}
+
+/**
+ * @brief Liest den Zähler der Verbindungsversuche einer Verbindung.
+ *
+ * @param link Verbindung, siehe @ref conn_link_e
+ * @return uint32_t Anzahl Versuche seit dem Start
+ */
+static uint32_t attemptCounter(int link)
+{
+  if (link == CONN_LINK_WIFI)
+  {
+    return historyWifi->getConnectAttempts();
+  }
+  uint32_t attempts = 0;
+  for (unsigned int i = 0; i < historyMQTT->getBrokerCount(); i++)
+  {
+    const mqtt_broker_t *broker = historyMQTT->getBroker(i);
+    attempts += broker->connects + broker->failures; // every attempt ends with CONNACK or a failure
+  }
+  return attempts;
+}
+
+/**
+ * @brief Schreibt die Statistik in die Zeilen der Diagnoseseite und zeichnet geänderte Zeilen,
+ * wenn die Seite angezeigt wird.
+ *
+ * @param currentPage Aktuelle Seite
+ */
+static void updatePage(uint16_t currentPage)
+{
+  float values[NUMBERS_OF_LINES] = {
+      (float)linkStats[CONN_LINK_WIFI].drops,
+      linkStats[CONN_LINK_WIFI].lastDownMs / 1000.0f,
+      (float)linkStats[CONN_LINK_MQTT].drops,
+      linkStats[CONN_LINK_MQTT].lastDownMs / 1000.0f,
+      (linkStats[CONN_LINK_WIFI].maxDownMs > linkStats[CONN_LINK_MQTT].maxDownMs ? linkStats[CONN_LINK_WIFI].maxDownMs : linkStats[CONN_LINK_MQTT].maxDownMs) / 1000.0f,
+      (float)linkStats[CONN_LINK_WIFI].lastRssi};
+  if (historyPage < 0) // page removed from pages.c, never write into another page
+  {
+    return;
+  }
+  page_t *page = &pages_array[historyPage];
+
+  for (int i = 0; i < NUMBERS_OF_LINES; i++)
+  {
+    if (page->lines[i].value != values[i])
+    {
+      page->lines[i].value = values[i];
+      if (currentPage == historyPage)
+      {
+        updateLine(historyPage, i, ONLY_VALUE);
+      }
+    }
+  }
+}
+
+/**
+ * @brief Schreibt die Statistik einer Verbindung als JSON Objekt.
+ *
+ * @param writer JSON Writer
+ * @param link Verbindung, siehe @ref conn_link_e
+ */
+static void writeLinkStats(wio_json_writer &writer, int link)
+{
+  const conn_link_stats_t *s = &linkStats[link];
+
+  writer.beginObject();
+  writer.key("drops");
+  writer.value((unsigned long)s->drops);
+  writer.key("downMs");
+  writer.value((unsigned long)s->totalDownMs);
+  writer.key("lastMs");
+  writer.value((unsigned long)s->lastDownMs);
+  writer.key("maxMs");
+  writer.value((unsigned long)s->maxDownMs);
+  writer.key("attempts");
+  writer.value((unsigned long)s->attempts);
+  writer.key("rssi");
+  writer.value(s->lastRssi);
+  writer.endObject();
+}
+
+/**
+ * @brief Schreibt die Statistik des WLAN Stromsparmodus als JSON Objekt: Anteil der verbundenen Zeit mit voller
+ * Leistung in %, Anzahl Wechsel und die mittlere Keep Alive Umlaufzeit mit voller Leistung und im Stromsparmodus.
+ *
+ * @param writer JSON Writer
+ */
+static void writePowerStats(wio_json_writer &writer)
+{
+  const wifi_power_stats_t *s = getWLANPowerStatistics();
+
+  if (s == NULL)
+  {
+    return;
+  }
+  writer.key("power");
+  writer.beginObject();
+  writer.key("duty");
+  writer.value((int)getWLANDutyCycle());
+  writer.key("switches");
+  writer.value(s->switches);
+  writer.key("wakes");
+  writer.value(s->keepAliveWakes);
+  writer.key("rttAwakeMs");
+  writer.value(s->rttAwakeAvgMs);
+  writer.key("rttSleepMs");
+  writer.value(s->rttSleepAvgMs);
+  writer.endObject();
+}
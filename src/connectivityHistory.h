@@ -0,0 +1,68 @@
+/**
+ * @file connectivityHistory.h
+ * @author Fabian Reifler
+ * @brief Verlauf der WLAN und MQTT Verbindungsunterbrüche mit Statistik, Diagnoseseite und Publizieren über MQTT
+ * @version 0.2
+ * @date 19.10.2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef _CONNECTIVITY_HISTORY_H_
+#define _CONNECTIVITY_HISTORY_H_
+
+#include "wio_wifi.h"
+#include "wio_mqtt.h"
+
+/********************************************************************************************
+*** Defines
+********************************************************************************************/
+#define CONN_HISTORY_LENGTH 16                ///< Anzahl Unterbrüche im Ringpuffer
+#define CONN_HISTORY_PUBLISH_INTERVAL 60000   ///< Intervall in ms, in dem die Statistik publiziert wird
+#define CONN_HISTORY_PUBLISH_EVENTS 8         ///< Maximale Anzahl neuer Unterbrüche pro Nachricht
+#define CONN_HISTORY_TOPIC "wio/%s/connectivity" ///< Topic der Statistik, %s: MQTT Client ID (mqtt_id in secrets.h für ein festes Topic)
+#define CONN_HISTORY_PAGE_TITLE "Verbindung"  ///< Titel der Diagnoseseite in pages_array, fehlt sie, wird nichts angezeigt
+
+/********************************************************************************************
+*** Enumerations
+********************************************************************************************/
+/// Verbindung, die unterbrochen wurde
+typedef enum{
+  CONN_LINK_WIFI,   ///< WLAN
+  CONN_LINK_MQTT,   ///< MQTT Broker
+  CONN_LINK_COUNT   ///< Anzahl Verbindungen
+}conn_link_e;
+
+/********************************************************************************************
+*** Datatypes
+********************************************************************************************/
+/// Ein Unterbruch im Ringpuffer
+typedef struct{
+  uint32_t downAt;      ///< Zeitpunkt des Abbruches (millis)
+  uint32_t durationMs;  ///< Dauer bis zur Wiederherstellung, 0: noch unterbrochen
+  int8_t rssi;          ///< Gefilterte WLAN Signalstärke vor dem Abbruch in dBm
+  uint8_t link;         ///< Verbindung, siehe @ref conn_link_e
+  uint16_t attempts;    ///< Anzahl Verbindungsversuche bis zur Wiederherstellung
+}conn_event_t;
+
+/// Zusammengefasste Statistik einer Verbindung
+typedef struct{
+  uint32_t drops;        ///< Anzahl Unterbrüche
+  uint32_t totalDownMs;  ///< Summe der Unterbrüche (abgeschlossene)
+  uint32_t lastDownMs;   ///< Dauer des letzten abgeschlossenen Unterbruches
+  uint32_t maxDownMs;    ///< Längster Unterbruch
+  uint32_t attempts;     ///< Summe der Verbindungsversuche bis zur Wiederherstellung
+  int lastRssi;          ///< Gefilterte WLAN Signalstärke beim letzten Abbruch
+}conn_link_stats_t;
+
+/********************************************************************************************
+*** Functionprototypes
+********************************************************************************************/
+void initConnectivityHistory(wio_wifi *wio_Wifi, wio_mqtt *wio_MQTT); ///< Verlauf initialisieren
+void connectivityHistoryHandler(uint16_t currentPage); ///< Zustandswechsel erfassen, Diagnoseseite und MQTT aktualisieren
+const conn_link_stats_t *getConnectivityStats(int link); ///< Statistik einer Verbindung auslesen
+const conn_event_t *getConnectivityEvent(unsigned int age); ///< Unterbruch aus dem Ringpuffer auslesen (0: neuster)
+bool publishConnectivityHistory(void); ///< Statistik und neue Unterbrüche publizieren
+
+#endif
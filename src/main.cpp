@@ -2,8 +2,8 @@
  * @file main.cpp
  * @author Beat Sturzenegger / Fabian Reifler
  * @brief Main File vom WIO Terminal Template
- * @version 1.3
- * @date 24.04.2023
+ * @version 1.5
+ * @date 19.10.2026
  *
  * @copyright Copyright (c) 2023
  *
@@ -21,7 +21,10 @@
 #include "buttons.h"
 #include "display.h"
 #include "networkConnection.h"
+#include "topicBindings.h"
 #include "runLED.h"
+#include "bootProfile.h"
+#include "connectivityHistory.h"
 #include "SAMCrashMonitor.h"
 
 /********************************************************************************************
@@ -46,12 +49,13 @@ wio_mqtt wio_MQTT = wio_mqtt(addLogText);
 /**
  * @brief Setup Funktion \n
  * Wird einmal vor der Main Funktion loop ausgeführt.
+ * @note setup() blockiert nicht: Die erste Seite wird sofort gezeichnet, WLAN und MQTT werden im loop()
+ * aufgebaut (siehe @ref networkConnectionHandler()). Die Aufstartzeiten werden mit @ref bootProfileMark() gemessen.
  *
  */
 void setup()
 {
-  Serial.begin(115200); // init Serial Port with 115200 baud
-  delay(1000);          // 1000ms delay for Serial begin
+  Serial.begin(115200); // init Serial Port with 115200 baud, no wait: early messages may be lost without a terminal
 
   SAMCrashMonitor::begin();
   SAMCrashMonitor::disableWatchdog(); // Make sure it is turned off during init.
@@ -59,7 +63,6 @@ void setup()
 
   // Display Initialization
   initDisplay();
-  enableLoadingScreen();
 
   // Turn the watchdog on and get actual timeout value based on the provided one.
   int timeout = SAMCrashMonitor::enableWatchdog(20000);
@@ -71,20 +74,20 @@ void setup()
   initButtons();
   addLogText("Config Buttons", NEWLINE);
 
-  // WiFi Configuration
+  // WiFi Configuration, the connection is set up in loop()
   wio_Wifi.initWifi();
-  SAMCrashMonitor::iAmAlive();    // init WiFi
 
   // Initialize user functions like subscrition of mqtt topics
   currentPage = initUserFunctions(&wio_MQTT);
+  initConnectivityHistory(&wio_Wifi, &wio_MQTT);
 
   addLogText("Init successfully!", NEWLINE);
-  delay(1000); // 1000ms delay to read the init- message
-  disableLoadingScreen();
 
   drawPage(pages_array, currentPage);
+  bootProfileMark(BOOT_FIRST_FRAME);
 
   initRunLed();
+  bootProfileMark(BOOT_SETUP_DONE);
 }
 
 /********************************************************************************************
@@ -101,7 +104,9 @@ void loop()
   SAMCrashMonitor::iAmAlive();
   runLedHandler();
   networkConnectionHandler(&wio_Wifi, &wio_MQTT);            // rebuilds the network connection if necessary, updates the connection status
+  connectivityHistoryHandler(currentPage);                   // records outages, diagnostics page and periodic MQTT report
   currentPage = buttonHandler(currentPage);                  // you can change the page with the wio- buttons if you want
   displayHandler();                                          // refreshes the connection state on display
+  topicBindingsHandler(currentPage);                         // draws lines of the current page, which were changed by bound topics
   userFunctionsHandler(currentPage, &wio_MQTT, pages_array); // add your code in this function
 }
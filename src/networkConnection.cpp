@@ -2,8 +2,8 @@
  * @file networkConnection.cpp
  * @author Fabian Reifler
  * @brief Verbindungsaufbau zum WLAN und MQTT Broker
- * @version 0.1
- * @date 24.04.2023
+ * @version 0.7
+ * @date 19.10.2026
  *
  * @copyright Copyright (c) 2023
  *
@@ -11,23 +11,74 @@
 
 #include "networkConnection.h"
 #include "wio_wifi.h"
+#include "wio_link_monitor.h"
+#include "wio_roaming.h"
+#include "wio_power_policy.h"
 #include "wio_mqtt.h"
 #include "display.h"
+#include "bootProfile.h"
 
 // Module global parameters
 // Connection state WLAN and MQTT
 static connection_state_t connectionState = {
     .mqtt_status = DISCONNECTED,
+    .mqtt_state = MQTT_STATE_IDLE,
     .mqtt_pub_status = false,
     .mqtt_sub_status = false,
     .wlan_status = DISCONNECTED,
     .wlan_strength = 0,
-    .wlan_channel = 0};
+    .wlan_channel = 0,
+    .wlan_strength_raw = 0,
+    .wlan_quality = WIFI_QUALITY_NONE};
 
-// intervals for periodic tasks
-const long scanInterval = 500;            ///< Interval time for WiFi strength und channel scanning
+// intervals for periodic tasks, the WiFi state comes from events (wio_wifi polls the status only as a safety check)
 const long interfaceIconIntervall = 1000; ///< Interval time for icons refreshing
-const long mqttStateIntervall = 5000;     ///< Interval time for MQTT state
+const long mqttStateIntervall = 5000;     ///< Interval time for MQTT state (connection health check), incoming messages are polled every loop
+
+/********************************************************************************************
+*** Objects
+********************************************************************************************/
+static wio_link_monitor *linkMonitor = NULL; ///< RSSI and channel of the associated AP, created with the first call of the handler
+static wio_roaming *roaming = NULL;          ///< switches to a stronger AP of the known networks
+static wio_mqtt *linkMQTT = NULL;            ///< MQTT client, notified right away when the WiFi link changes
+static wio_power_policy *powerPolicy = NULL; ///< modem sleep while the MQTT traffic is idle
+
+/**
+ * @brief Übergibt die Resultate eines abgeschlossenen Scans an das Roaming.
+ *
+ * @param found Anzahl gefundener Netzwerke
+ */
+static void onScanDone(int found)
+{
+  roaming->scanDone(found);
+}
+
+/**
+ * @brief Übernimmt einen Zustandswechsel der WLAN Verbindung sofort in den Verbindungsstatus. Bei einem Abbruch
+ * wird die MQTT Verbindung abgebaut, ohne auf einen Timeout der TCP Verbindung zu warten, nach der Wiederherstellung
+ * wird der Verbindungsaufbau zum Broker gestartet.
+ *
+ * @param up true: verbunden, false: unterbrochen
+ */
+static void onWiFiLink(bool up)
+{
+  if (up)
+  {
+    connectionState.wlan_status = CONNECTED;
+    bootProfileMark(BOOT_WIFI_CONNECTED);
+    linkMQTT->reconnect();
+  }
+  else
+  {
+    connectionState.wlan_status = DISCONNECTED;
+    connectionState.wlan_strength = -99;
+    connectionState.wlan_strength_raw = -99;
+    connectionState.wlan_quality = WIFI_QUALITY_NONE;
+    linkMQTT->disconnect();
+    connectionState.mqtt_status = DISCONNECTED;
+    connectionState.mqtt_state = linkMQTT->getConnectionState();
+  }
+}
 
 /**
  * @brief In dieser Funktion werden Aufgaben und Funktionen, nach Ablauf eines
@@ -36,74 +87,79 @@ const long mqttStateIntervall = 5000;     ///< Interval time for MQTT state
  */
 void networkConnectionHandler(wio_wifi *wio_Wifi, wio_mqtt *wio_MQTT)
 {
-  static long previousMillis[] = {0, 0}; // array for the differents previous millis value
-                                         // previousMillis[0]: WiFi scan
-                                         // previousMillis[1]: update MQTT states
-  static int networksFound = -3;         // number of founded networks; -3: start value, -2: scan not triggered, -1: scan not completed
+  static long previousMillis = 0;        // previous millis value for the update of the MQTT states
   long currentMillis = millis();         // save millis
 
-  if ((currentMillis - previousMillis[0] >= scanInterval) || previousMillis[0] == 0)
+  if (linkMonitor == NULL)
   {
-    previousMillis[0] = currentMillis;
-    if (wio_Wifi->WiFiStatus() == CONNECTED) // is connected to WLAN?
-    {
-      connectionState.wlan_status = CONNECTED;
-      networksFound = wio_Wifi->getNetworksFound();
-      if (networksFound <= -2) // if scan not triggered?
-      {
-        wio_Wifi->scanNetwork(); // start network scan (asynchronus)
-      }
-
-      if (networksFound > 0) // is Scan Done?
-      {
-        // read No. of current WiFi
-        for (int i = 0; i < networksFound; i++)
-        {
-          // Serial.printf("%d: %s, Ch:%d (%ddBm) %s\n", i + 1, WiFi.SSID(i).c_str(), WiFi.channel(i), WiFi.RSSI(i), WiFi.encryptionType(i) == ENC_TYPE_NONE ? "open" : ""); // print information of the selected WiFi
-          if (strcmp(wio_Wifi->getScannedSSID(i), wio_Wifi->getSSID()) == 0) // is the selected WiFi the same as the connected WiFi?
-          {
-            connectionState.wlan_strength = wio_Wifi->measureRSSI(i); // read RSSI
-            connectionState.wlan_channel = wio_Wifi->readChannel(i);  // read WiFi channel
-            break;
-          }
-          wio_Wifi->deleteScanResults(); // delete scan results and reset scan progress
-        }
-      }
-    }
-    else
-    {
-      connectionState.wlan_status = DISCONNECTED;
-      connectionState.wlan_strength = -99;
-      wio_Wifi->reconnect();
-    }
+    static wio_link_monitor monitor(*wio_Wifi);
+    static wio_roaming roamingManager(*wio_Wifi, monitor);
+    static wio_power_policy policy(*wio_Wifi);
+    linkMonitor = &monitor;
+    roaming = &roamingManager;
+    powerPolicy = &policy;
+    linkMonitor->setScanHandler(onScanDone);
+    linkMQTT = wio_MQTT;
+    wio_Wifi->setLinkHandler(onWiFiLink);
   }
 
-  if ((currentMillis - previousMillis[1] >= mqttStateIntervall) || previousMillis[1] == 0)
+  // drains the WiFi event queue every loop, state changes are reported to onWiFiLink() right away;
+  // association, DHCP and retries run in the WiFi state machine
+  wio_Wifi->connectionHandler();
+
+  // read RSSI and channel from the associated link, a full scan only runs on request or at a slow cadence
+  if (linkMonitor->handler(connectionState.wlan_status == CONNECTED))
   {
-    if (wio_Wifi->WiFiStatus() == CONNECTED)
+    if (connectionState.wlan_status == CONNECTED)
     {
-      if (wio_MQTT->isConnected()) // check MQTT connection
-      {
-        connectionState.mqtt_status = CONNECTED;
-        if (connectionState.mqtt_status)
-        {
-          wio_MQTT->clientLoop();             // MQTT client loop
-          previousMillis[1] = currentMillis;  // refresh previousMillis
-          wio_MQTT->setPublishState(false);   // reset publish state in the mqtt library
-          wio_MQTT->setSubscribeState(false); // reset subscribe state in the mqtt library
-        }
-      }
-      else
-      {
-        connectionState.mqtt_status = DISCONNECTED;
-        wio_MQTT->reconnect(); // reconnect to MQTT broker
-      }
+      const wifi_link_t *link = linkMonitor->getLink();
+      connectionState.wlan_strength = link->rssiFiltered;
+      connectionState.wlan_strength_raw = link->rssi;
+      connectionState.wlan_quality = link->quality;
+      connectionState.wlan_channel = link->channel;
     }
-    else
+    roaming->handler(); // outage measurement and a scan if the signal is weak
+  }
+
+  if ((currentMillis - previousMillis >= mqttStateIntervall) || previousMillis == 0)
+  {
+    previousMillis = currentMillis; // refresh previousMillis
+    if (wio_MQTT->isConnected()) // check MQTT connection
     {
-      connectionState.mqtt_status = DISCONNECTED;
+      wio_MQTT->setPublishState(false);   // reset publish state in the mqtt library
+      wio_MQTT->setSubscribeState(false); // reset subscribe state in the mqtt library
     }
   }
+
+  // advance the MQTT connection state machine by one step and drain the socket
+  if (connectionState.wlan_status == CONNECTED)
+  {
+    wio_MQTT->reconnect(); // start connection setup right after the WiFi is back, if not already running
+    wio_MQTT->connectionHandler();
+    wio_MQTT->clientLoop(); // MQTT client loop, runs every loop for a short reaction time
+  }
+  else
+  {
+    wio_MQTT->disconnect();
+  }
+  connectionState.mqtt_status = wio_MQTT->isConnected() ? CONNECTED : DISCONNECTED;
+  if (connectionState.mqtt_status == CONNECTED)
+  {
+    bootProfileMark(BOOT_MQTT_CONNECTED);
+  }
+  connectionState.mqtt_state = wio_MQTT->getConnectionState();
+
+  // power save follows the MQTT traffic: full performance during bursts, pending messages and with command topics, modem sleep when idle
+  const mqtt_traffic_t *mqttTraffic = wio_MQTT->getTrafficStatistics();
+  wifi_traffic_t traffic;
+  traffic.session = connectionState.mqtt_status == CONNECTED;
+  traffic.packets = mqttTraffic->txPackets + mqttTraffic->rxPackets;
+  traffic.pending = wio_MQTT->getQosStatistics()->queueDepth;
+  traffic.commands = wio_MQTT->getCommandTopicCount();
+  traffic.keepAliveMs = wio_MQTT->getKeepAliveRemaining();
+  traffic.pings = mqttTraffic->pings;
+  traffic.rttMs = mqttTraffic->rttLastMs;
+  powerPolicy->handler(connectionState.wlan_status == CONNECTED, &traffic);
 }
 
 connection_state_t *getConnectionStatePtr()
@@ -117,6 +173,11 @@ int getMQTTStatus()
   return connectionState.mqtt_status;
 }
 
+int getMQTTState()
+{
+  return connectionState.mqtt_state;
+}
+
 bool getMQTTPubStatus()
 {
   return connectionState.mqtt_sub_status;
@@ -137,7 +198,70 @@ int getWLANStrength()
   return connectionState.wlan_strength;
 }
 
+int getWLANStrengthRaw()
+{
+  return connectionState.wlan_strength_raw;
+}
+
+int getWLANQuality()
+{
+  return connectionState.wlan_quality;
+}
+
 int getWLANChannel()
 {
   return connectionState.wlan_channel;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Diese Funktion fordert einen vollständigen WLAN Scan an. Er wird asynchron ausgeführt,
+ * sobald die Verbindung besteht.
+ *
+ */
+void requestWiFiScan()
+{
+  if (linkMonitor != NULL)
+  {
+    linkMonitor->requestScan();
+  }
+}
+
+/**
+ * @brief Diese Funktion gibt den Zustand der WLAN Verbindung zurück (RSSI, Kanal, BSSID, letzter Scan).
+ *
+ * @return const wifi_link_t* Zustand der Verbindung, NULL: der Handler wurde noch nicht aufgerufen
+ */
+const wifi_link_t *getWLANLink()
+{
+  return linkMonitor != NULL ? linkMonitor->getLink() : NULL;
+}
+
+/**
+ * @brief Diese Funktion gibt die Statistik der Roaming Entscheidungen und WLAN Unterbrüche zurück.
+ *
+ * @return const wifi_roam_stats_t* Statistik, NULL: der Handler wurde noch nicht aufgerufen
+ */
+const wifi_roam_stats_t *getWLANRoamStatistics()
+{
+  return roaming != NULL ? roaming->getStatistics() : NULL;
+}
+
+/**
+ * @brief Diese Funktion gibt die Statistik des WLAN Stromsparmodus zurück (Zeit pro Modus, Umlaufzeit pro Modus).
+ *
+ * @return const wifi_power_stats_t* Statistik, NULL: der Handler wurde noch nicht aufgerufen
+ */
+const wifi_power_stats_t *getWLANPowerStatistics()
+{
+  return powerPolicy != NULL ? powerPolicy->getStatistics() : NULL;
+}
+
+/**
+ * @brief Diese Funktion gibt den Anteil der verbundenen Zeit mit voller Leistung des WLAN zurück.
+ *
+ * @return uint8_t Anteil in %
+ */
+uint8_t getWLANDutyCycle()
+{
+  return powerPolicy != NULL ? powerPolicy->getDutyCycle() : 100;
+}
@@ -2,8 +2,8 @@
  * @file networkConnection.h
  * @author Fabian Reifler
  * @brief Verbindungsaufbau zum WLAN und MQTT Broker
- * @version 0.1
- * @date 24.04.2023
+ * @version 0.5
+ * @date 19.10.2026
  *
  * @copyright Copyright (c) 2023
  *
@@ -13,6 +13,9 @@
 #define _NETWORK_CONNECTION_H_
 
 #include "wio_wifi.h"
+#include "wio_link_monitor.h"
+#include "wio_roaming.h"
+#include "wio_power_policy.h"
 #include "wio_mqtt.h"
 #include "display.h"
 
@@ -22,10 +25,18 @@
 void networkConnectionHandler(wio_wifi *wio_Wifi, wio_mqtt *wio_MQTT);
 connection_state_t * getConnectionStatePtr(void); ///< gibt den Pointer auf die connectionState Struktur zurück
 int getMQTTStatus(void); ///< gibt den MQTT Verbinungsstatus zurück
+int getMQTTState(void); ///< gibt den Zustand des MQTT Verbindungsaufbaus zurück
 bool getMQTTPubStatus(void); ///< gibt den MQTT Publish Status zurück
 bool getMQTTSubStatus(void); ///< gibt den MQTT Subscribe Status zurück
 int getWLANStatus(void); ///< gibt den WLAN Verbinungsstatus zurück
-int getWLANStrength(void); ///< gibt die WLAN Empfangsstärke zurück
+int getWLANStrength(void); ///< gibt die WLAN Empfangsstärke zurück (gleitender Mittelwert)
+int getWLANStrengthRaw(void); ///< gibt die zuletzt gemessene WLAN Empfangsstärke zurück (ungefiltert)
+int getWLANQuality(void); ///< gibt die WLAN Qualitätsstufe zurück (mit Hysterese)
 int getWLANChannel(void); ///< gibt den WLAN Kanal zurück
+void requestWiFiScan(void); ///< fordert einen vollständigen WLAN Scan an
+const wifi_link_t *getWLANLink(void); ///< gibt den Zustand der WLAN Verbindung zurück
+const wifi_roam_stats_t *getWLANRoamStatistics(void); ///< gibt die Statistik des Roamings und der WLAN Unterbrüche zurück
+const wifi_power_stats_t *getWLANPowerStatistics(void); ///< gibt die Statistik des WLAN Stromsparmodus zurück
+uint8_t getWLANDutyCycle(void); ///< gibt den Anteil der verbundenen Zeit mit voller Leistung in % zurück
 
 #endif
\ No newline at end of file
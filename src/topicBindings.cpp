@@ -0,0 +1,379 @@
+/**
+ * @file topicBindings.cpp
+ * @author Fabian Reifler
+ * @brief Verknüpfung von MQTT Topics mit Zeilen der Display-Seiten. \n
+ * Eine eingehende Nachricht wird gemäss der Verknüpfung umgewandelt und in @ref line_t::value bzw.
+ * @ref line_t::text geschrieben. Hat sich der Wert verändert, wird die Zeile als geändert markiert.
+ * Gezeichnet werden nur Zeilen der aktuell angezeigten Seite, Änderungen auf anderen Seiten werden
+ * gezeichnet, sobald die Seite angezeigt wird. \n
+ * Ist bei einer Verknüpfung ein JSON Pfad angegeben, wird der Payload einmal pro Nachricht in Tokens zerlegt
+ * und der Wert über den Pfad ausgewählt. Dadurch kann eine Nachricht mehrere Zeilen aktualisieren. \n
+ * Mit @ref publishPageSnapshot() werden alle Zeilen einer Seite als ein JSON Objekt in einer Nachricht publiziert. \n
+ * Nach einem Verbindungsaufbau sendet der Broker alle Retained-Werte auf einmal. Die Zeilen werden dabei sofort
+ * nachgeführt, gezeichnet wird aber erst, wenn die Synchronisation abgeschlossen ist (nur der endgültige Zustand).
+ * @version 0.4
+ * @date 19.10.2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <Arduino.h>
+#include "topicBindings.h"
+#include "display.h"
+
+/********************************************************************************************
+*** Global Parameters
+********************************************************************************************/
+extern page_t pages_array[]; ///< extern Page Array, is coded in pages.c
+
+static const topic_binding_t *bindingList = NULL; ///< Verknüpfungen (vom Anwender)
+static unsigned int bindingCount = 0;             ///< Anzahl Verknüpfungen
+static int bindingTopicId[TOPIC_BINDINGS_MAX];    ///< Topic ID der Verknüpfung, siehe @ref wio_mqtt::subscribe()
+static wio_mqtt *bindingMQTT = NULL;
+static json_token_t jsonTokens[TOPIC_BINDINGS_JSON_TOKENS];    ///< Tokens der aktuellen Nachricht
+static wio_json json(jsonTokens, TOPIC_BINDINGS_JSON_TOKENS);
+static topic_binding_stats_t bindingStats = {};
+
+/********************************************************************************************
+*** Functionprototypes
+********************************************************************************************/
+static void onBoundMessage(const char *topic, const char *payload, unsigned int len);
+static unsigned int applyMessage(int id, const char *topic, const char *payload, unsigned int len, int page);
+static bool convertPayload(line_t *line, convert_e convert, const char *payload);
+static bool parseTime(const char *payload, float *value);
+
+/********************************************************************************************
+*** Functions
+********************************************************************************************/
+/**
+ * @brief Abonniert die Topics aller Verknüpfungen. Ungültige Verknüpfungen (Seite oder Zeile existiert nicht)
+ * werden auf dem Serial Port ausgegeben und ignoriert.
+ * @attention Die Liste muss bis zum Programmende gültig bleiben (globale Variable).
+ *
+ * @param wio_MQTT Zeiger auf das wio_mqtt Objekt
+ * @param bindings Liste der Verknüpfungen
+ * @param count Anzahl Verknüpfungen in der Liste
+ */
+void initTopicBindings(wio_mqtt *wio_MQTT, const topic_binding_t bindings[], unsigned int count)
+{
+  uint16_t pageCount = 0;
+
+  while (strcmp(pages_array[pageCount].title, "NULL")) // the last page is marked with the title "NULL"
+  {
+    pageCount++;
+  }
+  if (count > TOPIC_BINDINGS_MAX)
+  {
+    count = TOPIC_BINDINGS_MAX;
+  }
+
+  bindingMQTT = wio_MQTT;
+  bindingList = bindings;
+  bindingCount = count;
+  for (unsigned int i = 0; i < count; i++)
+  {
+    bindingTopicId[i] = -1;
+    if (bindings[i].page >= pageCount || bindings[i].line >= NUMBERS_OF_LINES)
+    {
+      Serial.print("Invalid topic binding: ");
+      Serial.println(bindings[i].topic);
+      continue;
+    }
+    bindingTopicId[i] = wio_MQTT->subscribe(bindings[i].topic, onBoundMessage);
+  }
+}
+
+/**
+ * @brief Zeichnet die geänderten Zeilen der aktuellen Seite. Muss in jedem Durchlauf von loop() aufgerufen werden.
+ * Solange die Retained-Werte nach einem Verbindungsaufbau eintreffen, wird nicht gezeichnet.
+ *
+ * @param currentPage Aktuelle Seite
+ */
+void topicBindingsHandler(uint16_t currentPage)
+{
+  if (bindingCount == 0 || bindingMQTT->isSynchronizing())
+  {
+    return;
+  }
+  for (int i = 0; i < NUMBERS_OF_LINES; i++)
+  {
+    if (pages_array[currentPage].lines[i].dirty)
+    {
+      pages_array[currentPage].lines[i].dirty = 0;
+      updateLine(currentPage, i, ONLY_VALUE);
+    }
+  }
+}
+
+/**
+ * @brief Füllt die verknüpften Zeilen einer Seite mit den zuletzt empfangenen Werten aus dem Zwischenspeicher
+ * von @ref wio_mqtt. Gekürzte Werte (länger als @ref MQTT_CACHE_VALUE_LENGTH) werden ausgelassen.
+ *
+ * @param page Seite in pages_array
+ * @return unsigned int Anzahl geänderter Zeilen, sie werden vom @ref topicBindingsHandler() gezeichnet
+ */
+unsigned int loadBindingsFromCache(uint16_t page)
+{
+  unsigned int changed = 0;
+
+  for (unsigned int i = 0; i < bindingCount; i++)
+  {
+    if (bindingList[i].page != page)
+    {
+      continue;
+    }
+    const mqtt_cache_entry_t *cached = bindingMQTT->getCachedValue(bindingTopicId[i]);
+    if (cached && cached->len < MQTT_CACHE_VALUE_LENGTH) // complete value only
+    {
+      changed += applyMessage(bindingTopicId[i], bindingList[i].topic, cached->value, cached->len, page);
+    }
+  }
+  return changed;
+}
+
+/**
+ * @brief Gibt die Statistik der JSON Verarbeitung zurück. Damit kann die Dauer der Zerlegung mit
+ * den realen Payloads auf dem Terminal gemessen werden.
+ *
+ * @return const topic_binding_stats_t* Zeiger auf die Statistik
+ */
+const topic_binding_stats_t *getTopicBindingStats(void)
+{
+  return &bindingStats;
+}
+
+/**
+ * @brief Publiziert alle Zeilen einer Seite in einer Nachricht. Das JSON wird direkt in den Sendepuffer
+ * von @ref wio_mqtt geschrieben, z.B.:
+ * @code {"title":"Klima","lines":{"Temperatur":21.5,"Status":"OK"}} @endcode
+ * Zeilen vom Typ @p TEXT werden als String, alle anderen als Zahl geschrieben. Zeilen ohne Namen werden ausgelassen.
+ *
+ * @param wio_MQTT Zeiger auf das wio_mqtt Objekt
+ * @param topic Topicname
+ * @param page Seite in pages_array
+ * @param retain true: Nachricht wird vom Broker gespeichert
+ * @return true Die Nachricht wurde gesendet
+ * @return false Keine Verbindung oder die Seite ist zu gross für den Sendepuffer
+ */
+bool publishPageSnapshot(wio_mqtt *wio_MQTT, const char *topic, uint16_t page, bool retain)
+{
+  const page_t *p = &pages_array[page];
+  wio_json_writer writer(*wio_MQTT);
+
+  if (!wio_MQTT->beginMessage(topic, retain))
+  {
+    return false;
+  }
+  writer.beginObject();
+  writer.key("title");
+  writer.value(p->title);
+  writer.key("lines");
+  writer.beginObject();
+  for (int i = 0; i < NUMBERS_OF_LINES; i++)
+  {
+    const line_t *line = &p->lines[i];
+    if (line->line_name[0] == '\0')
+    {
+      continue;
+    }
+    writer.key(line->line_name);
+    if (line->line_typ == TEXT)
+    {
+      writer.value(line->text);
+    }
+    else
+    {
+      writer.value((double)line->value, 3);
+    }
+  }
+  writer.endObject();
+  writer.endObject();
+  if (writer.error())
+  {
+    Serial.print("Page snapshot too large: ");
+    Serial.println(topic);
+  }
+  return wio_MQTT->endMessage(); // discards the message if the tx buffer overflowed
+}
+
+/**
+ * @brief Handler für die verknüpften Topics.
+ *
+ * @param topic Topic der Nachricht
+ * @param payload Payload der Nachricht
+ * @param len Länge des Payloads
+ */
+static void onBoundMessage(const char *topic, const char *payload, unsigned int len)
+{
+  applyMessage(bindingMQTT->getMessageTopicId(), topic, payload, len, -1);
+}
+
+/**
+ * @brief Schreibt den umgewandelten Payload in alle Zeilen, welche mit dem Topic verknüpft sind.
+ * Ein JSON Payload wird nur einmal zerlegt, auch wenn mehrere Zeilen mit dem Topic verknüpft sind.
+ *
+ * @param id ID des Topics
+ * @param topic Topic der Nachricht
+ * @param payload Payload der Nachricht (nullterminiert)
+ * @param len Länge des Payloads
+ * @param page Nur Zeilen dieser Seite, -1: alle Seiten
+ * @return unsigned int Anzahl geänderter Zeilen
+ */
+static unsigned int applyMessage(int id, const char *topic, const char *payload, unsigned int len, int page)
+{
+  unsigned int changed = 0;
+  int tokens = 0; // 0: not parsed yet
+  unsigned long startMicros = 0;
+  char value[24];
+
+  for (unsigned int i = 0; i < bindingCount; i++)
+  {
+    if (bindingTopicId[i] != id || (page >= 0 && bindingList[i].page != page))
+    {
+      continue;
+    }
+    const char *text = payload;
+    if (bindingList[i].path)
+    {
+      if (tokens == 0)
+      {
+        startMicros = micros();
+        tokens = json.parse(payload, len);
+        bindingStats.messages++;
+        if (tokens <= 0) // also empty payload
+        {
+          tokens = JSON_ERROR_INVAL;
+          bindingStats.parseErrors++;
+          Serial.print("Invalid JSON payload: ");
+          Serial.println(topic);
+        }
+      }
+      if (tokens <= 0)
+      {
+        continue;
+      }
+      json.getString(json.select(bindingList[i].path), value, sizeof(value));
+      if (value[0] == '\0') // path not found
+      {
+        continue;
+      }
+      text = value;
+    }
+    line_t *line = &pages_array[bindingList[i].page].lines[bindingList[i].line];
+    if (convertPayload(line, bindingList[i].convert, text))
+    {
+      line->dirty = 1; // drawn by topicBindingsHandler() as soon as the page is shown
+      changed++;
+    }
+  }
+
+  if (tokens != 0) // parse and select time of this message
+  {
+    bindingStats.parseLastUs = micros() - startMicros;
+    if (bindingStats.parseLastUs > bindingStats.parseMaxUs)
+    {
+      bindingStats.parseMaxUs = bindingStats.parseLastUs;
+    }
+  }
+  return changed;
+}
+
+/**
+ * @brief Wandelt den Payload um und schreibt ihn in die Zeile.
+ *
+ * @param line Zeile
+ * @param convert Umwandlung
+ * @param payload Payload (nullterminiert)
+ * @return true Der Wert der Zeile hat sich verändert
+ * @return false Der Wert ist gleich geblieben oder der Payload ist ungültig
+ */
+static bool convertPayload(line_t *line, convert_e convert, const char *payload)
+{
+  float value;
+  char *end;
+
+  switch (convert)
+  {
+  case CONVERT_TEXT:
+    if (strncmp(line->text, payload, sizeof(line->text) - 1) == 0)
+    {
+      return false;
+    }
+    strncpy(line->text, payload, sizeof(line->text) - 1);
+    line->text[sizeof(line->text) - 1] = '\0';
+    return true;
+
+  case CONVERT_TIME:
+    if (!parseTime(payload, &value))
+    {
+      return false;
+    }
+    break;
+
+  case CONVERT_BAR_PERCENT:
+  case CONVERT_NUMERIC:
+  default:
+    value = strtof(payload, &end);
+    if (end == payload) // no number
+    {
+      return false;
+    }
+    if (convert == CONVERT_BAR_PERCENT)
+    {
+      value = constrain(value, 0, 100);
+    }
+    break;
+  }
+
+  if (line->value == value)
+  {
+    return false;
+  }
+  line->value = value;
+  return true;
+}
+
+/**
+ * @brief Wandelt eine Zeit in das Format der Zeilen ( @p hhmmss als Zahl) um.
+ *
+ * @param payload Zeit als "hh:mm", "hh:mm:ss", "YYYY-MM-DDThh:mm:ss" oder hhmmss
+ * @param value Umgewandelte Zeit
+ * @return true Die Zeit ist gültig
+ * @return false Die Zeit ist ungültig
+ */
+static bool parseTime(const char *payload, float *value)
+{
+  const char *t = strchr(payload, 'T'); // ISO 8601: time follows the 'T'
+  int hou_ = 0, min_ = 0, sek_ = 0;
+
+  if (t)
+  {
+    payload = t + 1;
+  }
+  if (strchr(payload, ':'))
+  {
+    if (sscanf(payload, "%d:%d:%d", &hou_, &min_, &sek_) < 2)
+    {
+      return false;
+    }
+  }
+  else
+  {
+    char *end;
+    long hhmmss = strtol(payload, &end, 10);
+    if (end == payload)
+    {
+      return false;
+    }
+    hou_ = hhmmss / 10000;
+    min_ = (hhmmss / 100) % 100;
+    sek_ = hhmmss % 100;
+  }
+  if (hou_ < 0 || hou_ > 23 || min_ < 0 || min_ > 59 || sek_ < 0 || sek_ > 59)
+  {
+    return false;
+  }
+  *value = hou_ * 10000L + min_ * 100 + sek_;
+  return true;
+}
@@ -0,0 +1,67 @@
+/**
+ * @file topicBindings.h
+ * @author Fabian Reifler
+ * @brief Verknüpfung von MQTT Topics mit Zeilen der Display-Seiten. Eingehende Nachrichten werden
+ * umgewandelt und direkt in die Zeile geschrieben, ohne Code pro Topic. Eine Seite kann als ein
+ * JSON Objekt publiziert werden.
+ * @version 0.3
+ * @date 19.10.2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef _TOPIC_BINDINGS_H_
+#define _TOPIC_BINDINGS_H_
+
+#include "wio_mqtt.h"
+#include "pages.h"
+#include "wio_json.h"
+
+/********************************************************************************************
+*** Defines
+********************************************************************************************/
+#define TOPIC_BINDINGS_MAX 32 ///< Maximale Anzahl Verknüpfungen
+#define TOPIC_BINDINGS_JSON_TOKENS 64 ///< Maximale Anzahl JSON Tokens pro Nachricht
+
+/********************************************************************************************
+*** Enumerations
+********************************************************************************************/
+/// Umwandlung des Payloads für die Zeile
+typedef enum{
+  CONVERT_NUMERIC,      ///< Zahl --> @ref line_t::value, z.B. "21.5"
+  CONVERT_TEXT,         ///< Text --> @ref line_t::text (max. 19 Zeichen)
+  CONVERT_BAR_PERCENT,  ///< Zahl 0 - 100 --> @ref line_t::value, Werte ausserhalb werden begrenzt
+  CONVERT_TIME          ///< Zeit "hh:mm", "hh:mm:ss", "YYYY-MM-DDThh:mm:ss" oder hhmmss --> @ref line_t::value
+}convert_e;
+
+/********************************************************************************************
+*** Datatypes
+********************************************************************************************/
+/// Verknüpfung eines Topics mit einer Zeile
+typedef struct{
+  const char *topic;  ///< Topic Filter, darf die Wildcards '+' und '#' enthalten
+  uint16_t page;      ///< Seite in pages_array
+  uint8_t line;       ///< Zeile auf der Seite (0 - @ref NUMBERS_OF_LINES - 1)
+  convert_e convert;  ///< Umwandlung des Payloads
+  const char *path;   ///< JSON Pfad des Wertes im Payload, z.B. "$.t", NULL: ganzer Payload
+}topic_binding_t;
+
+/// Statistik der Verknüpfungen, siehe @ref getTopicBindingStats()
+typedef struct{
+  uint32_t messages;      ///< Anzahl Nachrichten mit JSON Payload
+  uint32_t parseErrors;   ///< Anzahl ungültiger JSON Payloads (oder zu viele Tokens)
+  uint32_t parseLastUs;   ///< Dauer der letzten Zerlegung inkl. Pfad-Auswahl in us
+  uint32_t parseMaxUs;    ///< Maximale Dauer der Zerlegung inkl. Pfad-Auswahl in us
+}topic_binding_stats_t;
+
+/********************************************************************************************
+*** Functionprototypes
+********************************************************************************************/
+void initTopicBindings(wio_mqtt *wio_MQTT, const topic_binding_t bindings[], unsigned int count); ///< Verknüpfungen abonnieren
+void topicBindingsHandler(uint16_t currentPage); ///< Geänderte Zeilen der aktuellen Seite zeichnen
+const topic_binding_stats_t *getTopicBindingStats(void); ///< Statistik der JSON Verarbeitung auslesen
+unsigned int loadBindingsFromCache(uint16_t page); ///< Zeilen einer Seite aus den zwischengespeicherten Werten füllen
+bool publishPageSnapshot(wio_mqtt *wio_MQTT, const char *topic, uint16_t page, bool retain = false); ///< Alle Zeilen einer Seite in einer Nachricht publizieren
+
+#endif
@@ -17,6 +17,7 @@
 #include "pages.h"
 #include "wio_mqtt.h"
 #include "display.h"
+#include "topicBindings.h"
 
 // START USER CODE: Includes
 
@@ -52,6 +53,18 @@ char topicList[][TOPIC_LENGTH] = ///< Liste der MQTT Topics, die abboniert werde
         // END USER CODE: Subscribed Topics
 };
 
+const topic_binding_t topicBindings[] = ///< Verknüpfung von MQTT Topics mit Zeilen der Seiten (pages.c). Der Payload wird umgewandelt und
+                                        ///< automatisch angezeigt, dafür ist kein Code in @ref onMqttMessage() nötig.
+                                        ///< Die Topics dürfen nicht zusätzlich in der topicList stehen.
+    {
+        // START USER CODE: Topic Bindings
+        //Topic                           | Seite | Zeile | Umwandlung          | JSON Pfad
+        {"KU291/Haus20/2OG/Anzeige",        1,      0,      CONVERT_TEXT},                    // Beispiel: ganzer Payload
+        {"KU291/Haus20/2OG/Klima",          1,      1,      CONVERT_NUMERIC,      "$.t"},     // Beispiel: {"t":21.4,"h":48}
+        {"KU291/Haus20/2OG/Klima",          1,      2,      CONVERT_BAR_PERCENT,  "$.h"}      // Beispiel: gleiche Nachricht, anderes Feld
+        // END USER CODE: Topic Bindings
+};
+
 
 // START USER CODE: Global Variables
 
@@ -76,6 +89,7 @@ int initUserFunctions(wio_mqtt *ptr_wio_MQTT)
   // MQTT Configuration
   wio_MQTT = ptr_wio_MQTT;
   wio_MQTT->addSubscribeList(topicList[0], sizeof(topicList)); // subscribe to all topics in topicList
+  initTopicBindings(wio_MQTT, topicBindings, sizeof(topicBindings) / sizeof(topicBindings[0])); // subscribe to all bound topics
   wio_MQTT->initMQTT(onMqttMessage);                           // init MQTT with callback function
 
   return currentPage;
@@ -147,7 +161,7 @@ void onMqttMessage(int messageSize)
   Serial.print("Payload: ");
   Serial.println(payload);
 
-  while (strcmp(topic, topicList[elem])) // search topic in topicList
+  while (elem < (int)(sizeof(topicList) / TOPIC_LENGTH) && strcmp(topic, topicList[elem])) // search topic in topicList
   {
     elem++; // if not found, increment elem
   }
@@ -0,0 +1,134 @@
+/**
+ * @file bench_json.cpp
+ * @author Fabian Reifler
+ * @brief Host Benchmark für wio_json: Zerlegen repräsentativer MQTT Payloads mit Pfad-Auswahl (wie in
+ * topicBindings.cpp) und Schreiben eines Berichtes mit wio_json_writer. Die Resultate werden geprüft,
+ * bei einem falschen Wert endet das Programm mit Fehlercode 1.
+ * @version 1.0
+ * @date 19.10.2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <chrono>
+#include "wio_json.h"
+
+#define BENCH_TOKENS 64         ///< Wie TOPIC_BINDINGS_JSON_TOKENS
+#define BENCH_ITERATIONS 200000 ///< Durchläufe pro Payload
+
+/// Payload mit dem Pfad, der pro Nachricht ausgewählt wird, und dem erwarteten Wert
+typedef struct{
+  const char *name;
+  const char *payload;
+  const char *path;
+  const char *expected;
+}bench_case_t;
+
+static const bench_case_t cases[] = {
+  {"flat",   "{\"t\":21.4,\"h\":48}", "$.h", "48"},
+  {"nested", "{\"id\":\"wio-7\",\"sensor\":{\"t\":21.4,\"h\":48,\"p\":1013.2},\"state\":{\"door\":\"open\",\"lamp\":true},\"v\":[1,2,{\"x\":-3.5}],\"ts\":1700000000}", "$.v[2].x", "-3.5"},
+  {"escaped", "{\"msg\":\"Temp \\\"Büro\\\"\\n\",\"level\":2}", "$.msg", "Temp \"Büro\"\n"},
+};
+
+/// Ausgabestrom in einen festen Puffer, wie der Sendepuffer von wio_mqtt
+class BufferPrint : public Print
+{
+public:
+  char buf[512];
+  size_t len = 0;
+  size_t write(uint8_t c) override
+  {
+    if (len >= sizeof(buf) - 1)
+    {
+      return 0;
+    }
+    buf[len++] = (char)c;
+    buf[len] = '\0';
+    return 1;
+  }
+};
+
+static double nsPerIteration(std::chrono::steady_clock::time_point start)
+{
+  std::chrono::duration<double, std::nano> d = std::chrono::steady_clock::now() - start;
+  return d.count() / BENCH_ITERATIONS;
+}
+
+int main()
+{
+  static json_token_t tokens[BENCH_TOKENS];
+  wio_json json(tokens, BENCH_TOKENS);
+  char value[64];
+  volatile int sink = 0;
+  int failed = 0;
+
+  for (const bench_case_t &c : cases)
+  {
+    unsigned int len = strlen(c.payload);
+
+    // correctness first, a fast wrong parser is useless
+    if (json.parse(c.payload, len) <= 0 || !json.getString(json.select(c.path), value, sizeof(value)) || strcmp(value, c.expected) != 0)
+    {
+      printf("%-8s FAILED (%s)\n", c.name, c.path);
+      failed = 1;
+      continue;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < BENCH_ITERATIONS; i++)
+    {
+      sink += json.parse(c.payload, len);
+    }
+    double parseNs = nsPerIteration(start);
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < BENCH_ITERATIONS; i++)
+    {
+      json.parse(c.payload, len);
+      sink += json.getString(json.select(c.path), value, sizeof(value));
+    }
+    double selectNs = nsPerIteration(start);
+
+    printf("%-8s %4u bytes  parse %7.1f ns  parse+select %7.1f ns\n", c.name, len, parseNs, selectNs);
+  }
+
+  // writer: connectivity report sized object
+  BufferPrint out;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < BENCH_ITERATIONS; i++)
+  {
+    out.len = 0;
+    wio_json_writer writer(out);
+    writer.beginObject();
+    writer.key("uptime");
+    writer.value(3600UL);
+    writer.key("rssi");
+    writer.value(-61);
+    writer.key("t");
+    writer.value(21.4, 1);
+    writer.key("events");
+    writer.beginArray();
+    writer.beginObject();
+    writer.key("link");
+    writer.value("wifi");
+    writer.key("ms");
+    writer.value(3400UL);
+    writer.endObject();
+    writer.endArray();
+    writer.endObject();
+    sink += writer.error() ? 1 : 0;
+  }
+  double writeNs = nsPerIteration(start);
+  if (strcmp(out.buf, "{\"uptime\":3600,\"rssi\":-61,\"t\":21.4,\"events\":[{\"link\":\"wifi\",\"ms\":3400}]}") != 0)
+  {
+    printf("writer   FAILED: %s\n", out.buf);
+    failed = 1;
+  }
+  else
+  {
+    printf("writer   %4zu bytes  write %7.1f ns\n", out.len, writeNs);
+  }
+  (void)sink;
+  return failed;
+}
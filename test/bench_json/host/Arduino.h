@@ -0,0 +1,47 @@
+/**
+ * @file Arduino.h
+ * @author Fabian Reifler
+ * @brief Minimaler Ersatz für Arduino.h, damit wio_json auf dem Host (g++) übersetzt werden kann
+ * @version 1.0
+ * @date 19.10.2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#define DEC 10
+
+/// Ausgabestrom wie Print im Arduino Core (nur die von wio_json_writer verwendeten Methoden)
+class Print
+{
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t *buf, size_t size)
+  {
+    size_t n = 0;
+    while (n < size && write(buf[n]))
+    {
+      n++;
+    }
+    return n;
+  }
+  size_t print(const char *s) { return write((const uint8_t *)s, strlen(s)); }
+  size_t print(int v, int base = DEC) { return print((long)v, base); }
+  size_t print(unsigned int v, int base = DEC) { return print((unsigned long)v, base); }
+  size_t print(long v, int base = DEC) { char buf[24]; (void)base; snprintf(buf, sizeof(buf), "%ld", v); return print(buf); }
+  size_t print(unsigned long v, int base = DEC) { char buf[24]; (void)base; snprintf(buf, sizeof(buf), "%lu", v); return print(buf); }
+  size_t print(double v, int digits = 2) { char buf[40]; snprintf(buf, sizeof(buf), "%.*f", digits, v); return print(buf); }
+};
+
+#endif